@@ -1,1284 +1,3760 @@
-/*
-
-Target CPU: ARM946E-S (Nintendo DS main CPU) and ARM7TDMI (Nintendo DS secondary CPU, Nintendo GBA main CPU)
-Target Architecture: ARMv5TE and ARMv4T
-ARM version: 5, 4
-THUMB version: 2, 1
-Documentation: https://www.intel.com/content/dam/support/us/en/programmable/support-resources/bulk-container/pdfs/literature/third-party/ddi0100e-arm-arm.pdf
-
-*/
-
-/* Instructions marked with an asterisk * are not available in ARMv4T */
-
-/* Alphabetical list of ARM instructions (number of variants) */
-/*
-ADC         Add with Carry
-ADD         Add
-AND         Logical AND
-B           Branch
-BL          Branch and Link
-BIC         Bit Clear
-BKPT        Breakpoint*
-BLX (2)     Branch with Link and Exchange*
-BX          Branch and Exchange
-CDP         Coprocessor Data Processing
-CLZ         Count Leading Zeros*
-CMN         Compare Negative
-CMP         Compare
-EOR         Logical Exclusive OR
-LDC         Load Coprocessor
-LDC2        Load Coprocessor 2*
-LDM (3)     Load Multiple
-LDR         Load Register
-LDRB        Load Register Byte
-LDRBT       Load Register Byte with Translation
-LDRH        Load Register Halfword
-LDRSB       Load Register Signed Byte
-LDRSH       Load Register Signed Halfword
-LDRT        Load Register with Translation
-MCR         Move to Coprocessor from ARM Register
-MCR2        Move to Coprocessor from ARM Register 2*
-MLA         Multiply Accumulate
-MOV         Move
-MRC         Move to ARM Register from Coprocessor
-MRC2        Move to ARM Register from Coprocessor 2*
-MRS         Move PSR to General-purpose Register
-MSR         Move to Status Register from ARM Register
-MUL         Multiply
-MVN         Move Negative
-ORR         Logical OR
-RSB         Reverse Substract
-RSC         Reverse Substract with Carry
-SBC         Substract with Carry
-SMLAL       Signed Multply Accumulate Long
-SMULL       Signed Multply Long
-STC         Store Coprocessor
-STC2        Store Coprocessor 2*
-STM (2)     Store Multiple
-STR         Store Register
-STRB        Store Register Byte
-STRBT       Store Register Byte with Translation
-STRH        Store Register Halfword
-STRT        Store Register with Translation
-SUB         Substract
-SWI         Software Interrupt
-SWP         Swap
-SWPB        Swap Byte
-TEQ         Test Equivalence
-TST         Test
-UMLAL       Unsigned Multply Accumulate Long
-UMULL       Unsigned Multply Long
-
-//DSP enhanced (ARMv5TE exclusive)
-
-LDRD        Load Register Dual
-MCRR        Move to Coprocessor from Registers
-MRRC        Move to Registers from Coprocessor
-PLD         Preload Data
-QADD        Saturating signed Add
-QDADD       ;Performs a saturated integer doubling of one operand followed by a saturated integer addition with the other operand
-QDSUB       ;Performs a saturated integer doubling of one operand followed by a saturated integer substraction from the other operand
-QSUB        Saturating signed Subtraction
-SMLA        Signed Multiply Accumulate
-SMLAL       Signed Multiply Accumulate Long
-SMLAW       Signed Multiply Accumulate Word
-SMUL        Signed Multiply
-SMULW       Signed Multiply Word
-STRD        Store Register Dual
-*/
-
-/* Alphabetical list of THUMB instructions (number of variants) */
-/*
-ADC         Add with Carry
-ADD (7)     Add
-AND         Logical AND
-ASR (2)     Arithmetic Shift Right
-B (2)       Branch
-BIC         Bit Clear
-BKPT        Breakpoint*
-BL          Branch with Link
-BLX (2)     Branch with Link and Exchange*
-BX          Branch and Exchange
-CMN         Compare Negative
-CMP (3)     Compare
-EOR         Logical Exclusive OR
-LDMIA       Load Multiple Increment After
-LDR (4)     Load Register
-LDRB (2)    Load Register Byte
-LDRH (2)    Load Register Halfword
-LDRSB       Load Register Signed Byte
-LDRSH       Load Register Signed Halfword
-LSL (2)     Logical Shift Left
-LSR (2)     Logical Shift Right
-MOV (3)     Move
-MUL         Multiply
-MVN         Move NOT
-NEG         Negate
-ORR         Logical OR
-POP         Pop Multiple Registers
-PUSH        Push Multiple Registers
-ROR         Rotate Right Register
-SBC         Substract with Carry
-STMIA       Store Multiple Increment After
-STR (3)     Store Register
-STRB (2)    Store Register Byte
-STRH (2)    Store Register Halfword
-SUB (4)     Substract
-SWI         Software Interrupt
-TST         Test
-*/
-
-/* INCLUDE GUARD */
-
-#ifndef DTHUMB_H
-#define DTHUMB_H
-
-/* INCLUDES */
-
-#include <stdio.h>
-#include <string.h>
-#include <stdlib.h>
-#include <time.h>
-
-/* MACROS */
-
-//#define _CRT_SECURE_NO_WARNINGS 1
-#define PATH_LENGTH (256)
-#define RANGE_LENGTH (18)
-#define STRING_LENGTH (80) //can fail at 64 in SubstituteSubString
-#define CONDITIONS_MAX (16)
-
-#define BITS(x, b, n) ((x >> b) & ((1 << n) - 1)) //retrieves n bits from x starting at bit b
-#define SIGNEX32_BITS(x, b, n) ((BITS(x,b,n) ^ (1<<(n-1))) - (1<<(n-1))) //convert n-bit value to signed 32 bits
-#define SIGNEX32_VAL(x, n) ((x ^ (1<<(n-1))) - (1<<(n-1))) //convert n-bit value to signed 32 bits
-#define ROR(x, n) ((x>>n)|(x<<(32-n))) //rotate right 32-bit value x by n bits
-
-/* TYPEDEFS */
-
-typedef unsigned int u32;
-typedef unsigned short u16;
-typedef unsigned char u8;
-
-typedef enum {
-    SIZE_16,
-    SIZE_32
-}THUMBSIZE;
-
-typedef enum {
-    ARMv4T, //ARM v4, THUMB v1
-    ARMv5TE, //ARM v5, THUMB v2
-    ARMv6 //ARM v6, THUMB v3
-}ARMARCH; //only 32-bit legacy architectures with THUMB support
-
-typedef enum {
-    EQ, //equal, Z set
-    NE, //not equal, Z clear
-    CS, //carry set, C set (or HS, unsigned higher or same)
-    CC, //carry clear, C clear (or LO, unsigned lower)
-    MI, //minus/negative, N set
-    PL, //plus/positive/zero, N clear
-    VS, //overflow, V set
-    VC, //no overflow, V clear
-    HI, //unsigned higher, C set and Z clear
-    LS, //unsigned lower or same, C clear or Z set
-    GE, //signed greater than or equal, N==V
-    LT, //signed less than, N!=V
-    GT, //signed greater than, Z==0 and N==V
-    LE, //signed less than or equal, Z==1 or N!=V
-    AL, //unconditional, only with IT instructions
-    NV  //unconditional, usually undefined
-}CONDITION;
-
-/* GLOBALS */
-
-//todo: maybe put "2" instead of "nv" (or nothing) in the last one
-const u8 Conditions[CONDITIONS_MAX][3] = { "eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "", "" }; //last two are "al" and "nv", but never displayed
-
-const u8 AddressingModes[4][3] = {
-    "da", //Decrement after
-    "ia", //Increment after
-    "db", //Decrement before
-    "ib"  //Increment before
-};
-
-const u8 DataProcessing_thumb[16][4] = {
-    "and",
-    "eor",
-    "lsl",
-    "lsr",
-    "asr",
-    "adc",
-    "sbc",
-    "ror",
-    "tst",
-    "neg",
-    "cmp",
-    "cmn",
-    "orr",
-    "mul",
-    "bic",
-    "mvn"
-};
-
-const u8 DataProcessing_arm[16][4] = {
-    "and",
-    "eor",
-    "sub",
-    "rsb",
-    "add",
-    "adc",
-    "sbc",
-    "rsc",
-    "tst", //no s
-    "teq", //no s
-    "cmp", //no s
-    "cmn", //no s
-    "orr",
-    "mov", //only 1 source operand
-    "bic",
-    "mvn"  //only 1 source operand
-};
-
-const u8 MSR_cxsf[16][5] = {
-    "",
-    "c",
-    "x",
-    "xc",
-    "s",
-    "sc",
-    "sx",
-    "sxc",
-    "f",
-    "fc",
-    "fx",
-    "fxc",
-    "fs",
-    "fsc",
-    "fsx",
-    "fsxc"
-};
-
-const u8 LoadStoreRegister[8][6] = {
-    "str", //STR (2)
-    "strh", //STRH (2)
-    "strb", //STRB (2)
-    "ldrsb", //LDRSB
-    "ldr", //LDR (2)
-    "ldrh", //LDRH (2)
-    "ldrb", //LDRB (2)
-    "ldrsh" //LDRSH
-};
-
-const u8 DSP_AddSub[4][6] = { "qadd", "qsub", "qdadd", "qdsub" };
-const u8 DSP_Multiplies[4][6] = { "smla", "", "smlal", "smul" }; //slot 1 empty, decided elsehow
-const u8 MultiplyLong[4][6] = { "umull", "umlal", "smull", "smlal" };
-const u8 AddCmpMovHighRegisters[3][4] = { "add", "cmp", "mov" };
-const u8 MovCmpAddSubImmediate[4][4] = { "mov", "cmp", "add", "sub" };
-const u8 Shifters[4][4] = { "lsl", "lsr", "asr", "ror" }; //+rrx
-const u8 ShiftImmediate[4][4] = { "lsl", "lsr", "asr", "" }; //thumb
-
-u32 debug_na_count = 0;
-
-/* LIBRARY FUNCTIONS */
-
-static void SubstituteSubString(u8 dst[STRING_LENGTH], u32 index, const u8* sub, u32 size) {
-    /* Insert sub string of length size (< STRING_LENGTH) at dst[index] */
-    u8 tmp[STRING_LENGTH] = { 0 }; //zinit
-    memcpy(&tmp, sub, size); //init
-    memcpy(&tmp[size], &dst[index + size + 1], STRING_LENGTH - index - size - 1); //save
-    memcpy(&dst[index], tmp, STRING_LENGTH - index - 1); //restore
-}
-
-static void CheckSpecialRegister(u8* str, int size) {
-    /* Replace special registers by their common names */
-    //(r12->ip), r13->sp, r14->lr, r15->pc
-    //todo: check for size != -1
-    for (int i = 0; i < size; i++) //when using a variable string size (return value of sprintf), 10% faster than constant size of STRING_LENGTH 64
-    {
-        if (str[i] == 'r')
-        {
-            switch (*(u16*)&str[i + 1])
-            {
-            case 0x3331: //"13"
-            {
-                SubstituteSubString(str, i, "sp", sizeof("sp") - 1);
-                break;
-            }
-            case 0x3431: //"14"
-            {
-                SubstituteSubString(str, i, "lr", sizeof("lr") - 1);
-                break;
-            }
-            case 0x3531: //"15"
-            {
-                SubstituteSubString(str, i, "pc", sizeof("pc") - 1);
-                break;
-            }
-            }
-        }
-    }
-}
-
-static u32 FormatStringRegisterList_thumb(u8 str[STRING_LENGTH], u16 reg, const u8* pclr, u8 pclr_size) {
-    /* Format str according to the reg bifield, group consecutive registers together */
-    /* Support for a special 9th register name */
-    u32 bits = 0; //return value, number of 1 bits in reg
-    u32 streak = 0; //current streak, used to group registers together
-    u32 pos = 0; //position in the str array
-    u8 tmp[4] = { 0 }; //temporary buffer for register write
-    for (u32 i = 0; i < 9; i++) //reg is a 9-bit value
-    {
-        if (BITS(reg, i, 1))
-        {
-            bits++;
-            switch (streak)
-            {
-            case 0: //streak ended, print current register
-            {
-                if (i == 8)
-                {
-                    sprintf(tmp, pclr); //pc or lr override
-                    memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                    pos += pclr_size; //sizeof(pclr)
-                }
-                else
-                {
-                    sprintf(tmp, "r%u,", i); //r0-r7
-                    memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                    pos += 3; //sizeof("r0")
-                }
-                break;
-            }
-            case 1: break; //used to catch default cases later
-            case 2: //hyphenation if at least 3 in a row
-            {
-                str[pos - 1] = '-'; //replaces the comma
-                break;
-            }
-            default:
-            {
-                //todo: a bit repetitive, tidy up
-                if (i == 8) //if on last bit, close the current streak by writing previous and last register 
-                {
-                    sprintf(tmp, "r%u,", i - 1); //previous register (can't be LR/PC)
-                    memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                    pos += 3; //depends on size of tmp
-                    sprintf(tmp, pclr); //pc or lr override
-                    memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                    pos += pclr_size; //sizeof(pclr)
-                }
-            }
-            }
-            streak = (i < 8) ? streak + 1 : 0; //avoids grouping LR/PC
-        }
-        else
-        {
-            if (streak > 1) //if broke with at least 3 in a row, close
-            {
-                sprintf(tmp, "r%u,", i - 1); //previous register (can't be LR/PC)
-                memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                pos += 3; //depends on size of tmp
-            }
-            streak = 0; //reset
-        }
-    }
-    if (pos) str[pos - 1] = 0; //removes the coma on the last register   
-    return bits; //number of 1 bits
-}
-
-static u32 FormatStringRegisterList_arm(u8 str[STRING_LENGTH], u16 reg) {
-    /* Format str according to the reg bifield, group consecutive registers together */
-    u32 bits = 0; //return value, number of 1 bits in reg
-    u32 streak = 0; //current streak, used to group registers together
-    u32 pos = 0; //position in the str array
-    u8 tmp[5] = { 0 }; //temporary buffer for register write
-    for (u32 i = 0; i < 16; i++) //all registers
-    {
-        if (BITS(reg, i, 1))
-        {
-            bits++;
-            switch (streak)
-            {
-            case 0: //streak started, print current register
-            {
-                sprintf(tmp, "r%u,", i); //r0-r15
-                memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                pos = (i < 10) ? pos + sizeof("r0") : pos + sizeof("r10");
-                break;
-            }
-            case 1: break;
-            case 2: //hyphenation if at least 3 in a row
-            {
-                str[pos - 1] = '-'; //replaces the comma
-                break;
-            }
-            default:
-            {
-                if (i == 15) //if on last bit, close the current streak by writing last register 
-                {
-                    str[pos++] = 'p';
-                    str[pos++] = 'c';
-                    str[pos++] = ','; //comma will get deleted later
-                }
-            }
-            }
-            streak++;
-        }
-        else
-        {
-            if (streak > 1) //if broke with at least 3 in a row, close
-            {
-                sprintf(tmp, "r%u,", i - 1); //previous register
-                memcpy(&str[pos], tmp, sizeof(tmp)); //write
-                pos = (i - 1 < 10) ? pos + sizeof("r0") : pos + sizeof("r10");
-            }
-            streak = 0; //reset
-        }
-    }
-    if (pos) str[pos - 1] = 0; //removes the coma on the last register   
-    return bits; //number of 1 bits
-}
-
-static u32 CountBits(u8 b) {
-    /* Count bits in a byte */
-    static const u8 lut[16] = { 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4 };
-    return lut[b & 0x0f] + lut[b >> 4];
-}
-
-static int FormatExtraLoadStore(u32 c, u8* str, u8 cond, const u8* op) {
-    /*  */
-    u8 rd = BITS(c, 12, 4);
-    u8 rn = BITS(c, 16, 4);
-    u8 w = BITS(c, 21, 1);
-    u8 p = BITS(c, 24, 1);
-    if (BITS(c, 22, 1)) //immediate
-    {
-        u8 ofs = (BITS(c, 8, 4) << 4) | BITS(c, 0, 4);
-        u8* sign = BITS(c, 23, 1) ? "+" : "-";
-        if (p) //offset, pre-indexed
-        {
-            u8* pre = w ? "!" : "";
-            return sprintf(str, "%s%s r%u, [r%u, #%s0x%X]%s", op, Conditions[cond], rd, rn, sign, ofs, pre);
-        }
-        else //post-indexed
-        {
-            if (w) return 0; //w must be 0, else UNPREDICTABLE //todo: check if really invalid
-            return sprintf(str, "%s%s r%u, [r%u], #%s0x%X", op, Conditions[cond], rd, rn, sign, ofs);
-        }
-    }
-    else //register
-    {
-        u8 rm = BITS(c, 0, 4);
-        u8* sign = BITS(c, 23, 1) ? "" : "-"; //implicit "+" in front of registers
-        if (p) //offset, pre-indexed
-        {
-            u8* pre = w ? "!" : "";
-            return sprintf(str, "%s%s r%u, [r%u, %sr%u]%s", op, Conditions[cond], rd, rn, sign, rm, pre);
-        }
-        else //post-indexed
-        {
-            if (w) return 0; //w must be 0, else UNPREDICTABLE //todo: check if really invalid
-            return sprintf(str, "%s%s r%u, [r%u], %sr%u", op, Conditions[cond], rd, rn, sign, rm);
-        }
-    }
-}
-
-static u32 Disassemble_thumb(u32 code, u8 str[STRING_LENGTH], ARMARCH tv) {
-    /* Convert a code into a string, return size of the processed code (SIZE_16 or SIZE_32) */
-
-    THUMBSIZE thumb_size = SIZE_16; //return value
-    u16 c = code & 0xffff; //low 16 bits
-    int size = 0; //return value of sprintf to be passed to CheckSpecialRegister
-
-    switch (c >> 13)
-    {
-    case 0: //0x0000 //LSL, LSR, ASR, ADD, SUB
-    {
-        u8 rd = BITS(c, 0, 3);
-        u8 rn = BITS(c, 3, 3);
-        u8 index = BITS(c, 11, 2);
-        if (index == 3) //ADD, SUB, MOV
-        {
-            if (BITS(c, 6, 5) == 16) //MOV (2) (technically ADD (1) with imm==0)
-            {
-                size = sprintf(str, "mov r%u, r%u", rd, rn);
-            }
-            else
-            {
-                u8 rm_imm = BITS(c, 6, 3);
-                u8* op = (BITS(c, 9, 1)) ? "sub" : "add";
-                if (BITS(c, 10, 1)) //ADD (1), SUB (1) -immediate
-                {
-                    size = sprintf(str, "%s r%u, r%u, #0x%X", op, rd, rn, rm_imm);
-                }
-                else //ADD (3), SUB (3) -register
-                {
-                    size = sprintf(str, "%s r%u, r%u, r%u", op, rd, rn, rm_imm);
-                }
-            }
-        }
-        else //Shift by immediate: LSL (1), LSR (1), ASR (1) 
-        {
-            size = sprintf(str, "%s r%u, r%u, #0x%X", ShiftImmediate[index], rd, rn, BITS(c, 6, 5));
-        }
-        break;
-    }
-
-    case 1: //0x2000 //MOV (1), CMP (1), ADD (2), SUB (2)
-    {
-        size = sprintf(str, "%s r%u, #0x%X", MovCmpAddSubImmediate[BITS(c, 11, 2)], BITS(c, 8, 3), BITS(c, 0, 8));
-        break;
-    }
-
-    case 2: //0x4000 //lots...
-    {
-        switch (BITS(c, 10, 3))
-        {
-        case 0: //Data-processing registers
-        {
-            size = sprintf(str, "%s r%u, r%u", DataProcessing_thumb[BITS(c, 6, 4)], BITS(c, 0, 3), BITS(c, 3, 3));
-            break;
-        }
-        case 1: //Special data processing
-        {
-            u8 rd = (BITS(c, 7, 1) << 3) | (BITS(c, 0, 3));
-            u8 rm = BITS(c, 3, 4);
-            u8 op = BITS(c, 8, 2);
-            if (op == 3) //Branch/exchange instruction set
-            {
-                if (BITS(c, 0, 3)) break; //Should-Be-Zero
-                if (BITS(c, 7, 1)) //BLX (2)
-                {
-                    if (tv < ARMv5TE) break; //UNPREDICTABLE prior to ARM version 5
-                    size = sprintf(str, "blx r%u", rm);
-                }
-                else //BX
-                {
-                    size = sprintf(str, "bx r%u", rm);
-                }
-            }
-            else //ADD (4), CMP (3), MOV (3)
-            {
-                if (!BITS(c, 6, 2)) break; //UNPREDICTABLE
-                size = sprintf(str, "%s r%u, r%u", AddCmpMovHighRegisters[op], rd, rm);
-            }
-            break;
-        }
-        default: //Load from literal pool, Load/Store register offset
-        {
-            if (BITS(c, 12, 1)) //Load/store register offset
-            {
-                size = sprintf(str, "%s r%u, [r%u, r%u]", LoadStoreRegister[BITS(c, 9, 3)], BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 3));
-            }
-            else //LDR (3)
-            {
-                if (!BITS(c, 11, 1)) break; //Should-Be-One
-                size = sprintf(str, "ldr r%u, [pc, #0x%X]", BITS(c, 8, 3), 4 * BITS(c, 0, 8));
-            }
-        }
-        }
-        break;
-    }
-
-    case 3: //0x6000 //STR, LDR, STRB, LDRB
-    {
-        switch (BITS(c, 11, 2))
-        {
-        case 0: //STR (1)
-        {
-            size = sprintf(str, "str r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), 4 * BITS(c, 6, 5));
-            break;
-        }
-        case 1: //LDR (1)
-        {
-            size = sprintf(str, "ldr r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), 4 * BITS(c, 6, 5));
-            break;
-        }
-        case 2: //STRB (1)
-        {
-            size = sprintf(str, "strb r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 5));
-            break;
-        }
-        case 3: //LDRB (1)
-        {
-            size = sprintf(str, "ldrb r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 5));
-            break;
-        }
-        }
-        break;
-    }
-
-    case 4: //0x8000 //STR, LDR, STRH, LDRH
-    {
-        if (BITS(c, 12, 1)) //LDR (4), STR (3)
-        {
-            u8* op = (BITS(c, 11, 1)) ? "ldr" : "str";
-            size = sprintf(str, "%s r%u, [sp, #0x%X]", op, BITS(c, 8, 3), 4 * BITS(c, 0, 8));
-        }
-        else //LDRH (1), STRH (1)
-        {
-            u8* op = (BITS(c, 11, 1)) ? "ldrh" : "strh";
-            size = sprintf(str, "%s r%u, [r%u, #0x%X]", op, BITS(c, 0, 3), BITS(c, 3, 3), 2 * BITS(c, 6, 5));
-        }
-        break;
-    }
-
-    case 5: //0xA000 //Misc and ADD to sp or pc
-    {
-        if (BITS(c, 12, 1)) //Misc, fig 6-2
-        {
-            switch (BITS(c, 8, 4))
-            {
-            case 0: //ADD (4), SUB (7) to/from SP
-            {
-                u8* op = (BITS(c, 7, 1)) ? "sub" : "add";
-                size = sprintf(str, "%s sp, #0x%X", op, 4 * BITS(c, 0, 7));
-                break;
-            }
-            //PUSH/POP
-            case 4:
-            case 5:
-            case 12:
-            case 13:
-            {
-                u8 reglist[STRING_LENGTH] = { 0 };
-                u16 registers = BITS(c, 0, 9);
-                if (BITS(c, 11, 1)) //POP
-                {
-                    if (FormatStringRegisterList_thumb(reglist, registers, "pc", sizeof("pc"))) //if BitCount(registers) < 1 then UNPREDICTABLE
-                    {
-                        size = sprintf(str, "pop {%s}", reglist);
-                    }
-                }
-                else //PUSH
-                {
-                    if (FormatStringRegisterList_thumb(reglist, registers, "lr", sizeof("lr"))) //if BitCount(registers) < 1 then UNPREDICTABLE
-                    {
-                        size = sprintf(str, "push {%s}", reglist);
-                    }
-                }
-                break;
-            }
-            case 14: //BKPT
-            {
-                if (tv >= ARMv5TE) //undefined prior to ARM version 5
-                {
-                    size = sprintf(str, "bkpt #0x%X", BITS(c, 0, 8));
-                }
-                break;
-            }
-            }
-        }
-        else //ADD (5), ADD (6) to SP or PC
-        {
-            u8* sppc = (BITS(c, 11, 2)) ? "sp" : "pc";
-            size = sprintf(str, "add r%u, %s, #0x%X", BITS(c, 8, 3), sppc, 4 * BITS(c, 0, 8));
-        }
-        break;
-    }
-
-    case 6: //0xC000 //B, SWI, LDMIA, STMIA
-    {
-        if (BITS(c, 12, 1)) //Conditional branch, Undefined, System call
-        {
-            switch (BITS(c, 8, 4))
-            {
-            case 14: //UDF "Permanently undefined space", OS dependant
-            {
-                //size = sprintf(str, "udf #0x%X", BITS(c, 0, 8)); //note: not an instruction in ARMv5TE, just UNDEFINED
-                break;
-            }
-            case 15: //SWI
-            {
-                size = sprintf(str, "swi #0x%X", BITS(c, 0, 8));
-                break;
-            }
-            default: //B (1) conditional
-            {
-                size = sprintf(str, "b%s #0x%X", Conditions[BITS(c, 8, 4)], 4 + 2 * SIGNEX32_BITS(c, 0, 8));
-            }
-            }
-        }
-        else //LDMIA/STMIA
-        {
-            u8 reglist[STRING_LENGTH] = { 0 };
-            u8* op = (BITS(c, 11, 1)) ? "ldmia" : "stmia";
-            if (FormatStringRegisterList_thumb(reglist, BITS(c, 0, 8), "", 0))
-            {
-                size = sprintf(str, "%s r%u!, {%s}", op, BITS(c, 8, 3), reglist);
-            }
-        }
-        break;
-    }
-
-    case 7: //0xE000 //B, then 32-bit instructions
-    {
-        switch (BITS(c, 11, 2))
-        {
-        case 0:
-        {
-            size = sprintf(str, "b #0x%X", 4 + 2 * SIGNEX32_BITS(c, 0, 11)); //11 bits to signed 32 bits
-            break;
-        }
-        //case 1: break; //undefined on first pass
-        case 2: //BL/BLX prefix
-        {
-            c = code >> 16; //get high 16 bits
-            if (c >> 13 == 7)
-            {
-                switch (BITS(c, 11, 2))
-                {
-                case 1: //BLX (1)
-                {
-                    if (tv < ARMv5TE) break;
-                    if (!BITS(c, 0, 1))
-                    {
-                        thumb_size = SIZE_32;
-
-                        int ofs = (BITS((code & 0xffff), 0, 11)) << 12;
-                        ofs = SIGNEX32_VAL(ofs, 23);
-                        ofs += 4;
-                        ofs += 2 * BITS(c, 0, 11);
-                        //note: bit 1 should be cleared (word aligned target address)
-                        size = sprintf(str, "blx #0x%X", ofs);
-                    }
-                    break;
-                }
-                //case 2: break; //BL/BLX prefix
-                case 3: //BL
-                {
-                    thumb_size = SIZE_32;
-
-                    int ofs = (BITS((code & 0xffff), 0, 11)) << 12;
-                    ofs = SIGNEX32_VAL(ofs, 23);
-                    ofs += 4;
-                    ofs += 2 * BITS(c, 0, 11);
-
-                    size = sprintf(str, "bl #0x%X", ofs);
-                    break;
-                }
-                }
-            }
-            break;
-        }
-        }
-        break;
-    }
-    }
-    if (!str[0]) //in case nothing was written to it
-    {
-        debug_na_count++;
-        sprintf(str, "n/a");
-    }
-    else
-    {
-        CheckSpecialRegister(str, size); //formatting
-    }
-    return thumb_size;
-}
-
-static void Disassemble_arm(u32 code, u8 str[STRING_LENGTH], ARMARCH av) {
-    /**/
-    //Reference: page 68 of 811 from the ARM Architecture reference manual june 2000 edition
-    //todo: proper support for ARMv4T 
-    //todo: extra caution for UNPREDICTABLE instructions, need to remove them? or decode regardless?
-
-    int size = 0; //return value of sprintf to be passed to CheckSpecialRegister
-    u32 c = code; //alias
-    u8 cond = BITS(c, 28, 4); //condition bits
-
-    //todo: check unconditional instructions first to avoid putting a check later at each stage
-
-    switch (BITS(c, 25, 3))
-    {
-    case 0: //Data processing, DSP instructions, ...
-    {
-        if (cond == NV) break; //undefined
-        if (BITS(c, 4, 1))
-        {
-            if (BITS(c, 7, 1)) //Multiplies, extra load/stores: see fig 3-2
-            {
-                u8 oplo = BITS(c, 5, 2);
-                if (!oplo)
-                {
-                    if (!BITS(c, 22, 3)) //Multiply (accumulate)
-                    {
-                        u8 rm = BITS(c, 0, 4);
-                        u8 rs = BITS(c, 8, 4);
-                        u8 rn = BITS(c, 12, 4);
-                        u8 rd = BITS(c, 16, 4);
-                        u8* s = BITS(c, 20, 1) ? "s" : "";
-                        if (BITS(c, 21, 1)) //MLA
-                        {
-                            size = sprintf(str, "mla%s%s r%u, r%u, r%u, r%u", s, Conditions[cond], rd, rm, rs, rn);
-                        }
-                        else //MUL
-                        {
-                            if (rn) break; //Should-Be-Zero
-                            size = sprintf(str, "mul%s%s r%u, r%u, r%u", s, Conditions[cond], rd, rm, rs);
-                        }
-                    }
-                    else if (BITS(c, 23, 1)) //Multiply (accumulate) long
-                    {
-                        u8* s = BITS(c, 20, 1) ? "s" : "";
-                        size = sprintf(str, "%s%s%s r%u, r%u, r%u, r%u", MultiplyLong[BITS(c, 21, 2)], s, Conditions[cond], BITS(c, 12, 4), BITS(c, 16, 4), BITS(c, 0, 4), BITS(c, 8, 4));
-                    }
-                    else //Swap/swap byte (SWP, SWPB)
-                    {
-                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
-                        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or no
-                        size = sprintf(str, "swp%s%s r%u, r%u, [r%u]", b, Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4), BITS(c, 16, 4));
-                    }
-                }
-                else
-                {
-                    if (!BITS(c, 22, 1) && BITS(c, 8, 4)) break; //Should-Be-Zero if register offset
-                    if (oplo == 1) //Load/store halfword
-                    {
-                        u8* l = BITS(c, 20, 1) ? "ldrh" : "strh"; //load or store
-                        size = FormatExtraLoadStore(c, str, cond, l);
-                    }
-                    else
-                    {
-                        if (BITS(c, 20, 1)) //Load signed halfword/byte
-                        {
-                            u8* h = BITS(c, 5, 1) ? "ldrsh" : "ldrsb"; //halfword/byte
-                            size = FormatExtraLoadStore(c, str, cond, h);
-                        }
-                        else //Load/store two words
-                        {
-                            if (BITS(c, 12, 1)) break; //undefined if Rd is odd
-                            u8* s = BITS(c, 5, 1) ? "strd" : "ldrd"; //store or load
-                            size = FormatExtraLoadStore(c, str, cond, s);
-                        }
-                    }
-                }
-            }
-            else
-            {
-                if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
-                {
-                    u8 oplo = BITS(c, 5, 2);
-                    u8 ophi = BITS(c, 21, 2);
-                    switch (oplo)
-                    {
-                    case 0:
-                    {
-                        if (ophi == 3) //CLZ
-                        {
-                            //note: if PC is in either register, UNPREDICTABLE
-                            if (av < ARMv5TE) break;
-                            if (!BITS(c, 16, 4) || !BITS(c, 8, 4)) break; //Should-Be-One
-                            size = sprintf(str, "clz%s r%u, r%u", Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4));
-                        }
-                        else if (ophi == 1)//Branch/exchange instruction set (BX)
-                        {
-                            if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
-                            size = sprintf(str, "bx%s r%u", Conditions[cond], BITS(c, 0, 4));
-                        }
-                        break;
-                    }
-                    case 1: //BLX (2)
-                    {
-                        if (av < ARMv5TE) break;
-                        if (ophi != 1) break;
-                        if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
-                        size = sprintf(str, "blx%s r%u", Conditions[cond], BITS(c, 0, 4));
-                        break;
-                    }
-                    case 2: //Enhanced DSP add/sub (QADD, QDADD, QSUB, QDSUB)
-                    {
-                        //note: if PC is in either register, UNPREDICTABLE
-                        if (av < ARMv5TE) break;
-                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
-                        size = sprintf(str, "%s%s r%u, r%u, r%u", DSP_AddSub[ophi], Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4), BITS(c, 16, 4));
-                        break;
-                    }
-                    case 3: //Software breakpoint (BKPT)
-                    {
-                        if (av < ARMv5TE) break;
-                        if (ophi != 1) break;
-                        size = sprintf(str, "bkpt #0x%X", (BITS(c, 8, 12) << 4) | BITS(c, 0, 4));
-                        break;
-                    }
-                    }
-                }
-                else //Data processing register shift
-                {
-                    u8 rm = BITS(c, 0, 4);
-                    u8 shift = BITS(c, 5, 2);
-                    u8 rs = BITS(c, 8, 4);
-                    u8 rd = BITS(c, 12, 4);
-                    u8 rn = BITS(c, 16, 4);
-                    u8 op = BITS(c, 21, 4);
-                    u8* s = BITS(c, 20, 1) ? "s" : "";
-                    switch (op)
-                    {
-                    case 8: //TST
-                    case 9: //TEQ
-                    case 10: //CMP
-                    case 11: //CMN
-                    {
-                        size = sprintf(str, "%s%s r%u, r%u, %s r%u", DataProcessing_arm[op], Conditions[cond], rn, rm, Shifters[shift], rs);
-                        break;
-                    }
-                    case 13: //MOV
-                    case 15: //MVN
-                    {
-                        size = sprintf(str, "%s%s%s r%u, r%u, %s r%u", DataProcessing_arm[op], s, Conditions[cond], rd, rm, Shifters[shift], rs);
-                        break;
-                    }
-                    default:
-                    {
-                        size = sprintf(str, "%s%s%s r%u, r%u, r%u, %s r%u", DataProcessing_arm[op], s, Conditions[cond], rd, rn, rm, Shifters[shift], rs);
-                    }
-                    }
-                }
-            }
-        }
-        else //bit 4 == 0
-        {
-            if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
-            {
-                if (BITS(c, 7, 1)) //Enhanced DSP multiplies
-                {
-                    if (av < ARMv5TE) break;
-                    //note: PC for any register is UNPREDICTABLE
-                    u8 rm = BITS(c, 0, 4);
-                    u8* x = BITS(c, 5, 1) ? "t" : "b";
-                    u8* y = BITS(c, 6, 1) ? "t" : "b";
-                    u8 rs = BITS(c, 8, 4);
-                    u8 rn_rdlo = BITS(c, 12, 4);
-                    u8 rd_rdhi = BITS(c, 16, 4);
-                    u8 op = BITS(c, 21, 2);
-                    switch (op)
-                    {
-                    case 0: //SMLA
-                    {
-                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rd_rdhi, rm, rs, rn_rdlo);
-                        break;
-                    }
-                    case 1: //SMLAW, SMULW
-                    {
-                        if (BITS(c, 5, 1)) //SMULW
-                        {
-                            if (rn_rdlo) break; //Should-Be-Zero 
-                            size = sprintf(str, "smulw%s%s r%u, r%u, r%u", y, Conditions[cond], rd_rdhi, rm, rs);
-                        }
-                        else //SMLAW
-                        {
-                            size = sprintf(str, "smlaw%s%s r%u, r%u, r%u, r%u", y, Conditions[cond], rd_rdhi, rm, rs, rn_rdlo);
-                        }
-                        break;
-                    }
-                    case 2: //SMLAL
-                    {
-                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rn_rdlo, rd_rdhi, rm, rs);
-                        break;
-                    }
-                    case 3: //SMUL
-                    {
-                        if (rn_rdlo) break; //Should-Be-Zero
-                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rd_rdhi, rm, rs);
-                        break;
-                    }
-                    }
-                }
-                else
-                {
-                    if (!BITS(c, 0, 12) && BITS(c, 16, 4) == 15) //Move status reg to reg (MRS)
-                    {
-                        //note: if Rd == PC, UNPREDICTABLE
-                        u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
-                        size = sprintf(str, "mrs%s r%u, %cpsr", Conditions[cond], BITS(c, 12, 4), sreg);
-                    }
-                    else if (BITS(c, 12, 4) == 15 && !BITS(c, 4, 8) && BITS(c, 21, 1)) //Move reg to status reg (MSR register)
-                    {
-                        u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
-                        size = sprintf(str, "msr%s %cpsr_%s, r%u", Conditions[cond], sreg, MSR_cxsf[BITS(c, 16, 4)], BITS(c, 0, 4));
-                    }
-                }
-            }
-            else //Data processing immediate shift
-            {
-                //todo: write a function for all 3 Data Processing switch-cases
-                u8 op = BITS(c, 21, 4);
-                u8 rm = BITS(c, 0, 4);
-                u8 shift = BITS(c, 5, 2);
-                u8 shift_imm = BITS(c, 7, 5);
-                u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
-                if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
-                if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm);
-                u8 rd = BITS(c, 12, 4);
-                u8 rn = BITS(c, 16, 4);
-                u8* s = BITS(c, 20, 1) ? "s" : "";
-                switch (op)
-                {
-                case 8: //TST
-                case 9: //TEQ
-                case 10: //CMP
-                case 11: //CMN
-                {
-                    size = sprintf(str, "%s%s r%u, r%u, %s", DataProcessing_arm[op], Conditions[cond], rn, rm, sstr);
-                    break;
-                }
-                case 13: //MOV
-                case 15: //MVN
-                {
-                    size = sprintf(str, "%s%s%s r%u, r%u, %s", DataProcessing_arm[op], s, Conditions[cond], rd, rm, sstr);
-                    break;
-                }
-                default:
-                {
-                    size = sprintf(str, "%s%s%s r%u, r%u, r%u, %s", DataProcessing_arm[op], s, Conditions[cond], rd, rn, rm, sstr);
-                }
-                }
-            }
-        }
-        break;
-    }
-    case 1: //Data processing and MSR immediate
-    {
-        if (cond == NV) break; //undefined
-        u32 imm = ROR(BITS(c, 0, 8), 2 * BITS(c, 8, 4));
-
-        if (BITS(c, 12, 4) == 15 && !BITS(c, 20, 1)) //MSR immediate
-        {
-            u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
-            size = sprintf(str, "msr%s %cpsr_%s, #0x%X", Conditions[cond], sreg, MSR_cxsf[BITS(c, 16, 4)], imm);
-        }
-        else //Data processing immediate
-        {
-            u8 op = BITS(c, 21, 4);
-            u8 rd = BITS(c, 12, 4);
-            u8 rn = BITS(c, 16, 4);
-            u8* s = BITS(c, 20, 1) ? "s" : "";
-            switch (op)
-            {
-            case 8: //TST
-            case 9: //TEQ
-            case 10: //CMP
-            case 11: //CMN
-                //always update the condition codes: <op>{<cond>} <Rn>, <shift>
-            {
-                size = sprintf(str, "%s%s r%u, #0x%X", DataProcessing_arm[op], Conditions[cond], rn, imm);
-                break;
-            }
-            case 13: //MOV
-            case 15: //MVN
-                //only one source operand: <op>{<cond>}{S} <Rd>, <shift>
-            {
-                size = sprintf(str, "%s%s%s r%u, #0x%X", DataProcessing_arm[op], s, Conditions[cond], rd, imm);
-                break;
-            }
-
-            default: //others: <op>{<cond>}{S} <Rd>, <Rn>, <shift>
-            {
-                size = sprintf(str, "%s%s%s r%u, r%u, #0x%X", DataProcessing_arm[op], s, Conditions[cond], rd, rn, imm);
-            }
-            }
-        }
-        break;
-    }
-    case 2: //Load/store immediate offset
-    {
-        if (cond == NV) break; //undefined
-        //bits 25, 24, 23 and 21 decide the addressing mode
-        u8 rd = BITS(c, 12, 4);
-        u8 rn = BITS(c, 16, 4);
-        u16 imm = BITS(c, 0, 12); //12 bits for LDR and LDRB (8 bits for LDRH and LDRSB)
-        u8* sign = BITS(c, 23, 1) ? "+" : "-"; //sign of the immediate offset
-        u8* ls = BITS(c, 20, 1) ? "ldr" : "str"; //load or store
-        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or word
-        if (BITS(c, 24, 1)) //offset or pre-indexed
-        {
-            u8* w = BITS(c, 21, 1) ? "!" : ""; //pre-indexed if 1
-            size = sprintf(str, "%s%s%s r%u, [r%u, #%s0x%X]%s", ls, b, Conditions[cond], rd, rn, sign, imm, w);
-        }
-        else //post-indexed
-        {
-            u8* w = BITS(c, 21, 1) ? "t" : ""; //user mode
-            size = sprintf(str, "%s%s%s%s r%u, [r%u], #%s0x%X", ls, b, w, Conditions[cond], rd, rn, sign, imm);
-        }
-        break;
-    }
-    case 3: //Load/store register offset
-    {
-        if (cond == NV) break; //undefined
-        if (BITS(c, 4, 1)) break; //undefined
-        u8 rm = BITS(c, 0, 4);
-        u8 shift = BITS(c, 5, 2);
-        u16 shift_imm = BITS(c, 7, 5);
-        u8 rd = BITS(c, 12, 4);
-        u8 rn = BITS(c, 16, 4);
-        u8* sign = BITS(c, 23, 1) ? "" : "-"; //sign of the immediate offset, + implicit
-        u8* ls = BITS(c, 20, 1) ? "ldr" : "str"; //load or store
-        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or word
-        u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
-        if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
-        if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm);
-        //note: if rm==r15 or rn==r15 then UNPREDICTABLE
-        //note: if rn==rm then UNPREDICTABLE
-        if (BITS(c, 24, 1)) //offset or pre-indexed
-        {
-            u8* w = BITS(c, 21, 1) ? "!" : ""; //pre-indexed if 1
-            size = sprintf(str, "%s%s%s r%u, [r%u, %sr%u, %s]%s", ls, b, Conditions[cond], rd, rn, sign, rm, sstr, w);
-        }
-        else //post-indexed
-        {
-            u8* w = BITS(c, 21, 1) ? "t" : ""; //user mode
-            size = sprintf(str, "%s%s%s%s r%u, [r%u], %sr%u, %s", ls, b, w, Conditions[cond], rd, rn, sign, rm, sstr);
-        }
-        break;
-    }
-    case 4: //Load/store multiple
-    {
-        if (cond == NV) break; //undefined
-        u8 reglist[STRING_LENGTH] = { 0 };
-        FormatStringRegisterList_arm(reglist, BITS(c, 0, 16));
-        u8 rn = BITS(c, 16, 4);
-        u8* w = BITS(c, 21, 1) ? "!" : ""; //W bit
-        u8* s = BITS(c, 22, 1) ? "^" : ""; //S bit
-        u8 am = BITS(c, 23, 2); //PU bits
-        u8* op = (BITS(c, 20, 1)) ? "ldm" : "stm"; //LDM or STM
-        size = sprintf(str, "%s%s%s r%u%s, {%s}%s", op, AddressingModes[am], Conditions[cond], rn, w, reglist, s);
-        break;
-    }
-    case 5: //Branch instructions
-    {
-        if (cond == NV && av >= ARMv5TE) //BLX (1)
-        {
-            size = sprintf(str, "blx #0x%X", 8 + 4 * SIGNEX32_BITS(c, 0, 24) + 2 * BITS(c, 24, 1));
-        }
-        else //B, BL
-        {
-            u8* l = (BITS(c, 24, 1)) ? "l" : "";
-            size = sprintf(str, "b%s%s #0x%X", l, Conditions[cond], 8 + 4 * SIGNEX32_BITS(c, 0, 24));
-        }
-        break;
-    }
-    case 6: //Coprocessor load/store, Double register transfers 
-    {
-        if (av < ARMv5TE) break;
-        //if (cond == NV) break; //only unpredictable prior to ARMv5
-        if (BITS(c, 21, 4) == 2) //MCRR, MRRC
-        {
-            //note: if PC is specified for Rn or Rd, UNPREDICTABLE
-            u8* op = BITS(c, 20, 1) ? "mrrc" : "mcrr";
-            size = sprintf(str, "%s%s p%u, #0x%X, r%u, r%u, c%u", op, Conditions[cond], BITS(c, 8, 4), BITS(c, 4, 4), BITS(c, 12, 4), BITS(c, 16, 4), BITS(c, 0, 4));
-        }
-        else //LDC, STC
-        {
-            //todo: reformat the cond checks into only 1
-            if (cond == NV && av < ARMv5TE) break;
-
-            u8* op = BITS(c, 20, 1) ? "ldc" : "stc";
-            u8* str_cond = (cond == NV) ? "2" : Conditions[cond]; //LDC2, STC2
-            u8* l = BITS(c, 22, 1) ? "l" : ""; //long
-            u8 str_cond_long[8] = { 0 };
-            if (cond == NV) sprintf(str_cond_long, "%s%s", str_cond, l);
-            else sprintf(str_cond_long, "%s%s", l, str_cond);
-            u8 ofs_opt = BITS(c, 0, 8);
-            u8 cp_num = BITS(c, 8, 4);
-            u8 crd = BITS(c, 12, 4);
-            u8 rn = BITS(c, 16, 4);
-            u8* sign = BITS(c, 23, 1) ? "+" : "-";
-            switch ((2 * BITS(c, 24, 1)) | BITS(c, 21, 1)) //(p*2) | w
-            {
-            case 0: //p==0, w==0 //unindexed: [<Rn>], <option>
-            {
-                size = sprintf(str, "%s%s p%u, c%u, [r%u], {0x%X}", op, str_cond_long, cp_num, crd, rn, ofs_opt);
-                break;
-            }
-            case 1: //p==0, w==1 //post indexed: [<Rn>], #+/-<offset_8>*4
-            {
-                size = sprintf(str, "%s%s p%u, c%u, [r%u], #%s0x%X", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
-                break;
-            }
-            case 2: //p==1, w==0 //immediate offset: [<Rn>, #+/-<offset_8>*4]
-            {
-                size = sprintf(str, "%s%s p%u, c%u, [r%u, #%s0x%X]", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
-                break;
-            }
-            case 3: //p==1, w==1 //pre indexed: [<Rn>, #+/-<offset_8>*4]!
-            {
-                size = sprintf(str, "%s%s p%u, c%u, [r%u, #%s0x%X]!", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
-                break;
-            }
-            }
-        }
-        break;
-    }
-    case 7: //Software Interrupt, Coprocessor register transfer, Coprocessor data processing
-    {
-        if (BITS(c, 24, 1)) //SWI
-        {
-            if (cond == NV) break;
-            size = sprintf(str, "swi%s #0x%X", Conditions[cond], BITS(c, 0, 24));
-        }
-        else
-        {
-            if (cond == NV && av < ARMv5TE) break;
-
-            u8 crn = BITS(c, 16, 4);
-            u8 p = BITS(c, 8, 4);
-            u8 rd_crd = BITS(c, 12, 4);
-            u8 crm = BITS(c, 0, 4);
-            u8 op2 = BITS(c, 5, 3);
-            u8* str_cond = (cond == NV) ? "2" : Conditions[cond]; //suffix
-            if (BITS(c, 4, 1)) //MCR, MRC
-            {
-                u8* str_op = BITS(c, 20, 1) ? "mrc" : "mcr";
-                size = sprintf(str, "%s%s p%u, #0x%X, r%u, c%u, c%u, #0x%X", str_op, str_cond, p, BITS(c, 21, 3), rd_crd, crn, crm, op2);
-            }
-            else //CDP
-            {
-                size = sprintf(str, "cdp%s p%u, #0x%X, c%u, c%u, c%u, #0x%X", str_cond, p, BITS(c, 20, 4), rd_crd, crn, crm, op2); //no condition suffix for cdp2
-            }
-        }
-        break;
-    }
-    }
-
-    //also: unconditionnal instructions if bits 28 to 31 are 1111
-    if (!str[0] && (c & 0xFD70F000) == 0xF550F000) //Cache preload (PLD)
-    {
-        //todo: placing it here is wasteful, find a workaround
-        //bit-pattern: 1111 01x1 x101 xxxx 1111 xxxx xxxx xxxx
-        //data mask  : 1111 1101 0111 0000 1111 0000 0000 0000
-        //inst. mask : 1111 0101 0101 0000 1111 0000 0000 0000
-        //note: only offset addressing modes
-        // [<Rn>, #+/-<offset_12>] //immediate
-        // [<Rn>, +/-<Rm>] //register
-        // [<Rn>, +/-<Rm>, <shift> #<shift_imm>] //scaled register
-        u8 rn = BITS(c, 16, 4);
-        if (BITS(c, 25, 1)) //(scaled) register
-        {
-            u8 rm = BITS(c, 0, 4);
-            u8 shift = BITS(c, 5, 2);
-            u16 shift_imm = BITS(c, 7, 5);
-            u8* sign = BITS(c, 23, 1) ? "" : "-";
-            u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
-            if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
-            if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm); //intermediate sprintf
-            size = sprintf(str, "pld [r%u, %sr%u, %s]", rn, sign, rm, sstr);
-        }
-        else //immediate
-        {
-            u8* sign = BITS(c, 23, 1) ? "+" : "-";
-            size = sprintf(str, "pld [r%u, #%s0x%X]", rn, sign, BITS(c, 0, 12));
-        }
-    }
-
-    if (!str[0]) //in case nothing was written to it
-    {
-        debug_na_count++;
-        sprintf(str, "n/a"); //don't need to get size, no special register formatting
-    }
-    else
-    {
-        CheckSpecialRegister(str, size); //formatting of SP, LR, PC
-    }
-}
-
-#endif // !DTHUMB_H
+/*
+
+Target CPU: ARM946E-S (Nintendo DS main CPU) and ARM7TDMI (Nintendo DS secondary CPU, Nintendo GBA main CPU)
+Target Architecture: ARMv5TE and ARMv4T
+ARM version: 5, 4
+THUMB version: 2, 1
+Documentation: https://www.intel.com/content/dam/support/us/en/programmable/support-resources/bulk-container/pdfs/literature/third-party/ddi0100e-arm-arm.pdf
+
+*/
+
+/* Instructions marked with an asterisk * are not available in ARMv4T */
+
+/* Alphabetical list of ARM instructions (number of variants) */
+/*
+ADC         Add with Carry
+ADD         Add
+AND         Logical AND
+B           Branch
+BL          Branch and Link
+BIC         Bit Clear
+BKPT        Breakpoint*
+BLX (2)     Branch with Link and Exchange*
+BX          Branch and Exchange
+CDP         Coprocessor Data Processing
+CLZ         Count Leading Zeros*
+CMN         Compare Negative
+CMP         Compare
+EOR         Logical Exclusive OR
+LDC         Load Coprocessor
+LDC2        Load Coprocessor 2*
+LDM (3)     Load Multiple
+LDR         Load Register
+LDRB        Load Register Byte
+LDRBT       Load Register Byte with Translation
+LDRH        Load Register Halfword
+LDRSB       Load Register Signed Byte
+LDRSH       Load Register Signed Halfword
+LDRT        Load Register with Translation
+MCR         Move to Coprocessor from ARM Register
+MCR2        Move to Coprocessor from ARM Register 2*
+MLA         Multiply Accumulate
+MOV         Move
+MRC         Move to ARM Register from Coprocessor
+MRC2        Move to ARM Register from Coprocessor 2*
+MRS         Move PSR to General-purpose Register
+MSR         Move to Status Register from ARM Register
+MUL         Multiply
+MVN         Move Negative
+ORR         Logical OR
+RSB         Reverse Substract
+RSC         Reverse Substract with Carry
+SBC         Substract with Carry
+SMLAL       Signed Multply Accumulate Long
+SMULL       Signed Multply Long
+STC         Store Coprocessor
+STC2        Store Coprocessor 2*
+STM (2)     Store Multiple
+STR         Store Register
+STRB        Store Register Byte
+STRBT       Store Register Byte with Translation
+STRH        Store Register Halfword
+STRT        Store Register with Translation
+SUB         Substract
+SWI         Software Interrupt
+SWP         Swap
+SWPB        Swap Byte
+TEQ         Test Equivalence
+TST         Test
+UMLAL       Unsigned Multply Accumulate Long
+UMULL       Unsigned Multply Long
+
+//DSP enhanced (ARMv5TE exclusive)
+
+LDRD        Load Register Dual
+MCRR        Move to Coprocessor from Registers
+MRRC        Move to Registers from Coprocessor
+PLD         Preload Data
+QADD        Saturating signed Add
+QDADD       ;Performs a saturated integer doubling of one operand followed by a saturated integer addition with the other operand
+QDSUB       ;Performs a saturated integer doubling of one operand followed by a saturated integer substraction from the other operand
+QSUB        Saturating signed Subtraction
+SMLA        Signed Multiply Accumulate
+SMLAL       Signed Multiply Accumulate Long
+SMLAW       Signed Multiply Accumulate Word
+SMUL        Signed Multiply
+SMULW       Signed Multiply Word
+STRD        Store Register Dual
+*/
+
+/* Alphabetical list of THUMB instructions (number of variants) */
+/*
+ADC         Add with Carry
+ADD (7)     Add
+AND         Logical AND
+ASR (2)     Arithmetic Shift Right
+B (2)       Branch
+BIC         Bit Clear
+BKPT        Breakpoint*
+BL          Branch with Link
+BLX (2)     Branch with Link and Exchange*
+BX          Branch and Exchange
+CMN         Compare Negative
+CMP (3)     Compare
+EOR         Logical Exclusive OR
+LDMIA       Load Multiple Increment After
+LDR (4)     Load Register
+LDRB (2)    Load Register Byte
+LDRH (2)    Load Register Halfword
+LDRSB       Load Register Signed Byte
+LDRSH       Load Register Signed Halfword
+LSL (2)     Logical Shift Left
+LSR (2)     Logical Shift Right
+MOV (3)     Move
+MUL         Multiply
+MVN         Move NOT
+NEG         Negate
+ORR         Logical OR
+POP         Pop Multiple Registers
+PUSH        Push Multiple Registers
+ROR         Rotate Right Register
+SBC         Substract with Carry
+STMIA       Store Multiple Increment After
+STR (3)     Store Register
+STRB (2)    Store Register Byte
+STRH (2)    Store Register Halfword
+SUB (4)     Substract
+SWI         Software Interrupt
+TST         Test
+*/
+
+/* INCLUDE GUARD */
+
+#ifndef DTHUMB_H
+#define DTHUMB_H
+
+/* INCLUDES */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include <stdarg.h>
+
+/* MACROS */
+
+//#define _CRT_SECURE_NO_WARNINGS 1
+#define PATH_LENGTH (256)
+#define RANGE_LENGTH (40) //two 64-bit hex addresses and a separator
+#define STRING_LENGTH (80) //can fail at 64 in SubstituteSubString
+#define CONDITIONS_MAX (16)
+#define REG_NONE (0xff) //register field not used by the instruction
+#define VIEW_CACHE_SIZE (256) //decoded lines kept by a VIEW, power of 2
+#define READER_PAGE_SIZE (4096) //bytes fetched by a single call of a READFUNC, power of 2
+#define READER_PAGES (4) //pages kept by a READER, power of 2
+#define BLOCK_MAX (64) //instructions of a BLOCK, a longer run is cut and falls through
+#define INSTRUMENT_LINES (4096) //leaves are counted by line number in this file, power of 2
+#define DECODETABLES_MAGIC "DTDT"
+#define DECODETABLES_VERSION (1) //bump with any change to the decoders, the fingerprint only samples them
+#define DECODETABLES_LIVE (0xffffffff) //text offset of a THUMB halfword left to the live decoders, it depends on the next one
+
+/* DINST flags */
+#define DF_S (1 << 0) //updates the condition flags
+#define DF_WRITEBACK (1 << 1) //base register is written back
+#define DF_LOAD (1 << 2) //reads memory
+#define DF_STORE (1 << 3) //writes memory
+#define DF_USER (1 << 4) //user mode registers (^) or user mode access (t)
+#define DF_SUBTRACT (1 << 5) //offset is subtracted from the base register
+#define DF_LINK (1 << 6) //writes the return address to lr
+#define DF_SPSR (1 << 7) //MRS/MSR on the SPSR instead of the CPSR
+#define DF_THUMB (1 << 8) //decoded as THUMB
+
+/* EFFECTS flags, N, Z, C, V and Q in flags_read and flags_written */
+#define EF_V (1 << 0)
+#define EF_C (1 << 1)
+#define EF_Z (1 << 2)
+#define EF_N (1 << 3)
+#define EF_Q (1 << 4) //sticky overflow, ARMv5TE
+#define EF_NZCV (EF_N | EF_Z | EF_C | EF_V)
+
+/* EFFECTS bits */
+#define EB_LOAD (1 << 0) //reads memory
+#define EB_STORE (1 << 1) //writes memory, both for SWP
+#define EB_SIGNED (1 << 2) //sign-extending load
+#define EB_USER (1 << 3) //user mode access or user mode registers
+#define EB_WRITES_PC (1 << 4) //branches
+#define EB_EXCHANGE (1 << 5) //can switch between ARM and THUMB, with the low bit of the new pc
+#define EB_MODE (1 << 6) //can change the processor mode, or restores the CPSR from the SPSR
+#define EB_EXCEPTION (1 << 7) //SWI, BKPT or undefined, takes a vector
+#define EB_CONDITIONAL (1 << 8) //writes only happen when the condition passes
+
+#define BITS(x, b, n) ((x >> b) & ((1 << n) - 1)) //retrieves n bits from x starting at bit b
+#define SIGNEX32_BITS(x, b, n) ((BITS(x,b,n) ^ (1<<(n-1))) - (1<<(n-1))) //convert n-bit value to signed 32 bits
+#define SIGNEX32_VAL(x, n) ((x ^ (1<<(n-1))) - (1<<(n-1))) //convert n-bit value to signed 32 bits
+#define ROR(x, n) ((x>>n)|(x<<(32-n))) //rotate right 32-bit value x by n bits
+
+#ifdef _MSC_VER
+#define DTHUMB_THREAD_LOCAL __declspec(thread)
+#else
+#define DTHUMB_THREAD_LOCAL _Thread_local
+#endif
+
+#ifdef _MSC_VER
+#define DTHUMB_INLINE __forceinline
+#else
+#define DTHUMB_INLINE inline __attribute__((always_inline))
+#endif
+
+/* Copies of a decoder with the architecture known at compile time, the checks on it fold away */
+/* ARMv6 decodes the same as ARMv5TE here */
+#define DTHUMB_SPECIALIZE(ret, name, out_t) \
+static ret name##_v4t(u32 code, out_t out) { return name##_generic(code, out, ARMv4T); } \
+static ret name##_v5te(u32 code, out_t out) { return name##_generic(code, out, ARMv5TE); } \
+static ret name(u32 code, out_t out, ARMARCH arch) { return (arch >= ARMv5TE) ? name##_v5te(code, out) : name##_v4t(code, out); }
+#define DTHUMB_SPECIALIZE_VOID(name, out_t) \
+static void name##_v4t(u32 code, out_t out) { name##_generic(code, out, ARMv4T); } \
+static void name##_v5te(u32 code, out_t out) { name##_generic(code, out, ARMv5TE); } \
+static void name(u32 code, out_t out, ARMARCH arch) { if (arch >= ARMv5TE) name##_v5te(code, out); else name##_v4t(code, out); }
+
+/* TYPEDEFS */
+
+typedef unsigned long long u64;
+typedef signed long long s64;
+typedef unsigned int u32;
+typedef unsigned short u16;
+typedef unsigned char u8;
+
+typedef enum {
+    SIZE_16,
+    SIZE_32
+}THUMBSIZE;
+
+typedef enum {
+    ARMv4T, //ARM v4, THUMB v1
+    ARMv5TE, //ARM v5, THUMB v2
+    ARMv6 //ARM v6, THUMB v3
+}ARMARCH; //only 32-bit legacy architectures with THUMB support
+
+typedef enum {
+    EQ, //equal, Z set
+    NE, //not equal, Z clear
+    CS, //carry set, C set (or HS, unsigned higher or same)
+    CC, //carry clear, C clear (or LO, unsigned lower)
+    MI, //minus/negative, N set
+    PL, //plus/positive/zero, N clear
+    VS, //overflow, V set
+    VC, //no overflow, V clear
+    HI, //unsigned higher, C set and Z clear
+    LS, //unsigned lower or same, C clear or Z set
+    GE, //signed greater than or equal, N==V
+    LT, //signed less than, N!=V
+    GT, //signed greater than, Z==0 and N==V
+    LE, //signed less than or equal, Z==1 or N!=V
+    AL, //unconditional, only with IT instructions
+    NV  //unconditional, usually undefined
+}CONDITION;
+
+typedef enum {
+    MN_NA, //undefined or unpredictable, printed as "n/a"
+    //data processing, same order as DataProcessing_arm
+    MN_AND, MN_EOR, MN_SUB, MN_RSB, MN_ADD, MN_ADC, MN_SBC, MN_RSC,
+    MN_TST, MN_TEQ, MN_CMP, MN_CMN, MN_ORR, MN_MOV, MN_BIC, MN_MVN,
+    //THUMB only data processing
+    MN_LSL, MN_LSR, MN_ASR, MN_ROR, MN_NEG,
+    //multiplies and DSP
+    MN_MUL, MN_MLA, MN_UMULL, MN_UMLAL, MN_SMULL, MN_SMLAL,
+    MN_SMLAXY, MN_SMLAWY, MN_SMULWY, MN_SMLALXY, MN_SMULXY,
+    MN_QADD, MN_QSUB, MN_QDADD, MN_QDSUB, MN_CLZ,
+    //single loads/stores
+    MN_LDR, MN_STR, MN_LDRB, MN_STRB, MN_LDRT, MN_STRT, MN_LDRBT, MN_STRBT,
+    MN_LDRH, MN_STRH, MN_LDRSB, MN_LDRSH, MN_LDRD, MN_STRD, MN_SWP, MN_SWPB, MN_PLD,
+    //multiple loads/stores
+    MN_LDM, MN_STM, MN_PUSH, MN_POP,
+    //branches
+    MN_B, MN_BL, MN_BLX, MN_BX,
+    //status registers and exceptions
+    MN_MRS, MN_MSR, MN_SWI, MN_BKPT,
+    //coprocessor
+    MN_CDP, MN_MCR, MN_MRC, MN_MCRR, MN_MRRC, MN_LDC, MN_STC,
+    MN_MAX
+}MNEMONIC;
+
+typedef enum {
+    IC_UNDEFINED,
+    IC_DATA, //data processing and shifts
+    IC_MULTIPLY, //multiplies, saturating arithmetic, CLZ
+    IC_LOADSTORE, //single loads/stores, swaps, preload
+    IC_MULTIPLE, //LDM, STM, PUSH, POP
+    IC_BRANCH,
+    IC_STATUS, //MRS, MSR
+    IC_EXCEPTION, //SWI, BKPT
+    IC_COPROCESSOR,
+    IC_MAX
+}ICLASS;
+
+typedef enum {
+    FORM_NONE,
+    FORM_IMM, //immediate operand
+    FORM_REG, //register operand
+    FORM_REG_SHIFT_IMM, //register operand shifted by an immediate
+    FORM_REG_SHIFT_REG, //register operand shifted by a register
+    FORM_MEM_IMM, //[rn, #imm]
+    FORM_MEM_REG, //[rn, rm{, shift}]
+    FORM_MEM_PRE_IMM, //[rn, #imm]!
+    FORM_MEM_PRE_REG, //[rn, rm{, shift}]!
+    FORM_MEM_POST_IMM, //[rn], #imm
+    FORM_MEM_POST_REG, //[rn], rm{, shift}
+    FORM_LIST_DA, //register list, same order as AddressingModes
+    FORM_LIST_IA,
+    FORM_LIST_DB,
+    FORM_LIST_IB,
+    FORM_BRANCH_IMM, //target relative to the address of the instruction
+    FORM_BRANCH_REG, //target in a register
+    FORM_MAX
+}FORM;
+
+typedef struct {
+    u16 mnemonic; //MNEMONIC
+    u16 flags; //DF_ flags
+    u8 iclass; //ICLASS
+    u8 form; //FORM
+    u8 cond; //CONDITION, AL for unconditional THUMB instructions
+    u8 size; //in bytes: 2 or 4
+    u8 rd; //destination, RdLo for long multiplies, REG_NONE if not used
+    u8 rn; //first operand or base register, RdHi for long multiplies
+    u8 rm; //second operand or offset register
+    u8 rs; //shift or multiply register
+    u16 reglist; //LDM, STM, PUSH, POP: bit n set for register n, MSR: fields c, x, s, f from bit 0 to 3
+    int imm; //immediate, signed memory offset, or branch offset from the address of the instruction
+}DINST; //text-free result of Decode_arm and Decode_thumb
+
+typedef struct {
+    u32 (*disassemble_thumb)(u32 code, u8* str);
+    void (*disassemble_arm)(u32 code, u8* str);
+    u32 (*decode_thumb)(u32 code, DINST* di);
+    void (*decode_arm)(u32 code, DINST* di);
+}DECODERS; //decoders specialized for one architecture, see SelectDecoders
+
+typedef struct {
+    u8 magic[4]; //DECODETABLES_MAGIC
+    u32 version; //DECODETABLES_VERSION
+    u32 dinst_size; //sizeof(DINST) of the writer, the tables hold raw DINSTs
+    u32 text_size; //bytes of text at the end of the file
+    u64 fingerprint; //of the decoders that built the tables, see DecodeTablesFingerprint
+    u64 checksum; //of everything after the header
+}DECODETABLESHEADER;
+
+typedef struct {
+    const DINST* thumb[2]; //by halfword, ARMv4T then ARMv5TE
+    const u32* thumb_text[2]; //offset in text of the string of each halfword, or DECODETABLES_LIVE
+    const u8* arm_class[2]; //ICLASS by bits 27-20 and 7-4 of an ARM code, IC_MAX where the other bits matter
+    const u8* text; //NUL-terminated strings
+}DECODETABLES; //precomputed decoding, shared by every process mapping the same file, see AttachDecodeTables
+
+typedef struct {
+    u16 reads; //bit n set for register n, the address of the instruction counts as a read of pc
+    u16 writes; //bit n set for register n, without the banked lr of an exception
+    u8 flags_read; //EF_ flags
+    u8 flags_written; //EF_ flags, may be written
+    u8 flags_maybe; //part of flags_written left unchanged by some operands (or unpredictable), only the others are always written
+    u8 width; //bytes of each memory access, 0 if none, times the registers of reglist for LDM/STM
+    u16 bits; //EB_ bits
+}EFFECTS; //what an instruction reads and writes, see GetEffects
+
+typedef struct {
+    u8 min; //cycles with no wait states, for the fastest multiplier early termination
+    u8 max; //for the slowest
+    u8 n; //ARM7TDMI non-sequential memory cycles, 0 for the ARM946E-S
+    u8 s; //ARM7TDMI sequential memory cycles
+    u8 i; //ARM7TDMI internal (and coprocessor) cycles, at most
+}CYCLES; //static cost of an instruction, see EstimateCycles
+
+typedef struct {
+    u32 address; //of the instruction
+    u32 code; //as decoded, high halfword is 0 for a 16-bit THUMB line
+    u32 size; //2 or 4 bytes, 0 if the cache slot is empty
+    u8 text[STRING_LENGTH];
+}VIEWLINE;
+
+typedef struct {
+    const u8* data; //memory shown by the view
+    u32 base; //address of data[0]
+    u32 size; //of data in bytes
+    u8 thumb; //1 for THUMB, 0 for ARM
+    ARMARCH arch;
+    VIEWLINE cache[VIEW_CACHE_SIZE]; //by address, a line is only reused while the memory still holds its code
+}VIEW; //debugger viewport over a memory region, see DisassembleView
+
+typedef u32 (*READFUNC)(void* user, u32 address, u8* dst, u32 size); //copy size bytes of the target memory at address to dst, return how many could be read
+
+typedef struct {
+    u32 address; //of data[0]
+    u32 size; //bytes read into data, 0 if the page is empty
+    u8 data[READER_PAGE_SIZE];
+}READERPAGE;
+
+typedef struct {
+    READFUNC read;
+    void* user; //passed back to read
+    ARMARCH arch;
+    DECODERS dec;
+    READERPAGE pages[READER_PAGES]; //by page number
+}READER; //disassembly straight from the memory of an emulator, see DisassembleRead
+
+typedef enum {
+    BLOCK_BRANCH, //branch to a known target, taken or not
+    BLOCK_INDIRECT, //bx, ldm/pop/ldr with pc or pc written by data processing, the target is only known at run time
+    BLOCK_EXCEPTION, //swi, bkpt or undefined instruction
+    BLOCK_LIMIT, //BLOCK_MAX instructions without any, falls through to the next one
+    BLOCK_UNREADABLE //the memory ends before the next instruction
+}BLOCKEND;
+
+typedef enum {
+    EXIT_JUMP, //target of a branch
+    EXIT_CALL, //target of bl/blx, the return address is the EXIT_NEXT one
+    EXIT_NEXT //next instruction: branch not taken, return of a call or a swi, or a cut block
+}EXITKIND;
+
+typedef struct {
+    u32 address;
+    u8 thumb; //mode at address, bl/blx switch it
+    u8 kind; //EXITKIND
+}BLOCKEXIT;
+
+typedef struct {
+    u32 address;
+    u32 code; //as decoded, with the second half of a THUMB bl/blx pair in the high halfword
+    DINST di;
+}BLOCKINST;
+
+typedef struct {
+    u32 start; //address of the first instruction
+    u32 size; //bytes, up to the end of the last instruction
+    u32 count; //instructions
+    u8 thumb; //1 for THUMB, 0 for ARM
+    u8 arch; //ARMARCH
+    u8 end; //BLOCKEND
+    u8 exit_count; //known successors, 0 to 2
+    BLOCKEXIT exits[2];
+    BLOCKINST insts[BLOCK_MAX];
+}BLOCK; //straight-line run of instructions up to the first control flow change, see DecodeBlock
+
+typedef struct {
+    u32 address; //lowest byte accessed
+    u32 size; //bytes, all the registers of an LDM/STM
+    u8 index; //of the instruction in its BLOCK
+    u8 store; //1 for a write, 0 for a read, SWP makes one of each
+}MEMACCESS; //memory access with a known address, see ResolveBlockAccesses
+
+typedef struct {
+    u32 values[16]; //by register, pc is set for each instruction
+    u16 known; //bit n set when values[n] holds register n
+}REGSTATE; //register values followed through a block, see ResolveBlockAccesses
+
+#ifdef DTHUMB_INSTRUMENT
+typedef struct {
+    u64 hits[INSTRUMENT_LINES]; //by line of the sprintf producing the output
+    const u8* functions[INSTRUMENT_LINES]; //function of that line
+    const u8* formats[INSTRUMENT_LINES]; //format string of that line
+    u64 format_ns; //time spent in sprintf
+    u64 special_register_ns; //time spent in CheckSpecialRegister
+}INSTRUMENTATION; //decoder counters, only with DTHUMB_INSTRUMENT defined
+#endif
+
+/* GLOBALS */
+
+//todo: maybe put "2" instead of "nv" (or nothing) in the last one
+const u8 Conditions[CONDITIONS_MAX][3] = { "eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "", "" }; //last two are "al" and "nv", but never displayed
+
+const u8 AddressingModes[4][3] = {
+    "da", //Decrement after
+    "ia", //Increment after
+    "db", //Decrement before
+    "ib"  //Increment before
+};
+
+const u8 DataProcessing_thumb[16][4] = {
+    "and",
+    "eor",
+    "lsl",
+    "lsr",
+    "asr",
+    "adc",
+    "sbc",
+    "ror",
+    "tst",
+    "neg",
+    "cmp",
+    "cmn",
+    "orr",
+    "mul",
+    "bic",
+    "mvn"
+};
+
+const u8 DataProcessing_arm[16][4] = {
+    "and",
+    "eor",
+    "sub",
+    "rsb",
+    "add",
+    "adc",
+    "sbc",
+    "rsc",
+    "tst", //no s
+    "teq", //no s
+    "cmp", //no s
+    "cmn", //no s
+    "orr",
+    "mov", //only 1 source operand
+    "bic",
+    "mvn"  //only 1 source operand
+};
+
+const u8 MSR_cxsf[16][5] = {
+    "",
+    "c",
+    "x",
+    "xc",
+    "s",
+    "sc",
+    "sx",
+    "sxc",
+    "f",
+    "fc",
+    "fx",
+    "fxc",
+    "fs",
+    "fsc",
+    "fsx",
+    "fsxc"
+};
+
+const u8 LoadStoreRegister[8][6] = {
+    "str", //STR (2)
+    "strh", //STRH (2)
+    "strb", //STRB (2)
+    "ldrsb", //LDRSB
+    "ldr", //LDR (2)
+    "ldrh", //LDRH (2)
+    "ldrb", //LDRB (2)
+    "ldrsh" //LDRSH
+};
+
+const u8 DSP_AddSub[4][6] = { "qadd", "qsub", "qdadd", "qdsub" };
+const u8 DSP_Multiplies[4][6] = { "smla", "", "smlal", "smul" }; //slot 1 empty, decided elsehow
+const u8 MultiplyLong[4][6] = { "umull", "umlal", "smull", "smlal" };
+const u8 AddCmpMovHighRegisters[3][4] = { "add", "cmp", "mov" };
+const u8 MovCmpAddSubImmediate[4][4] = { "mov", "cmp", "add", "sub" };
+const u8 Shifters[4][4] = { "lsl", "lsr", "asr", "ror" }; //+rrx
+const u8 ShiftImmediate[4][4] = { "lsl", "lsr", "asr", "" }; //thumb
+
+const u8 Mnemonics[MN_MAX][8] = {
+    "n/a",
+    "and", "eor", "sub", "rsb", "add", "adc", "sbc", "rsc",
+    "tst", "teq", "cmp", "cmn", "orr", "mov", "bic", "mvn",
+    "lsl", "lsr", "asr", "ror", "neg",
+    "mul", "mla", "umull", "umlal", "smull", "smlal",
+    "smlaxy", "smlawy", "smulwy", "smlalxy", "smulxy",
+    "qadd", "qsub", "qdadd", "qdsub", "clz",
+    "ldr", "str", "ldrb", "strb", "ldrt", "strt", "ldrbt", "strbt",
+    "ldrh", "strh", "ldrsb", "ldrsh", "ldrd", "strd", "swp", "swpb", "pld",
+    "ldm", "stm", "push", "pop",
+    "b", "bl", "blx", "bx",
+    "mrs", "msr", "swi", "bkpt",
+    "cdp", "mcr", "mrc", "mcrr", "mrrc", "ldc", "stc"
+};
+
+const u8 InstructionClasses[IC_MAX][12] = { "undefined", "data", "multiply", "loadstore", "multiple", "branch", "status", "exception", "coprocessor" };
+
+const u8 Forms[FORM_MAX][16] = {
+    "none", "imm", "reg", "reg_shift_imm", "reg_shift_reg",
+    "mem_imm", "mem_reg", "mem_pre_imm", "mem_pre_reg", "mem_post_imm", "mem_post_reg",
+    "list_da", "list_ia", "list_db", "list_ib", "branch_imm", "branch_reg"
+};
+
+const u8 MnemonicClasses[MN_MAX] = {
+    IC_UNDEFINED,
+    IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA,
+    IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA,
+    IC_DATA, IC_DATA, IC_DATA, IC_DATA, IC_DATA,
+    IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY,
+    IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY,
+    IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY, IC_MULTIPLY,
+    IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE,
+    IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE, IC_LOADSTORE,
+    IC_MULTIPLE, IC_MULTIPLE, IC_MULTIPLE, IC_MULTIPLE,
+    IC_BRANCH, IC_BRANCH, IC_BRANCH, IC_BRANCH,
+    IC_STATUS, IC_STATUS, IC_EXCEPTION, IC_EXCEPTION,
+    IC_COPROCESSOR, IC_COPROCESSOR, IC_COPROCESSOR, IC_COPROCESSOR, IC_COPROCESSOR, IC_COPROCESSOR, IC_COPROCESSOR
+};
+
+const u16 DataProcessingMnemonics_thumb[16] = { MN_AND, MN_EOR, MN_LSL, MN_LSR, MN_ASR, MN_ADC, MN_SBC, MN_ROR, MN_TST, MN_NEG, MN_CMP, MN_CMN, MN_ORR, MN_MUL, MN_BIC, MN_MVN };
+const u16 LoadStoreRegisterMnemonics[8] = { MN_STR, MN_STRH, MN_STRB, MN_LDRSB, MN_LDR, MN_LDRH, MN_LDRB, MN_LDRSH };
+const u16 DSP_AddSubMnemonics[4] = { MN_QADD, MN_QSUB, MN_QDADD, MN_QDSUB };
+const u16 MultiplyLongMnemonics[4] = { MN_UMULL, MN_UMLAL, MN_SMULL, MN_SMLAL };
+
+/* Register lists, generated from the loops formerly in FormatStringRegisterList_thumb and FormatStringRegisterList_arm */
+/* Keeps their output exactly, including how streaks are grouped (or not) next to r7, lr and pc */
+
+const u8 RegisterLists_thumb[2][512][18] = { //[9th register is pc, lr][9-bit list], final text
+    { //pc
+        "", "r0", "r1", "r0,r1", "r2", "r0,r2", "r1,r2", "r0-r2",
+        "r3", "r0,r3", "r1,r3", "r0,r1,r3", "r2,r3", "r0,r2,r3", "r1-r3", "r0-r3",
+        "r4", "r0,r4", "r1,r4", "r0,r1,r4", "r2,r4", "r0,r2,r4", "r1,r2,r4", "r0-r2,r4",
+        "r3,r4", "r0,r3,r4", "r1,r3,r4", "r0,r1,r3,r4", "r2-r4", "r0,r2-r4", "r1-r4", "r0-r4",
+        "r5", "r0,r5", "r1,r5", "r0,r1,r5", "r2,r5", "r0,r2,r5", "r1,r2,r5", "r0-r2,r5",
+        "r3,r5", "r0,r3,r5", "r1,r3,r5", "r0,r1,r3,r5", "r2,r3,r5", "r0,r2,r3,r5", "r1-r3,r5", "r0-r3,r5",
+        "r4,r5", "r0,r4,r5", "r1,r4,r5", "r0,r1,r4,r5", "r2,r4,r5", "r0,r2,r4,r5", "r1,r2,r4,r5", "r0-r2,r4,r5",
+        "r3-r5", "r0,r3-r5", "r1,r3-r5", "r0,r1,r3-r5", "r2-r5", "r0,r2-r5", "r1-r5", "r0-r5",
+        "r6", "r0,r6", "r1,r6", "r0,r1,r6", "r2,r6", "r0,r2,r6", "r1,r2,r6", "r0-r2,r6",
+        "r3,r6", "r0,r3,r6", "r1,r3,r6", "r0,r1,r3,r6", "r2,r3,r6", "r0,r2,r3,r6", "r1-r3,r6", "r0-r3,r6",
+        "r4,r6", "r0,r4,r6", "r1,r4,r6", "r0,r1,r4,r6", "r2,r4,r6", "r0,r2,r4,r6", "r1,r2,r4,r6", "r0-r2,r4,r6",
+        "r3,r4,r6", "r0,r3,r4,r6", "r1,r3,r4,r6", "r0,r1,r3,r4,r6", "r2-r4,r6", "r0,r2-r4,r6", "r1-r4,r6", "r0-r4,r6",
+        "r5,r6", "r0,r5,r6", "r1,r5,r6", "r0,r1,r5,r6", "r2,r5,r6", "r0,r2,r5,r6", "r1,r2,r5,r6", "r0-r2,r5,r6",
+        "r3,r5,r6", "r0,r3,r5,r6", "r1,r3,r5,r6", "r0,r1,r3,r5,r6", "r2,r3,r5,r6", "r0,r2,r3,r5,r6", "r1-r3,r5,r6", "r0-r3,r5,r6",
+        "r4-r6", "r0,r4-r6", "r1,r4-r6", "r0,r1,r4-r6", "r2,r4-r6", "r0,r2,r4-r6", "r1,r2,r4-r6", "r0-r2,r4-r6",
+        "r3-r6", "r0,r3-r6", "r1,r3-r6", "r0,r1,r3-r6", "r2-r6", "r0,r2-r6", "r1-r6", "r0-r6",
+        "r7", "r0,r7", "r1,r7", "r0,r1,r7", "r2,r7", "r0,r2,r7", "r1,r2,r7", "r0-r2,r7",
+        "r3,r7", "r0,r3,r7", "r1,r3,r7", "r0,r1,r3,r7", "r2,r3,r7", "r0,r2,r3,r7", "r1-r3,r7", "r0-r3,r7",
+        "r4,r7", "r0,r4,r7", "r1,r4,r7", "r0,r1,r4,r7", "r2,r4,r7", "r0,r2,r4,r7", "r1,r2,r4,r7", "r0-r2,r4,r7",
+        "r3,r4,r7", "r0,r3,r4,r7", "r1,r3,r4,r7", "r0,r1,r3,r4,r7", "r2-r4,r7", "r0,r2-r4,r7", "r1-r4,r7", "r0-r4,r7",
+        "r5,r7", "r0,r5,r7", "r1,r5,r7", "r0,r1,r5,r7", "r2,r5,r7", "r0,r2,r5,r7", "r1,r2,r5,r7", "r0-r2,r5,r7",
+        "r3,r5,r7", "r0,r3,r5,r7", "r1,r3,r5,r7", "r0,r1,r3,r5,r7", "r2,r3,r5,r7", "r0,r2,r3,r5,r7", "r1-r3,r5,r7", "r0-r3,r5,r7",
+        "r4,r5,r7", "r0,r4,r5,r7", "r1,r4,r5,r7", "r0,r1,r4,r5,r7", "r2,r4,r5,r7", "r0,r2,r4,r5,r7", "r1,r2,r4,r5,r7", "r0-r2,r4,r5,r7",
+        "r3-r5,r7", "r0,r3-r5,r7", "r1,r3-r5,r7", "r0,r1,r3-r5,r7", "r2-r5,r7", "r0,r2-r5,r7", "r1-r5,r7", "r0-r5,r7",
+        "r6,r7", "r0,r6,r7", "r1,r6,r7", "r0,r1,r6,r7", "r2,r6,r7", "r0,r2,r6,r7", "r1,r2,r6,r7", "r0-r2,r6,r7",
+        "r3,r6,r7", "r0,r3,r6,r7", "r1,r3,r6,r7", "r0,r1,r3,r6,r7", "r2,r3,r6,r7", "r0,r2,r3,r6,r7", "r1-r3,r6,r7", "r0-r3,r6,r7",
+        "r4,r6,r7", "r0,r4,r6,r7", "r1,r4,r6,r7", "r0,r1,r4,r6,r7", "r2,r4,r6,r7", "r0,r2,r4,r6,r7", "r1,r2,r4,r6,r7", "r0-r2,r4,r6,r7",
+        "r3,r4,r6,r7", "r0,r3,r4,r6,r7", "r1,r3,r4,r6,r7", "r0,r1,r3,r4,r6,r7", "r2-r4,r6,r7", "r0,r2-r4,r6,r7", "r1-r4,r6,r7", "r0-r4,r6,r7",
+        "r5-r7", "r0,r5-r7", "r1,r5-r7", "r0,r1,r5-r7", "r2,r5-r7", "r0,r2,r5-r7", "r1,r2,r5-r7", "r0-r2,r5-r7",
+        "r3,r5-r7", "r0,r3,r5-r7", "r1,r3,r5-r7", "r0,r1,r3,r5-r7", "r2,r3,r5-r7", "r0,r2,r3,r5-r7", "r1-r3,r5-r7", "r0-r3,r5-r7",
+        "r4-r7", "r0,r4-r7", "r1,r4-r7", "r0,r1,r4-r7", "r2,r4-r7", "r0,r2,r4-r7", "r1,r2,r4-r7", "r0-r2,r4-r7",
+        "r3-r7", "r0,r3-r7", "r1,r3-r7", "r0,r1,r3-r7", "r2-r7", "r0,r2-r7", "r1-r7", "r0-r7",
+        "pc", "r0,pc", "r1,pc", "r0,r1,pc", "r2,pc", "r0,r2,pc", "r1,r2,pc", "r0-r2,pc",
+        "r3,pc", "r0,r3,pc", "r1,r3,pc", "r0,r1,r3,pc", "r2,r3,pc", "r0,r2,r3,pc", "r1-r3,pc", "r0-r3,pc",
+        "r4,pc", "r0,r4,pc", "r1,r4,pc", "r0,r1,r4,pc", "r2,r4,pc", "r0,r2,r4,pc", "r1,r2,r4,pc", "r0-r2,r4,pc",
+        "r3,r4,pc", "r0,r3,r4,pc", "r1,r3,r4,pc", "r0,r1,r3,r4,pc", "r2-r4,pc", "r0,r2-r4,pc", "r1-r4,pc", "r0-r4,pc",
+        "r5,pc", "r0,r5,pc", "r1,r5,pc", "r0,r1,r5,pc", "r2,r5,pc", "r0,r2,r5,pc", "r1,r2,r5,pc", "r0-r2,r5,pc",
+        "r3,r5,pc", "r0,r3,r5,pc", "r1,r3,r5,pc", "r0,r1,r3,r5,pc", "r2,r3,r5,pc", "r0,r2,r3,r5,pc", "r1-r3,r5,pc", "r0-r3,r5,pc",
+        "r4,r5,pc", "r0,r4,r5,pc", "r1,r4,r5,pc", "r0,r1,r4,r5,pc", "r2,r4,r5,pc", "r0,r2,r4,r5,pc", "r1,r2,r4,r5,pc", "r0-r2,r4,r5,pc",
+        "r3-r5,pc", "r0,r3-r5,pc", "r1,r3-r5,pc", "r0,r1,r3-r5,pc", "r2-r5,pc", "r0,r2-r5,pc", "r1-r5,pc", "r0-r5,pc",
+        "r6,pc", "r0,r6,pc", "r1,r6,pc", "r0,r1,r6,pc", "r2,r6,pc", "r0,r2,r6,pc", "r1,r2,r6,pc", "r0-r2,r6,pc",
+        "r3,r6,pc", "r0,r3,r6,pc", "r1,r3,r6,pc", "r0,r1,r3,r6,pc", "r2,r3,r6,pc", "r0,r2,r3,r6,pc", "r1-r3,r6,pc", "r0-r3,r6,pc",
+        "r4,r6,pc", "r0,r4,r6,pc", "r1,r4,r6,pc", "r0,r1,r4,r6,pc", "r2,r4,r6,pc", "r0,r2,r4,r6,pc", "r1,r2,r4,r6,pc", "r0-r2,r4,r6,pc",
+        "r3,r4,r6,pc", "r0,r3,r4,r6,pc", "r1,r3,r4,r6,pc", "r0,r1,r3,r4,r6,pc", "r2-r4,r6,pc", "r0,r2-r4,r6,pc", "r1-r4,r6,pc", "r0-r4,r6,pc",
+        "r5,r6,pc", "r0,r5,r6,pc", "r1,r5,r6,pc", "r0,r1,r5,r6,pc", "r2,r5,r6,pc", "r0,r2,r5,r6,pc", "r1,r2,r5,r6,pc", "r0-r2,r5,r6,pc",
+        "r3,r5,r6,pc", "r0,r3,r5,r6,pc", "r1,r3,r5,r6,pc", "r0,r1,r3,r5,r6,pc", "r2,r3,r5,r6,pc", "r0,r2,r3,r5,r6,pc", "r1-r3,r5,r6,pc", "r0-r3,r5,r6,pc",
+        "r4-r6,pc", "r0,r4-r6,pc", "r1,r4-r6,pc", "r0,r1,r4-r6,pc", "r2,r4-r6,pc", "r0,r2,r4-r6,pc", "r1,r2,r4-r6,pc", "r0-r2,r4-r6,pc",
+        "r3-r6,pc", "r0,r3-r6,pc", "r1,r3-r6,pc", "r0,r1,r3-r6,pc", "r2-r6,pc", "r0,r2-r6,pc", "r1-r6,pc", "r0-r6,pc",
+        "r7", "r0,r7", "r1,r7", "r0,r1,r7", "r2,r7", "r0,r2,r7", "r1,r2,r7", "r0-r2,r7",
+        "r3,r7", "r0,r3,r7", "r1,r3,r7", "r0,r1,r3,r7", "r2,r3,r7", "r0,r2,r3,r7", "r1-r3,r7", "r0-r3,r7",
+        "r4,r7", "r0,r4,r7", "r1,r4,r7", "r0,r1,r4,r7", "r2,r4,r7", "r0,r2,r4,r7", "r1,r2,r4,r7", "r0-r2,r4,r7",
+        "r3,r4,r7", "r0,r3,r4,r7", "r1,r3,r4,r7", "r0,r1,r3,r4,r7", "r2-r4,r7", "r0,r2-r4,r7", "r1-r4,r7", "r0-r4,r7",
+        "r5,r7", "r0,r5,r7", "r1,r5,r7", "r0,r1,r5,r7", "r2,r5,r7", "r0,r2,r5,r7", "r1,r2,r5,r7", "r0-r2,r5,r7",
+        "r3,r5,r7", "r0,r3,r5,r7", "r1,r3,r5,r7", "r0,r1,r3,r5,r7", "r2,r3,r5,r7", "r0,r2,r3,r5,r7", "r1-r3,r5,r7", "r0-r3,r5,r7",
+        "r4,r5,r7", "r0,r4,r5,r7", "r1,r4,r5,r7", "r0,r1,r4,r5,r7", "r2,r4,r5,r7", "r0,r2,r4,r5,r7", "r1,r2,r4,r5,r7", "r0-r2,r4,r5,r7",
+        "r3-r5,r7", "r0,r3-r5,r7", "r1,r3-r5,r7", "r0,r1,r3-r5,r7", "r2-r5,r7", "r0,r2-r5,r7", "r1-r5,r7", "r0-r5,r7",
+        "r6", "r0,r6", "r1,r6", "r0,r1,r6", "r2,r6", "r0,r2,r6", "r1,r2,r6", "r0-r2,r6",
+        "r3,r6", "r0,r3,r6", "r1,r3,r6", "r0,r1,r3,r6", "r2,r3,r6", "r0,r2,r3,r6", "r1-r3,r6", "r0-r3,r6",
+        "r4,r6", "r0,r4,r6", "r1,r4,r6", "r0,r1,r4,r6", "r2,r4,r6", "r0,r2,r4,r6", "r1,r2,r4,r6", "r0-r2,r4,r6",
+        "r3,r4,r6", "r0,r3,r4,r6", "r1,r3,r4,r6", "r0,r1,r3,r4,r6", "r2-r4,r6", "r0,r2-r4,r6", "r1-r4,r6", "r0-r4,r6",
+        "r5-r7,pc", "r0,r5-r7,pc", "r1,r5-r7,pc", "r0,r1,r5-r7,pc", "r2,r5-r7,pc", "r0,r2,r5-r7,pc", "r1,r2,r5-r7,pc", "r0-r2,r5-r7,pc",
+        "r3,r5-r7,pc", "r0,r3,r5-r7,pc", "r1,r3,r5-r7,pc", "r0,r1,r3,r5-r7,pc", "r2,r3,r5-r7,pc", "r0,r2,r3,r5-r7,pc", "r1-r3,r5-r7,pc", "r0-r3,r5-r7,pc",
+        "r4-r7,pc", "r0,r4-r7,pc", "r1,r4-r7,pc", "r0,r1,r4-r7,pc", "r2,r4-r7,pc", "r0,r2,r4-r7,pc", "r1,r2,r4-r7,pc", "r0-r2,r4-r7,pc",
+        "r3-r7,pc", "r0,r3-r7,pc", "r1,r3-r7,pc", "r0,r1,r3-r7,pc", "r2-r7,pc", "r0,r2-r7,pc", "r1-r7,pc", "r0-r7,pc"
+    },
+    { //lr
+        "", "r0", "r1", "r0,r1", "r2", "r0,r2", "r1,r2", "r0-r2",
+        "r3", "r0,r3", "r1,r3", "r0,r1,r3", "r2,r3", "r0,r2,r3", "r1-r3", "r0-r3",
+        "r4", "r0,r4", "r1,r4", "r0,r1,r4", "r2,r4", "r0,r2,r4", "r1,r2,r4", "r0-r2,r4",
+        "r3,r4", "r0,r3,r4", "r1,r3,r4", "r0,r1,r3,r4", "r2-r4", "r0,r2-r4", "r1-r4", "r0-r4",
+        "r5", "r0,r5", "r1,r5", "r0,r1,r5", "r2,r5", "r0,r2,r5", "r1,r2,r5", "r0-r2,r5",
+        "r3,r5", "r0,r3,r5", "r1,r3,r5", "r0,r1,r3,r5", "r2,r3,r5", "r0,r2,r3,r5", "r1-r3,r5", "r0-r3,r5",
+        "r4,r5", "r0,r4,r5", "r1,r4,r5", "r0,r1,r4,r5", "r2,r4,r5", "r0,r2,r4,r5", "r1,r2,r4,r5", "r0-r2,r4,r5",
+        "r3-r5", "r0,r3-r5", "r1,r3-r5", "r0,r1,r3-r5", "r2-r5", "r0,r2-r5", "r1-r5", "r0-r5",
+        "r6", "r0,r6", "r1,r6", "r0,r1,r6", "r2,r6", "r0,r2,r6", "r1,r2,r6", "r0-r2,r6",
+        "r3,r6", "r0,r3,r6", "r1,r3,r6", "r0,r1,r3,r6", "r2,r3,r6", "r0,r2,r3,r6", "r1-r3,r6", "r0-r3,r6",
+        "r4,r6", "r0,r4,r6", "r1,r4,r6", "r0,r1,r4,r6", "r2,r4,r6", "r0,r2,r4,r6", "r1,r2,r4,r6", "r0-r2,r4,r6",
+        "r3,r4,r6", "r0,r3,r4,r6", "r1,r3,r4,r6", "r0,r1,r3,r4,r6", "r2-r4,r6", "r0,r2-r4,r6", "r1-r4,r6", "r0-r4,r6",
+        "r5,r6", "r0,r5,r6", "r1,r5,r6", "r0,r1,r5,r6", "r2,r5,r6", "r0,r2,r5,r6", "r1,r2,r5,r6", "r0-r2,r5,r6",
+        "r3,r5,r6", "r0,r3,r5,r6", "r1,r3,r5,r6", "r0,r1,r3,r5,r6", "r2,r3,r5,r6", "r0,r2,r3,r5,r6", "r1-r3,r5,r6", "r0-r3,r5,r6",
+        "r4-r6", "r0,r4-r6", "r1,r4-r6", "r0,r1,r4-r6", "r2,r4-r6", "r0,r2,r4-r6", "r1,r2,r4-r6", "r0-r2,r4-r6",
+        "r3-r6", "r0,r3-r6", "r1,r3-r6", "r0,r1,r3-r6", "r2-r6", "r0,r2-r6", "r1-r6", "r0-r6",
+        "r7", "r0,r7", "r1,r7", "r0,r1,r7", "r2,r7", "r0,r2,r7", "r1,r2,r7", "r0-r2,r7",
+        "r3,r7", "r0,r3,r7", "r1,r3,r7", "r0,r1,r3,r7", "r2,r3,r7", "r0,r2,r3,r7", "r1-r3,r7", "r0-r3,r7",
+        "r4,r7", "r0,r4,r7", "r1,r4,r7", "r0,r1,r4,r7", "r2,r4,r7", "r0,r2,r4,r7", "r1,r2,r4,r7", "r0-r2,r4,r7",
+        "r3,r4,r7", "r0,r3,r4,r7", "r1,r3,r4,r7", "r0,r1,r3,r4,r7", "r2-r4,r7", "r0,r2-r4,r7", "r1-r4,r7", "r0-r4,r7",
+        "r5,r7", "r0,r5,r7", "r1,r5,r7", "r0,r1,r5,r7", "r2,r5,r7", "r0,r2,r5,r7", "r1,r2,r5,r7", "r0-r2,r5,r7",
+        "r3,r5,r7", "r0,r3,r5,r7", "r1,r3,r5,r7", "r0,r1,r3,r5,r7", "r2,r3,r5,r7", "r0,r2,r3,r5,r7", "r1-r3,r5,r7", "r0-r3,r5,r7",
+        "r4,r5,r7", "r0,r4,r5,r7", "r1,r4,r5,r7", "r0,r1,r4,r5,r7", "r2,r4,r5,r7", "r0,r2,r4,r5,r7", "r1,r2,r4,r5,r7", "r0-r2,r4,r5,r7",
+        "r3-r5,r7", "r0,r3-r5,r7", "r1,r3-r5,r7", "r0,r1,r3-r5,r7", "r2-r5,r7", "r0,r2-r5,r7", "r1-r5,r7", "r0-r5,r7",
+        "r6,r7", "r0,r6,r7", "r1,r6,r7", "r0,r1,r6,r7", "r2,r6,r7", "r0,r2,r6,r7", "r1,r2,r6,r7", "r0-r2,r6,r7",
+        "r3,r6,r7", "r0,r3,r6,r7", "r1,r3,r6,r7", "r0,r1,r3,r6,r7", "r2,r3,r6,r7", "r0,r2,r3,r6,r7", "r1-r3,r6,r7", "r0-r3,r6,r7",
+        "r4,r6,r7", "r0,r4,r6,r7", "r1,r4,r6,r7", "r0,r1,r4,r6,r7", "r2,r4,r6,r7", "r0,r2,r4,r6,r7", "r1,r2,r4,r6,r7", "r0-r2,r4,r6,r7",
+        "r3,r4,r6,r7", "r0,r3,r4,r6,r7", "r1,r3,r4,r6,r7", "r0,r1,r3,r4,r6,r7", "r2-r4,r6,r7", "r0,r2-r4,r6,r7", "r1-r4,r6,r7", "r0-r4,r6,r7",
+        "r5-r7", "r0,r5-r7", "r1,r5-r7", "r0,r1,r5-r7", "r2,r5-r7", "r0,r2,r5-r7", "r1,r2,r5-r7", "r0-r2,r5-r7",
+        "r3,r5-r7", "r0,r3,r5-r7", "r1,r3,r5-r7", "r0,r1,r3,r5-r7", "r2,r3,r5-r7", "r0,r2,r3,r5-r7", "r1-r3,r5-r7", "r0-r3,r5-r7",
+        "r4-r7", "r0,r4-r7", "r1,r4-r7", "r0,r1,r4-r7", "r2,r4-r7", "r0,r2,r4-r7", "r1,r2,r4-r7", "r0-r2,r4-r7",
+        "r3-r7", "r0,r3-r7", "r1,r3-r7", "r0,r1,r3-r7", "r2-r7", "r0,r2-r7", "r1-r7", "r0-r7",
+        "lr", "r0,lr", "r1,lr", "r0,r1,lr", "r2,lr", "r0,r2,lr", "r1,r2,lr", "r0-r2,lr",
+        "r3,lr", "r0,r3,lr", "r1,r3,lr", "r0,r1,r3,lr", "r2,r3,lr", "r0,r2,r3,lr", "r1-r3,lr", "r0-r3,lr",
+        "r4,lr", "r0,r4,lr", "r1,r4,lr", "r0,r1,r4,lr", "r2,r4,lr", "r0,r2,r4,lr", "r1,r2,r4,lr", "r0-r2,r4,lr",
+        "r3,r4,lr", "r0,r3,r4,lr", "r1,r3,r4,lr", "r0,r1,r3,r4,lr", "r2-r4,lr", "r0,r2-r4,lr", "r1-r4,lr", "r0-r4,lr",
+        "r5,lr", "r0,r5,lr", "r1,r5,lr", "r0,r1,r5,lr", "r2,r5,lr", "r0,r2,r5,lr", "r1,r2,r5,lr", "r0-r2,r5,lr",
+        "r3,r5,lr", "r0,r3,r5,lr", "r1,r3,r5,lr", "r0,r1,r3,r5,lr", "r2,r3,r5,lr", "r0,r2,r3,r5,lr", "r1-r3,r5,lr", "r0-r3,r5,lr",
+        "r4,r5,lr", "r0,r4,r5,lr", "r1,r4,r5,lr", "r0,r1,r4,r5,lr", "r2,r4,r5,lr", "r0,r2,r4,r5,lr", "r1,r2,r4,r5,lr", "r0-r2,r4,r5,lr",
+        "r3-r5,lr", "r0,r3-r5,lr", "r1,r3-r5,lr", "r0,r1,r3-r5,lr", "r2-r5,lr", "r0,r2-r5,lr", "r1-r5,lr", "r0-r5,lr",
+        "r6,lr", "r0,r6,lr", "r1,r6,lr", "r0,r1,r6,lr", "r2,r6,lr", "r0,r2,r6,lr", "r1,r2,r6,lr", "r0-r2,r6,lr",
+        "r3,r6,lr", "r0,r3,r6,lr", "r1,r3,r6,lr", "r0,r1,r3,r6,lr", "r2,r3,r6,lr", "r0,r2,r3,r6,lr", "r1-r3,r6,lr", "r0-r3,r6,lr",
+        "r4,r6,lr", "r0,r4,r6,lr", "r1,r4,r6,lr", "r0,r1,r4,r6,lr", "r2,r4,r6,lr", "r0,r2,r4,r6,lr", "r1,r2,r4,r6,lr", "r0-r2,r4,r6,lr",
+        "r3,r4,r6,lr", "r0,r3,r4,r6,lr", "r1,r3,r4,r6,lr", "r0,r1,r3,r4,r6,lr", "r2-r4,r6,lr", "r0,r2-r4,r6,lr", "r1-r4,r6,lr", "r0-r4,r6,lr",
+        "r5,r6,lr", "r0,r5,r6,lr", "r1,r5,r6,lr", "r0,r1,r5,r6,lr", "r2,r5,r6,lr", "r0,r2,r5,r6,lr", "r1,r2,r5,r6,lr", "r0-r2,r5,r6,lr",
+        "r3,r5,r6,lr", "r0,r3,r5,r6,lr", "r1,r3,r5,r6,lr", "r0,r1,r3,r5,r6,lr", "r2,r3,r5,r6,lr", "r0,r2,r3,r5,r6,lr", "r1-r3,r5,r6,lr", "r0-r3,r5,r6,lr",
+        "r4-r6,lr", "r0,r4-r6,lr", "r1,r4-r6,lr", "r0,r1,r4-r6,lr", "r2,r4-r6,lr", "r0,r2,r4-r6,lr", "r1,r2,r4-r6,lr", "r0-r2,r4-r6,lr",
+        "r3-r6,lr", "r0,r3-r6,lr", "r1,r3-r6,lr", "r0,r1,r3-r6,lr", "r2-r6,lr", "r0,r2-r6,lr", "r1-r6,lr", "r0-r6,lr",
+        "r7", "r0,r7", "r1,r7", "r0,r1,r7", "r2,r7", "r0,r2,r7", "r1,r2,r7", "r0-r2,r7",
+        "r3,r7", "r0,r3,r7", "r1,r3,r7", "r0,r1,r3,r7", "r2,r3,r7", "r0,r2,r3,r7", "r1-r3,r7", "r0-r3,r7",
+        "r4,r7", "r0,r4,r7", "r1,r4,r7", "r0,r1,r4,r7", "r2,r4,r7", "r0,r2,r4,r7", "r1,r2,r4,r7", "r0-r2,r4,r7",
+        "r3,r4,r7", "r0,r3,r4,r7", "r1,r3,r4,r7", "r0,r1,r3,r4,r7", "r2-r4,r7", "r0,r2-r4,r7", "r1-r4,r7", "r0-r4,r7",
+        "r5,r7", "r0,r5,r7", "r1,r5,r7", "r0,r1,r5,r7", "r2,r5,r7", "r0,r2,r5,r7", "r1,r2,r5,r7", "r0-r2,r5,r7",
+        "r3,r5,r7", "r0,r3,r5,r7", "r1,r3,r5,r7", "r0,r1,r3,r5,r7", "r2,r3,r5,r7", "r0,r2,r3,r5,r7", "r1-r3,r5,r7", "r0-r3,r5,r7",
+        "r4,r5,r7", "r0,r4,r5,r7", "r1,r4,r5,r7", "r0,r1,r4,r5,r7", "r2,r4,r5,r7", "r0,r2,r4,r5,r7", "r1,r2,r4,r5,r7", "r0-r2,r4,r5,r7",
+        "r3-r5,r7", "r0,r3-r5,r7", "r1,r3-r5,r7", "r0,r1,r3-r5,r7", "r2-r5,r7", "r0,r2-r5,r7", "r1-r5,r7", "r0-r5,r7",
+        "r6", "r0,r6", "r1,r6", "r0,r1,r6", "r2,r6", "r0,r2,r6", "r1,r2,r6", "r0-r2,r6",
+        "r3,r6", "r0,r3,r6", "r1,r3,r6", "r0,r1,r3,r6", "r2,r3,r6", "r0,r2,r3,r6", "r1-r3,r6", "r0-r3,r6",
+        "r4,r6", "r0,r4,r6", "r1,r4,r6", "r0,r1,r4,r6", "r2,r4,r6", "r0,r2,r4,r6", "r1,r2,r4,r6", "r0-r2,r4,r6",
+        "r3,r4,r6", "r0,r3,r4,r6", "r1,r3,r4,r6", "r0,r1,r3,r4,r6", "r2-r4,r6", "r0,r2-r4,r6", "r1-r4,r6", "r0-r4,r6",
+        "r5-r7,lr", "r0,r5-r7,lr", "r1,r5-r7,lr", "r0,r1,r5-r7,lr", "r2,r5-r7,lr", "r0,r2,r5-r7,lr", "r1,r2,r5-r7,lr", "r0-r2,r5-r7,lr",
+        "r3,r5-r7,lr", "r0,r3,r5-r7,lr", "r1,r3,r5-r7,lr", "r0,r1,r3,r5-r7,lr", "r2,r3,r5-r7,lr", "r0,r2,r3,r5-r7,lr", "r1-r3,r5-r7,lr", "r0-r3,r5-r7,lr",
+        "r4-r7,lr", "r0,r4-r7,lr", "r1,r4-r7,lr", "r0,r1,r4-r7,lr", "r2,r4-r7,lr", "r0,r2,r4-r7,lr", "r1,r2,r4-r7,lr", "r0-r2,r4-r7,lr",
+        "r3-r7,lr", "r0,r3-r7,lr", "r1,r3-r7,lr", "r0,r1,r3-r7,lr", "r2-r7,lr", "r0,r2-r7,lr", "r1-r7,lr", "r0-r7,lr"
+    }
+};
+
+const u8 RegisterListsLow_arm[256][16] = { //r0-r7, unfinished text ending with "," or "-"
+    "", "r0,", "r1,", "r0,r1,", "r2,", "r0,r2,", "r1,r2,", "r0-r2,",
+    "r3,", "r0,r3,", "r1,r3,", "r0,r1,r3,", "r2,r3,", "r0,r2,r3,", "r1-r3,", "r0-r3,",
+    "r4,", "r0,r4,", "r1,r4,", "r0,r1,r4,", "r2,r4,", "r0,r2,r4,", "r1,r2,r4,", "r0-r2,r4,",
+    "r3,r4,", "r0,r3,r4,", "r1,r3,r4,", "r0,r1,r3,r4,", "r2-r4,", "r0,r2-r4,", "r1-r4,", "r0-r4,",
+    "r5,", "r0,r5,", "r1,r5,", "r0,r1,r5,", "r2,r5,", "r0,r2,r5,", "r1,r2,r5,", "r0-r2,r5,",
+    "r3,r5,", "r0,r3,r5,", "r1,r3,r5,", "r0,r1,r3,r5,", "r2,r3,r5,", "r0,r2,r3,r5,", "r1-r3,r5,", "r0-r3,r5,",
+    "r4,r5,", "r0,r4,r5,", "r1,r4,r5,", "r0,r1,r4,r5,", "r2,r4,r5,", "r0,r2,r4,r5,", "r1,r2,r4,r5,", "r0-r2,r4,r5,",
+    "r3-r5,", "r0,r3-r5,", "r1,r3-r5,", "r0,r1,r3-r5,", "r2-r5,", "r0,r2-r5,", "r1-r5,", "r0-r5,",
+    "r6,", "r0,r6,", "r1,r6,", "r0,r1,r6,", "r2,r6,", "r0,r2,r6,", "r1,r2,r6,", "r0-r2,r6,",
+    "r3,r6,", "r0,r3,r6,", "r1,r3,r6,", "r0,r1,r3,r6,", "r2,r3,r6,", "r0,r2,r3,r6,", "r1-r3,r6,", "r0-r3,r6,",
+    "r4,r6,", "r0,r4,r6,", "r1,r4,r6,", "r0,r1,r4,r6,", "r2,r4,r6,", "r0,r2,r4,r6,", "r1,r2,r4,r6,", "r0-r2,r4,r6,",
+    "r3,r4,r6,", "r0,r3,r4,r6,", "r1,r3,r4,r6,", "r0,r1,r3,r4,r6,", "r2-r4,r6,", "r0,r2-r4,r6,", "r1-r4,r6,", "r0-r4,r6,",
+    "r5,r6,", "r0,r5,r6,", "r1,r5,r6,", "r0,r1,r5,r6,", "r2,r5,r6,", "r0,r2,r5,r6,", "r1,r2,r5,r6,", "r0-r2,r5,r6,",
+    "r3,r5,r6,", "r0,r3,r5,r6,", "r1,r3,r5,r6,", "r0,r1,r3,r5,r6,", "r2,r3,r5,r6,", "r0,r2,r3,r5,r6,", "r1-r3,r5,r6,", "r0-r3,r5,r6,",
+    "r4-r6,", "r0,r4-r6,", "r1,r4-r6,", "r0,r1,r4-r6,", "r2,r4-r6,", "r0,r2,r4-r6,", "r1,r2,r4-r6,", "r0-r2,r4-r6,",
+    "r3-r6,", "r0,r3-r6,", "r1,r3-r6,", "r0,r1,r3-r6,", "r2-r6,", "r0,r2-r6,", "r1-r6,", "r0-r6,",
+    "r7,", "r0,r7,", "r1,r7,", "r0,r1,r7,", "r2,r7,", "r0,r2,r7,", "r1,r2,r7,", "r0-r2,r7,",
+    "r3,r7,", "r0,r3,r7,", "r1,r3,r7,", "r0,r1,r3,r7,", "r2,r3,r7,", "r0,r2,r3,r7,", "r1-r3,r7,", "r0-r3,r7,",
+    "r4,r7,", "r0,r4,r7,", "r1,r4,r7,", "r0,r1,r4,r7,", "r2,r4,r7,", "r0,r2,r4,r7,", "r1,r2,r4,r7,", "r0-r2,r4,r7,",
+    "r3,r4,r7,", "r0,r3,r4,r7,", "r1,r3,r4,r7,", "r0,r1,r3,r4,r7,", "r2-r4,r7,", "r0,r2-r4,r7,", "r1-r4,r7,", "r0-r4,r7,",
+    "r5,r7,", "r0,r5,r7,", "r1,r5,r7,", "r0,r1,r5,r7,", "r2,r5,r7,", "r0,r2,r5,r7,", "r1,r2,r5,r7,", "r0-r2,r5,r7,",
+    "r3,r5,r7,", "r0,r3,r5,r7,", "r1,r3,r5,r7,", "r0,r1,r3,r5,r7,", "r2,r3,r5,r7,", "r0,r2,r3,r5,r7,", "r1-r3,r5,r7,", "r0-r3,r5,r7,",
+    "r4,r5,r7,", "r0,r4,r5,r7,", "r1,r4,r5,r7,", "r0,r1,r4,r5,r7,", "r2,r4,r5,r7,", "r0,r2,r4,r5,r7,", "r1,r2,r4,r5,r7,", "r0-r2,r4,r5,r7,",
+    "r3-r5,r7,", "r0,r3-r5,r7,", "r1,r3-r5,r7,", "r0,r1,r3-r5,r7,", "r2-r5,r7,", "r0,r2-r5,r7,", "r1-r5,r7,", "r0-r5,r7,",
+    "r6,", "r0,r6,", "r1,r6,", "r0,r1,r6,", "r2,r6,", "r0,r2,r6,", "r1,r2,r6,", "r0-r2,r6,",
+    "r3,r6,", "r0,r3,r6,", "r1,r3,r6,", "r0,r1,r3,r6,", "r2,r3,r6,", "r0,r2,r3,r6,", "r1-r3,r6,", "r0-r3,r6,",
+    "r4,r6,", "r0,r4,r6,", "r1,r4,r6,", "r0,r1,r4,r6,", "r2,r4,r6,", "r0,r2,r4,r6,", "r1,r2,r4,r6,", "r0-r2,r4,r6,",
+    "r3,r4,r6,", "r0,r3,r4,r6,", "r1,r3,r4,r6,", "r0,r1,r3,r4,r6,", "r2-r4,r6,", "r0,r2-r4,r6,", "r1-r4,r6,", "r0-r4,r6,",
+    "r5-", "r0,r5-", "r1,r5-", "r0,r1,r5-", "r2,r5-", "r0,r2,r5-", "r1,r2,r5-", "r0-r2,r5-",
+    "r3,r5-", "r0,r3,r5-", "r1,r3,r5-", "r0,r1,r3,r5-", "r2,r3,r5-", "r0,r2,r3,r5-", "r1-r3,r5-", "r0-r3,r5-",
+    "r4-", "r0,r4-", "r1,r4-", "r0,r1,r4-", "r2,r4-", "r0,r2,r4-", "r1,r2,r4-", "r0-r2,r4-",
+    "r3-", "r0,r3-", "r1,r3-", "r0,r1,r3-", "r2-", "r0,r2-", "r1-", "r0-"
+};
+
+const u8 RegisterListsStreak_arm[256] = { //length of the streak reaching r7, 3 for 3 or more
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3
+};
+
+const u8 RegisterListsHigh_arm[4][256][24] = { //[streak reaching r7][r8-r15], a leading "-" replaces the last character of the low part
+    {
+        "", "r8,", "r9,", "r8,r9,", "r10,", "r8,r10,", "r9,r10,", "r8-r10,",
+        "r11,", "r8,r11,", "r9,r11,", "r8,r9,r11,", "r10,r11,", "r8,r10,r11,", "r9-r11,", "r8-r11,",
+        "r12,", "r8,r12,", "r9,r12,", "r8,r9,r12,", "r10,r12,", "r8,r10,r12,", "r9,r10,r12,", "r8-r10,r12,",
+        "r11,r12,", "r8,r11,r12,", "r9,r11,r12,", "r8,r9,r11,r12,", "r10-r12,", "r8,r10-r12,", "r9-r12,", "r8-r12,",
+        "r13,", "r8,r13,", "r9,r13,", "r8,r9,r13,", "r10,r13,", "r8,r10,r13,", "r9,r10,r13,", "r8-r10,r13,",
+        "r11,r13,", "r8,r11,r13,", "r9,r11,r13,", "r8,r9,r11,r13,", "r10,r11,r13,", "r8,r10,r11,r13,", "r9-r11,r13,", "r8-r11,r13,",
+        "r12,r13,", "r8,r12,r13,", "r9,r12,r13,", "r8,r9,r12,r13,", "r10,r12,r13,", "r8,r10,r12,r13,", "r9,r10,r12,r13,", "r8-r10,r12,r13,",
+        "r11-r13,", "r8,r11-r13,", "r9,r11-r13,", "r8,r9,r11-r13,", "r10-r13,", "r8,r10-r13,", "r9-r13,", "r8-r13,",
+        "r14,", "r8,r14,", "r9,r14,", "r8,r9,r14,", "r10,r14,", "r8,r10,r14,", "r9,r10,r14,", "r8-r10,r14,",
+        "r11,r14,", "r8,r11,r14,", "r9,r11,r14,", "r8,r9,r11,r14,", "r10,r11,r14,", "r8,r10,r11,r14,", "r9-r11,r14,", "r8-r11,r14,",
+        "r12,r14,", "r8,r12,r14,", "r9,r12,r14,", "r8,r9,r12,r14,", "r10,r12,r14,", "r8,r10,r12,r14,", "r9,r10,r12,r14,", "r8-r10,r12,r14,",
+        "r11,r12,r14,", "r8,r11,r12,r14,", "r9,r11,r12,r14,", "r8,r9,r11,r12,r14,", "r10-r12,r14,", "r8,r10-r12,r14,", "r9-r12,r14,", "r8-r12,r14,",
+        "r13,r14,", "r8,r13,r14,", "r9,r13,r14,", "r8,r9,r13,r14,", "r10,r13,r14,", "r8,r10,r13,r14,", "r9,r10,r13,r14,", "r8-r10,r13,r14,",
+        "r11,r13,r14,", "r8,r11,r13,r14,", "r9,r11,r13,r14,", "r8,r9,r11,r13,r14,", "r10,r11,r13,r14,", "r8,r10,r11,r13,r14,", "r9-r11,r13,r14,", "r8-r11,r13,r14,",
+        "r12-r14,", "r8,r12-r14,", "r9,r12-r14,", "r8,r9,r12-r14,", "r10,r12-r14,", "r8,r10,r12-r14,", "r9,r10,r12-r14,", "r8-r10,r12-r14,",
+        "r11-r14,", "r8,r11-r14,", "r9,r11-r14,", "r8,r9,r11-r14,", "r10-r14,", "r8,r10-r14,", "r9-r14,", "r8-r14,",
+        "r15,", "r8,r15,", "r9,r15,", "r8,r9,r15,", "r10,r15,", "r8,r10,r15,", "r9,r10,r15,", "r8-r10,r15,",
+        "r11,r15,", "r8,r11,r15,", "r9,r11,r15,", "r8,r9,r11,r15,", "r10,r11,r15,", "r8,r10,r11,r15,", "r9-r11,r15,", "r8-r11,r15,",
+        "r12,r15,", "r8,r12,r15,", "r9,r12,r15,", "r8,r9,r12,r15,", "r10,r12,r15,", "r8,r10,r12,r15,", "r9,r10,r12,r15,", "r8-r10,r12,r15,",
+        "r11,r12,r15,", "r8,r11,r12,r15,", "r9,r11,r12,r15,", "r8,r9,r11,r12,r15,", "r10-r12,r15,", "r8,r10-r12,r15,", "r9-r12,r15,", "r8-r12,r15,",
+        "r13,r15,", "r8,r13,r15,", "r9,r13,r15,", "r8,r9,r13,r15,", "r10,r13,r15,", "r8,r10,r13,r15,", "r9,r10,r13,r15,", "r8-r10,r13,r15,",
+        "r11,r13,r15,", "r8,r11,r13,r15,", "r9,r11,r13,r15,", "r8,r9,r11,r13,r15,", "r10,r11,r13,r15,", "r8,r10,r11,r13,r15,", "r9-r11,r13,r15,", "r8-r11,r13,r15,",
+        "r12,r13,r15,", "r8,r12,r13,r15,", "r9,r12,r13,r15,", "r8,r9,r12,r13,r15,", "r10,r12,r13,r15,", "r8,r10,r12,r13,r15,", "r9,r10,r12,r13,r15,", "r8-r10,r12,r13,r15,",
+        "r11-r13,r15,", "r8,r11-r13,r15,", "r9,r11-r13,r15,", "r8,r9,r11-r13,r15,", "r10-r13,r15,", "r8,r10-r13,r15,", "r9-r13,r15,", "r8-r13,r15,",
+        "r14,", "r8,r14,", "r9,r14,", "r8,r9,r14,", "r10,r14,", "r8,r10,r14,", "r9,r10,r14,", "r8-r10,r14,",
+        "r11,r14,", "r8,r11,r14,", "r9,r11,r14,", "r8,r9,r11,r14,", "r10,r11,r14,", "r8,r10,r11,r14,", "r9-r11,r14,", "r8-r11,r14,",
+        "r12,r14,", "r8,r12,r14,", "r9,r12,r14,", "r8,r9,r12,r14,", "r10,r12,r14,", "r8,r10,r12,r14,", "r9,r10,r12,r14,", "r8-r10,r12,r14,",
+        "r11,r12,r14,", "r8,r11,r12,r14,", "r9,r11,r12,r14,", "r8,r9,r11,r12,r14,", "r10-r12,r14,", "r8,r10-r12,r14,", "r9-r12,r14,", "r8-r12,r14,",
+        "r13-", "r8,r13-", "r9,r13-", "r8,r9,r13-", "r10,r13-", "r8,r10,r13-", "r9,r10,r13-", "r8-r10,r13-",
+        "r11,r13-", "r8,r11,r13-", "r9,r11,r13-", "r8,r9,r11,r13-", "r10,r11,r13-", "r8,r10,r11,r13-", "r9-r11,r13-", "r8-r11,r13-",
+        "r12-pc,", "r8,r12-pc,", "r9,r12-pc,", "r8,r9,r12-pc,", "r10,r12-pc,", "r8,r10,r12-pc,", "r9,r10,r12-pc,", "r8-r10,r12-pc,",
+        "r11-pc,", "r8,r11-pc,", "r9,r11-pc,", "r8,r9,r11-pc,", "r10-pc,", "r8,r10-pc,", "r9-pc,", "r8-pc,"
+    },
+    {
+        "", "r8,", "r9,", "-r9,", "r10,", "r8,r10,", "r9,r10,", "-r10,",
+        "r11,", "r8,r11,", "r9,r11,", "-r9,r11,", "r10,r11,", "r8,r10,r11,", "r9-r11,", "-r11,",
+        "r12,", "r8,r12,", "r9,r12,", "-r9,r12,", "r10,r12,", "r8,r10,r12,", "r9,r10,r12,", "-r10,r12,",
+        "r11,r12,", "r8,r11,r12,", "r9,r11,r12,", "-r9,r11,r12,", "r10-r12,", "r8,r10-r12,", "r9-r12,", "-r12,",
+        "r13,", "r8,r13,", "r9,r13,", "-r9,r13,", "r10,r13,", "r8,r10,r13,", "r9,r10,r13,", "-r10,r13,",
+        "r11,r13,", "r8,r11,r13,", "r9,r11,r13,", "-r9,r11,r13,", "r10,r11,r13,", "r8,r10,r11,r13,", "r9-r11,r13,", "-r11,r13,",
+        "r12,r13,", "r8,r12,r13,", "r9,r12,r13,", "-r9,r12,r13,", "r10,r12,r13,", "r8,r10,r12,r13,", "r9,r10,r12,r13,", "-r10,r12,r13,",
+        "r11-r13,", "r8,r11-r13,", "r9,r11-r13,", "-r9,r11-r13,", "r10-r13,", "r8,r10-r13,", "r9-r13,", "-r13,",
+        "r14,", "r8,r14,", "r9,r14,", "-r9,r14,", "r10,r14,", "r8,r10,r14,", "r9,r10,r14,", "-r10,r14,",
+        "r11,r14,", "r8,r11,r14,", "r9,r11,r14,", "-r9,r11,r14,", "r10,r11,r14,", "r8,r10,r11,r14,", "r9-r11,r14,", "-r11,r14,",
+        "r12,r14,", "r8,r12,r14,", "r9,r12,r14,", "-r9,r12,r14,", "r10,r12,r14,", "r8,r10,r12,r14,", "r9,r10,r12,r14,", "-r10,r12,r14,",
+        "r11,r12,r14,", "r8,r11,r12,r14,", "r9,r11,r12,r14,", "-r9,r11,r12,r14,", "r10-r12,r14,", "r8,r10-r12,r14,", "r9-r12,r14,", "-r12,r14,",
+        "r13,r14,", "r8,r13,r14,", "r9,r13,r14,", "-r9,r13,r14,", "r10,r13,r14,", "r8,r10,r13,r14,", "r9,r10,r13,r14,", "-r10,r13,r14,",
+        "r11,r13,r14,", "r8,r11,r13,r14,", "r9,r11,r13,r14,", "-r9,r11,r13,r14,", "r10,r11,r13,r14,", "r8,r10,r11,r13,r14,", "r9-r11,r13,r14,", "-r11,r13,r14,",
+        "r12-r14,", "r8,r12-r14,", "r9,r12-r14,", "-r9,r12-r14,", "r10,r12-r14,", "r8,r10,r12-r14,", "r9,r10,r12-r14,", "-r10,r12-r14,",
+        "r11-r14,", "r8,r11-r14,", "r9,r11-r14,", "-r9,r11-r14,", "r10-r14,", "r8,r10-r14,", "r9-r14,", "-r14,",
+        "r15,", "r8,r15,", "r9,r15,", "-r9,r15,", "r10,r15,", "r8,r10,r15,", "r9,r10,r15,", "-r10,r15,",
+        "r11,r15,", "r8,r11,r15,", "r9,r11,r15,", "-r9,r11,r15,", "r10,r11,r15,", "r8,r10,r11,r15,", "r9-r11,r15,", "-r11,r15,",
+        "r12,r15,", "r8,r12,r15,", "r9,r12,r15,", "-r9,r12,r15,", "r10,r12,r15,", "r8,r10,r12,r15,", "r9,r10,r12,r15,", "-r10,r12,r15,",
+        "r11,r12,r15,", "r8,r11,r12,r15,", "r9,r11,r12,r15,", "-r9,r11,r12,r15,", "r10-r12,r15,", "r8,r10-r12,r15,", "r9-r12,r15,", "-r12,r15,",
+        "r13,r15,", "r8,r13,r15,", "r9,r13,r15,", "-r9,r13,r15,", "r10,r13,r15,", "r8,r10,r13,r15,", "r9,r10,r13,r15,", "-r10,r13,r15,",
+        "r11,r13,r15,", "r8,r11,r13,r15,", "r9,r11,r13,r15,", "-r9,r11,r13,r15,", "r10,r11,r13,r15,", "r8,r10,r11,r13,r15,", "r9-r11,r13,r15,", "-r11,r13,r15,",
+        "r12,r13,r15,", "r8,r12,r13,r15,", "r9,r12,r13,r15,", "-r9,r12,r13,r15,", "r10,r12,r13,r15,", "r8,r10,r12,r13,r15,", "r9,r10,r12,r13,r15,", "-r10,r12,r13,r15,",
+        "r11-r13,r15,", "r8,r11-r13,r15,", "r9,r11-r13,r15,", "-r9,r11-r13,r15,", "r10-r13,r15,", "r8,r10-r13,r15,", "r9-r13,r15,", "-r13,r15,",
+        "r14,", "r8,r14,", "r9,r14,", "-r9,r14,", "r10,r14,", "r8,r10,r14,", "r9,r10,r14,", "-r10,r14,",
+        "r11,r14,", "r8,r11,r14,", "r9,r11,r14,", "-r9,r11,r14,", "r10,r11,r14,", "r8,r10,r11,r14,", "r9-r11,r14,", "-r11,r14,",
+        "r12,r14,", "r8,r12,r14,", "r9,r12,r14,", "-r9,r12,r14,", "r10,r12,r14,", "r8,r10,r12,r14,", "r9,r10,r12,r14,", "-r10,r12,r14,",
+        "r11,r12,r14,", "r8,r11,r12,r14,", "r9,r11,r12,r14,", "-r9,r11,r12,r14,", "r10-r12,r14,", "r8,r10-r12,r14,", "r9-r12,r14,", "-r12,r14,",
+        "r13-", "r8,r13-", "r9,r13-", "-r9,r13-", "r10,r13-", "r8,r10,r13-", "r9,r10,r13-", "-r10,r13-",
+        "r11,r13-", "r8,r11,r13-", "r9,r11,r13-", "-r9,r11,r13-", "r10,r11,r13-", "r8,r10,r11,r13-", "r9-r11,r13-", "-r11,r13-",
+        "r12-pc,", "r8,r12-pc,", "r9,r12-pc,", "-r9,r12-pc,", "r10,r12-pc,", "r8,r10,r12-pc,", "r9,r10,r12-pc,", "-r10,r12-pc,",
+        "r11-pc,", "r8,r11-pc,", "r9,r11-pc,", "-r9,r11-pc,", "r10-pc,", "r8,r10-pc,", "r9-pc,", "-pc,"
+    },
+    {
+        "r7,", "-r8,", "r7,r9,", "-r9,", "r7,r10,", "-r8,r10,", "r7,r9,r10,", "-r10,",
+        "r7,r11,", "-r8,r11,", "r7,r9,r11,", "-r9,r11,", "r7,r10,r11,", "-r8,r10,r11,", "r7,r9-r11,", "-r11,",
+        "r7,r12,", "-r8,r12,", "r7,r9,r12,", "-r9,r12,", "r7,r10,r12,", "-r8,r10,r12,", "r7,r9,r10,r12,", "-r10,r12,",
+        "r7,r11,r12,", "-r8,r11,r12,", "r7,r9,r11,r12,", "-r9,r11,r12,", "r7,r10-r12,", "-r8,r10-r12,", "r7,r9-r12,", "-r12,",
+        "r7,r13,", "-r8,r13,", "r7,r9,r13,", "-r9,r13,", "r7,r10,r13,", "-r8,r10,r13,", "r7,r9,r10,r13,", "-r10,r13,",
+        "r7,r11,r13,", "-r8,r11,r13,", "r7,r9,r11,r13,", "-r9,r11,r13,", "r7,r10,r11,r13,", "-r8,r10,r11,r13,", "r7,r9-r11,r13,", "-r11,r13,",
+        "r7,r12,r13,", "-r8,r12,r13,", "r7,r9,r12,r13,", "-r9,r12,r13,", "r7,r10,r12,r13,", "-r8,r10,r12,r13,", "r7,r9,r10,r12,r13,", "-r10,r12,r13,",
+        "r7,r11-r13,", "-r8,r11-r13,", "r7,r9,r11-r13,", "-r9,r11-r13,", "r7,r10-r13,", "-r8,r10-r13,", "r7,r9-r13,", "-r13,",
+        "r7,r14,", "-r8,r14,", "r7,r9,r14,", "-r9,r14,", "r7,r10,r14,", "-r8,r10,r14,", "r7,r9,r10,r14,", "-r10,r14,",
+        "r7,r11,r14,", "-r8,r11,r14,", "r7,r9,r11,r14,", "-r9,r11,r14,", "r7,r10,r11,r14,", "-r8,r10,r11,r14,", "r7,r9-r11,r14,", "-r11,r14,",
+        "r7,r12,r14,", "-r8,r12,r14,", "r7,r9,r12,r14,", "-r9,r12,r14,", "r7,r10,r12,r14,", "-r8,r10,r12,r14,", "r7,r9,r10,r12,r14,", "-r10,r12,r14,",
+        "r7,r11,r12,r14,", "-r8,r11,r12,r14,", "r7,r9,r11,r12,r14,", "-r9,r11,r12,r14,", "r7,r10-r12,r14,", "-r8,r10-r12,r14,", "r7,r9-r12,r14,", "-r12,r14,",
+        "r7,r13,r14,", "-r8,r13,r14,", "r7,r9,r13,r14,", "-r9,r13,r14,", "r7,r10,r13,r14,", "-r8,r10,r13,r14,", "r7,r9,r10,r13,r14,", "-r10,r13,r14,",
+        "r7,r11,r13,r14,", "-r8,r11,r13,r14,", "r7,r9,r11,r13,r14,", "-r9,r11,r13,r14,", "r7,r10,r11,r13,r14,", "-r8,r10,r11,r13,r14,", "r7,r9-r11,r13,r14,", "-r11,r13,r14,",
+        "r7,r12-r14,", "-r8,r12-r14,", "r7,r9,r12-r14,", "-r9,r12-r14,", "r7,r10,r12-r14,", "-r8,r10,r12-r14,", "r7,r9,r10,r12-r14,", "-r10,r12-r14,",
+        "r7,r11-r14,", "-r8,r11-r14,", "r7,r9,r11-r14,", "-r9,r11-r14,", "r7,r10-r14,", "-r8,r10-r14,", "r7,r9-r14,", "-r14,",
+        "r7,r15,", "-r8,r15,", "r7,r9,r15,", "-r9,r15,", "r7,r10,r15,", "-r8,r10,r15,", "r7,r9,r10,r15,", "-r10,r15,",
+        "r7,r11,r15,", "-r8,r11,r15,", "r7,r9,r11,r15,", "-r9,r11,r15,", "r7,r10,r11,r15,", "-r8,r10,r11,r15,", "r7,r9-r11,r15,", "-r11,r15,",
+        "r7,r12,r15,", "-r8,r12,r15,", "r7,r9,r12,r15,", "-r9,r12,r15,", "r7,r10,r12,r15,", "-r8,r10,r12,r15,", "r7,r9,r10,r12,r15,", "-r10,r12,r15,",
+        "r7,r11,r12,r15,", "-r8,r11,r12,r15,", "r7,r9,r11,r12,r15,", "-r9,r11,r12,r15,", "r7,r10-r12,r15,", "-r8,r10-r12,r15,", "r7,r9-r12,r15,", "-r12,r15,",
+        "r7,r13,r15,", "-r8,r13,r15,", "r7,r9,r13,r15,", "-r9,r13,r15,", "r7,r10,r13,r15,", "-r8,r10,r13,r15,", "r7,r9,r10,r13,r15,", "-r10,r13,r15,",
+        "r7,r11,r13,r15,", "-r8,r11,r13,r15,", "r7,r9,r11,r13,r15,", "-r9,r11,r13,r15,", "r7,r10,r11,r13,r15,", "-r8,r10,r11,r13,r15,", "r7,r9-r11,r13,r15,", "-r11,r13,r15,",
+        "r7,r12,r13,r15,", "-r8,r12,r13,r15,", "r7,r9,r12,r13,r15,", "-r9,r12,r13,r15,", "r7,r10,r12,r13,r15,", "-r8,r10,r12,r13,r15,", "r7,r9,r10,r12,r13,r15,", "-r10,r12,r13,r15,",
+        "r7,r11-r13,r15,", "-r8,r11-r13,r15,", "r7,r9,r11-r13,r15,", "-r9,r11-r13,r15,", "r7,r10-r13,r15,", "-r8,r10-r13,r15,", "r7,r9-r13,r15,", "-r13,r15,",
+        "r7,r14,", "-r8,r14,", "r7,r9,r14,", "-r9,r14,", "r7,r10,r14,", "-r8,r10,r14,", "r7,r9,r10,r14,", "-r10,r14,",
+        "r7,r11,r14,", "-r8,r11,r14,", "r7,r9,r11,r14,", "-r9,r11,r14,", "r7,r10,r11,r14,", "-r8,r10,r11,r14,", "r7,r9-r11,r14,", "-r11,r14,",
+        "r7,r12,r14,", "-r8,r12,r14,", "r7,r9,r12,r14,", "-r9,r12,r14,", "r7,r10,r12,r14,", "-r8,r10,r12,r14,", "r7,r9,r10,r12,r14,", "-r10,r12,r14,",
+        "r7,r11,r12,r14,", "-r8,r11,r12,r14,", "r7,r9,r11,r12,r14,", "-r9,r11,r12,r14,", "r7,r10-r12,r14,", "-r8,r10-r12,r14,", "r7,r9-r12,r14,", "-r12,r14,",
+        "r7,r13-", "-r8,r13-", "r7,r9,r13-", "-r9,r13-", "r7,r10,r13-", "-r8,r10,r13-", "r7,r9,r10,r13-", "-r10,r13-",
+        "r7,r11,r13-", "-r8,r11,r13-", "r7,r9,r11,r13-", "-r9,r11,r13-", "r7,r10,r11,r13-", "-r8,r10,r11,r13-", "r7,r9-r11,r13-", "-r11,r13-",
+        "r7,r12-pc,", "-r8,r12-pc,", "r7,r9,r12-pc,", "-r9,r12-pc,", "r7,r10,r12-pc,", "-r8,r10,r12-pc,", "r7,r9,r10,r12-pc,", "-r10,r12-pc,",
+        "r7,r11-pc,", "-r8,r11-pc,", "r7,r9,r11-pc,", "-r9,r11-pc,", "r7,r10-pc,", "-r8,r10-pc,", "r7,r9-pc,", "-pc,"
+    },
+    {
+        "r7,", "r8,", "r7,r9,", "r9,", "r7,r10,", "r8,r10,", "r7,r9,r10,", "r10,",
+        "r7,r11,", "r8,r11,", "r7,r9,r11,", "r9,r11,", "r7,r10,r11,", "r8,r10,r11,", "r7,r9-r11,", "r11,",
+        "r7,r12,", "r8,r12,", "r7,r9,r12,", "r9,r12,", "r7,r10,r12,", "r8,r10,r12,", "r7,r9,r10,r12,", "r10,r12,",
+        "r7,r11,r12,", "r8,r11,r12,", "r7,r9,r11,r12,", "r9,r11,r12,", "r7,r10-r12,", "r8,r10-r12,", "r7,r9-r12,", "r12,",
+        "r7,r13,", "r8,r13,", "r7,r9,r13,", "r9,r13,", "r7,r10,r13,", "r8,r10,r13,", "r7,r9,r10,r13,", "r10,r13,",
+        "r7,r11,r13,", "r8,r11,r13,", "r7,r9,r11,r13,", "r9,r11,r13,", "r7,r10,r11,r13,", "r8,r10,r11,r13,", "r7,r9-r11,r13,", "r11,r13,",
+        "r7,r12,r13,", "r8,r12,r13,", "r7,r9,r12,r13,", "r9,r12,r13,", "r7,r10,r12,r13,", "r8,r10,r12,r13,", "r7,r9,r10,r12,r13,", "r10,r12,r13,",
+        "r7,r11-r13,", "r8,r11-r13,", "r7,r9,r11-r13,", "r9,r11-r13,", "r7,r10-r13,", "r8,r10-r13,", "r7,r9-r13,", "r13,",
+        "r7,r14,", "r8,r14,", "r7,r9,r14,", "r9,r14,", "r7,r10,r14,", "r8,r10,r14,", "r7,r9,r10,r14,", "r10,r14,",
+        "r7,r11,r14,", "r8,r11,r14,", "r7,r9,r11,r14,", "r9,r11,r14,", "r7,r10,r11,r14,", "r8,r10,r11,r14,", "r7,r9-r11,r14,", "r11,r14,",
+        "r7,r12,r14,", "r8,r12,r14,", "r7,r9,r12,r14,", "r9,r12,r14,", "r7,r10,r12,r14,", "r8,r10,r12,r14,", "r7,r9,r10,r12,r14,", "r10,r12,r14,",
+        "r7,r11,r12,r14,", "r8,r11,r12,r14,", "r7,r9,r11,r12,r14,", "r9,r11,r12,r14,", "r7,r10-r12,r14,", "r8,r10-r12,r14,", "r7,r9-r12,r14,", "r12,r14,",
+        "r7,r13,r14,", "r8,r13,r14,", "r7,r9,r13,r14,", "r9,r13,r14,", "r7,r10,r13,r14,", "r8,r10,r13,r14,", "r7,r9,r10,r13,r14,", "r10,r13,r14,",
+        "r7,r11,r13,r14,", "r8,r11,r13,r14,", "r7,r9,r11,r13,r14,", "r9,r11,r13,r14,", "r7,r10,r11,r13,r14,", "r8,r10,r11,r13,r14,", "r7,r9-r11,r13,r14,", "r11,r13,r14,",
+        "r7,r12-r14,", "r8,r12-r14,", "r7,r9,r12-r14,", "r9,r12-r14,", "r7,r10,r12-r14,", "r8,r10,r12-r14,", "r7,r9,r10,r12-r14,", "r10,r12-r14,",
+        "r7,r11-r14,", "r8,r11-r14,", "r7,r9,r11-r14,", "r9,r11-r14,", "r7,r10-r14,", "r8,r10-r14,", "r7,r9-r14,", "r14,",
+        "r7,r15,", "r8,r15,", "r7,r9,r15,", "r9,r15,", "r7,r10,r15,", "r8,r10,r15,", "r7,r9,r10,r15,", "r10,r15,",
+        "r7,r11,r15,", "r8,r11,r15,", "r7,r9,r11,r15,", "r9,r11,r15,", "r7,r10,r11,r15,", "r8,r10,r11,r15,", "r7,r9-r11,r15,", "r11,r15,",
+        "r7,r12,r15,", "r8,r12,r15,", "r7,r9,r12,r15,", "r9,r12,r15,", "r7,r10,r12,r15,", "r8,r10,r12,r15,", "r7,r9,r10,r12,r15,", "r10,r12,r15,",
+        "r7,r11,r12,r15,", "r8,r11,r12,r15,", "r7,r9,r11,r12,r15,", "r9,r11,r12,r15,", "r7,r10-r12,r15,", "r8,r10-r12,r15,", "r7,r9-r12,r15,", "r12,r15,",
+        "r7,r13,r15,", "r8,r13,r15,", "r7,r9,r13,r15,", "r9,r13,r15,", "r7,r10,r13,r15,", "r8,r10,r13,r15,", "r7,r9,r10,r13,r15,", "r10,r13,r15,",
+        "r7,r11,r13,r15,", "r8,r11,r13,r15,", "r7,r9,r11,r13,r15,", "r9,r11,r13,r15,", "r7,r10,r11,r13,r15,", "r8,r10,r11,r13,r15,", "r7,r9-r11,r13,r15,", "r11,r13,r15,",
+        "r7,r12,r13,r15,", "r8,r12,r13,r15,", "r7,r9,r12,r13,r15,", "r9,r12,r13,r15,", "r7,r10,r12,r13,r15,", "r8,r10,r12,r13,r15,", "r7,r9,r10,r12,r13,r15,", "r10,r12,r13,r15,",
+        "r7,r11-r13,r15,", "r8,r11-r13,r15,", "r7,r9,r11-r13,r15,", "r9,r11-r13,r15,", "r7,r10-r13,r15,", "r8,r10-r13,r15,", "r7,r9-r13,r15,", "r13,r15,",
+        "r7,r14,", "r8,r14,", "r7,r9,r14,", "r9,r14,", "r7,r10,r14,", "r8,r10,r14,", "r7,r9,r10,r14,", "r10,r14,",
+        "r7,r11,r14,", "r8,r11,r14,", "r7,r9,r11,r14,", "r9,r11,r14,", "r7,r10,r11,r14,", "r8,r10,r11,r14,", "r7,r9-r11,r14,", "r11,r14,",
+        "r7,r12,r14,", "r8,r12,r14,", "r7,r9,r12,r14,", "r9,r12,r14,", "r7,r10,r12,r14,", "r8,r10,r12,r14,", "r7,r9,r10,r12,r14,", "r10,r12,r14,",
+        "r7,r11,r12,r14,", "r8,r11,r12,r14,", "r7,r9,r11,r12,r14,", "r9,r11,r12,r14,", "r7,r10-r12,r14,", "r8,r10-r12,r14,", "r7,r9-r12,r14,", "r12,r14,",
+        "r7,r13-", "r8,r13-", "r7,r9,r13-", "r9,r13-", "r7,r10,r13-", "r8,r10,r13-", "r7,r9,r10,r13-", "r10,r13-",
+        "r7,r11,r13-", "r8,r11,r13-", "r7,r9,r11,r13-", "r9,r11,r13-", "r7,r10,r11,r13-", "r8,r10,r11,r13-", "r7,r9-r11,r13-", "r11,r13-",
+        "r7,r12-pc,", "r8,r12-pc,", "r7,r9,r12-pc,", "r9,r12-pc,", "r7,r10,r12-pc,", "r8,r10,r12-pc,", "r7,r9,r10,r12-pc,", "r10,r12-pc,",
+        "r7,r11-pc,", "r8,r11-pc,", "r7,r9,r11-pc,", "r9,r11-pc,", "r7,r10-pc,", "r8,r10-pc,", "r7,r9-pc,", "pc,"
+    }
+};
+
+DTHUMB_THREAD_LOCAL u32 debug_na_count = 0; //per thread, so the decoders can be called from several threads at once
+DECODETABLES decode_tables = { 0 }; //shared by all threads, only changed by AttachDecodeTables and DetachDecodeTables
+#ifdef DTHUMB_INSTRUMENT
+DTHUMB_THREAD_LOCAL INSTRUMENTATION dthumb_instrumentation; //per thread, see MergeInstrumentation
+#endif
+
+/* LIBRARY FUNCTIONS */
+
+#ifdef DTHUMB_INSTRUMENT
+static u64 GetInstrumentationTime(void) {
+    /* Nanoseconds */
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int InstrumentedSprintf(int line, const u8* function, u8* str, const u8* format, ...) {
+    /* sprintf counting one hit for the leaf at line */
+    INSTRUMENTATION* in = &dthumb_instrumentation;
+    u32 i = line & (INSTRUMENT_LINES - 1);
+    in->hits[i]++;
+    in->functions[i] = function;
+    in->formats[i] = format;
+    va_list args;
+    va_start(args, format);
+    u64 t = GetInstrumentationTime();
+    int size = vsprintf((char*)str, (const char*)format, args);
+    in->format_ns += GetInstrumentationTime() - t;
+    va_end(args);
+    return size;
+}
+
+static void AddInstrumentation(INSTRUMENTATION* dst, const INSTRUMENTATION* src) {
+    /* dst += src */
+    for (u32 i = 0; i < INSTRUMENT_LINES; i++)
+    {
+        if (!src->hits[i]) continue;
+        dst->hits[i] += src->hits[i];
+        dst->functions[i] = src->functions[i];
+        dst->formats[i] = src->formats[i];
+    }
+    dst->format_ns += src->format_ns;
+    dst->special_register_ns += src->special_register_ns;
+}
+
+static void MergeInstrumentation(INSTRUMENTATION* dst) {
+    /* Move the counters of the calling thread to dst, calls on the same dst must not overlap */
+    AddInstrumentation(dst, &dthumb_instrumentation);
+    memset(&dthumb_instrumentation, 0, sizeof(INSTRUMENTATION));
+}
+
+static int CompareInstrumentationHits(const void* a, const void* b) {
+    /* By hits, descending */
+    u64 x = **(const u64**)a;
+    u64 y = **(const u64**)b;
+    return (x < y) - (x > y);
+}
+
+static void DumpInstrumentation(FILE* fp, const INSTRUMENTATION* in) {
+    /* Report of the leaves sorted by hits, then the time spent formatting */
+    const u64* leaves[INSTRUMENT_LINES];
+    u32 count = 0;
+    u64 total = 0;
+    for (u32 i = 0; i < INSTRUMENT_LINES; i++)
+    {
+        if (!in->hits[i]) continue;
+        leaves[count++] = &in->hits[i];
+        total += in->hits[i];
+    }
+    qsort(leaves, count, sizeof(leaves[0]), CompareInstrumentationHits);
+    fprintf(fp, "Decoder leaves (%u hit, %llu outputs):\n", count, total);
+    fprintf(fp, "%14s %7s  %-36s %s\n", "hits", "%", "function:line", "format");
+    for (u32 k = 0; k < count; k++)
+    {
+        u32 i = (u32)(leaves[k] - in->hits);
+        u8 where[64];
+        snprintf(where, sizeof(where), "%s:%u", in->functions[i], i);
+        fprintf(fp, "%14llu %6.2f%%  %-36s %s\n", in->hits[i], 100.0 * in->hits[i] / total, where, in->formats[i]);
+    }
+    fprintf(fp, "Formatting: %.3f ms (%.1f ns per output)\n", in->format_ns / 1e6, total ? (double)in->format_ns / total : 0.0);
+    fprintf(fp, "CheckSpecialRegister: %.3f ms\n", in->special_register_ns / 1e6);
+}
+#endif
+
+static void SubstituteSubString(u8 dst[STRING_LENGTH], u32 index, const u8* sub, u32 size) {
+    /* Insert sub string of length size (< STRING_LENGTH) at dst[index] */
+    u8 tmp[STRING_LENGTH] = { 0 }; //zinit
+    memcpy(&tmp, sub, size); //init
+    memcpy(&tmp[size], &dst[index + size + 1], STRING_LENGTH - index - size - 1); //save
+    memcpy(&dst[index], tmp, STRING_LENGTH - index - 1); //restore
+}
+
+static void CheckSpecialRegister(u8* str, int size) {
+    /* Replace special registers by their common names */
+    //(r12->ip), r13->sp, r14->lr, r15->pc
+    //todo: check for size != -1
+    for (int i = 0; i < size; i++) //when using a variable string size (return value of sprintf), 10% faster than constant size of STRING_LENGTH 64
+    {
+        if (str[i] == 'r')
+        {
+            switch (*(u16*)&str[i + 1])
+            {
+            case 0x3331: //"13"
+            {
+                SubstituteSubString(str, i, "sp", sizeof("sp") - 1);
+                break;
+            }
+            case 0x3431: //"14"
+            {
+                SubstituteSubString(str, i, "lr", sizeof("lr") - 1);
+                break;
+            }
+            case 0x3531: //"15"
+            {
+                SubstituteSubString(str, i, "pc", sizeof("pc") - 1);
+                break;
+            }
+            }
+        }
+    }
+}
+
+#ifndef DTHUMB_INSTRUMENT
+static int FormatText(u8* str, const u8* format, ...) {
+    /* sprintf for the only conversions the decoders use: %s, %u, %X and %c, without flags or width */
+    static const u8 digits[16] = "0123456789ABCDEF";
+    va_list args;
+    va_start(args, format);
+    u8* p = str;
+    for (const u8* f = format; *f; f++)
+    {
+        if (*f != '%')
+        {
+            *p++ = *f;
+            continue;
+        }
+        switch (*++f)
+        {
+        case 's':
+        {
+            const u8* s = va_arg(args, const u8*);
+            while (*s) *p++ = *s++;
+            break;
+        }
+        case 'u':
+        {
+            u32 v = va_arg(args, u32);
+            u8 tmp[10];
+            u32 n = 0;
+            do
+            {
+                tmp[n++] = '0' + v % 10;
+                v /= 10;
+            } while (v);
+            while (n) *p++ = tmp[--n];
+            break;
+        }
+        case 'X':
+        {
+            u32 v = va_arg(args, u32);
+            int shift = 28;
+            while (shift && !(v >> shift)) shift -= 4; //no leading zeros
+            for (; shift >= 0; shift -= 4) *p++ = digits[(v >> shift) & 0xf];
+            break;
+        }
+        case 'c':
+        {
+            *p++ = (u8)va_arg(args, int);
+            break;
+        }
+        }
+    }
+    va_end(args);
+    *p = 0;
+    return (int)(p - str);
+}
+#endif
+
+#ifdef DTHUMB_INSTRUMENT
+static void InstrumentedCheckSpecialRegister(u8* str, int size) {
+    /* CheckSpecialRegister, timed */
+    u64 t = GetInstrumentationTime();
+    CheckSpecialRegister(str, size);
+    dthumb_instrumentation.special_register_ns += GetInstrumentationTime() - t;
+}
+
+/* Every output of the text decoders goes through sprintf, each call site is a leaf */
+#define sprintf(str, ...) InstrumentedSprintf(__LINE__, __func__, str, __VA_ARGS__)
+#define CheckSpecialRegister InstrumentedCheckSpecialRegister
+#else
+#define sprintf FormatText //the decoders' formats, several times faster than the C library
+#endif
+
+static u32 CountBits(u8 b) {
+    /* Count bits in a byte */
+    static const u8 lut[16] = { 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4 };
+    return lut[b & 0x0f] + lut[b >> 4];
+}
+
+static u32 FormatStringRegisterList_thumb(u8 str[STRING_LENGTH], u16 reg, u8 lr) {
+    /* Format str according to the 9-bit reg bitfield, the 9th register is lr if lr is set, else pc */
+    memcpy(str, RegisterLists_thumb[lr != 0][reg & 0x1ff], sizeof(RegisterLists_thumb[0][0]));
+    return CountBits(reg & 0xff) + BITS(reg, 8, 1); //number of 1 bits
+}
+
+static u32 FormatStringRegisterList_arm(u8 str[STRING_LENGTH], u16 reg) {
+    /* Format str according to the reg bitfield, from the fragments of its low and high bytes */
+    const u8* low = RegisterListsLow_arm[reg & 0xff];
+    const u8* high = RegisterListsHigh_arm[RegisterListsStreak_arm[reg & 0xff]][reg >> 8];
+    memcpy(str, low, sizeof(RegisterListsLow_arm[0]));
+    u32 pos = (u32)strlen(low);
+    if (*high == '-') //the streak reaching r7 got hyphenated in the high byte
+    {
+        str[pos - 1] = '-';
+        high++;
+    }
+    u32 size = (u32)strlen(high);
+    memcpy(&str[pos], high, size + 1);
+    pos += size;
+    if (pos) str[pos - 1] = 0; //removes the comma on the last register
+    return CountBits(reg & 0xff) + CountBits(reg >> 8); //number of 1 bits
+}
+
+static int FormatExtraLoadStore(u32 c, u8* str, u8 cond, const u8* op) {
+    /*  */
+    u8 rd = BITS(c, 12, 4);
+    u8 rn = BITS(c, 16, 4);
+    u8 w = BITS(c, 21, 1);
+    u8 p = BITS(c, 24, 1);
+    if (BITS(c, 22, 1)) //immediate
+    {
+        u8 ofs = (BITS(c, 8, 4) << 4) | BITS(c, 0, 4);
+        u8* sign = BITS(c, 23, 1) ? "+" : "-";
+        if (p) //offset, pre-indexed
+        {
+            u8* pre = w ? "!" : "";
+            return sprintf(str, "%s%s r%u, [r%u, #%s0x%X]%s", op, Conditions[cond], rd, rn, sign, ofs, pre);
+        }
+        else //post-indexed
+        {
+            if (w) return 0; //w must be 0, else UNPREDICTABLE //todo: check if really invalid
+            return sprintf(str, "%s%s r%u, [r%u], #%s0x%X", op, Conditions[cond], rd, rn, sign, ofs);
+        }
+    }
+    else //register
+    {
+        u8 rm = BITS(c, 0, 4);
+        u8* sign = BITS(c, 23, 1) ? "" : "-"; //implicit "+" in front of registers
+        if (p) //offset, pre-indexed
+        {
+            u8* pre = w ? "!" : "";
+            return sprintf(str, "%s%s r%u, [r%u, %sr%u]%s", op, Conditions[cond], rd, rn, sign, rm, pre);
+        }
+        else //post-indexed
+        {
+            if (w) return 0; //w must be 0, else UNPREDICTABLE //todo: check if really invalid
+            return sprintf(str, "%s%s r%u, [r%u], %sr%u", op, Conditions[cond], rd, rn, sign, rm);
+        }
+    }
+}
+
+static DTHUMB_INLINE u32 Disassemble_thumb_generic(u32 code, u8 str[STRING_LENGTH], ARMARCH tv) {
+    /* Convert a code into a string, return size of the processed code (SIZE_16 or SIZE_32) */
+
+    THUMBSIZE thumb_size = SIZE_16; //return value
+    u16 c = code & 0xffff; //low 16 bits
+    int size = 0; //return value of sprintf to be passed to CheckSpecialRegister
+
+    switch (c >> 13)
+    {
+    case 0: //0x0000 //LSL, LSR, ASR, ADD, SUB
+    {
+        u8 rd = BITS(c, 0, 3);
+        u8 rn = BITS(c, 3, 3);
+        u8 index = BITS(c, 11, 2);
+        if (index == 3) //ADD, SUB, MOV
+        {
+            if (BITS(c, 6, 5) == 16) //MOV (2) (technically ADD (1) with imm==0)
+            {
+                size = sprintf(str, "mov r%u, r%u", rd, rn);
+            }
+            else
+            {
+                u8 rm_imm = BITS(c, 6, 3);
+                u8* op = (BITS(c, 9, 1)) ? "sub" : "add";
+                if (BITS(c, 10, 1)) //ADD (1), SUB (1) -immediate
+                {
+                    size = sprintf(str, "%s r%u, r%u, #0x%X", op, rd, rn, rm_imm);
+                }
+                else //ADD (3), SUB (3) -register
+                {
+                    size = sprintf(str, "%s r%u, r%u, r%u", op, rd, rn, rm_imm);
+                }
+            }
+        }
+        else //Shift by immediate: LSL (1), LSR (1), ASR (1) 
+        {
+            size = sprintf(str, "%s r%u, r%u, #0x%X", ShiftImmediate[index], rd, rn, BITS(c, 6, 5));
+        }
+        break;
+    }
+
+    case 1: //0x2000 //MOV (1), CMP (1), ADD (2), SUB (2)
+    {
+        size = sprintf(str, "%s r%u, #0x%X", MovCmpAddSubImmediate[BITS(c, 11, 2)], BITS(c, 8, 3), BITS(c, 0, 8));
+        break;
+    }
+
+    case 2: //0x4000 //lots...
+    {
+        switch (BITS(c, 10, 3))
+        {
+        case 0: //Data-processing registers
+        {
+            size = sprintf(str, "%s r%u, r%u", DataProcessing_thumb[BITS(c, 6, 4)], BITS(c, 0, 3), BITS(c, 3, 3));
+            break;
+        }
+        case 1: //Special data processing
+        {
+            u8 rd = (BITS(c, 7, 1) << 3) | (BITS(c, 0, 3));
+            u8 rm = BITS(c, 3, 4);
+            u8 op = BITS(c, 8, 2);
+            if (op == 3) //Branch/exchange instruction set
+            {
+                if (BITS(c, 0, 3)) break; //Should-Be-Zero
+                if (BITS(c, 7, 1)) //BLX (2)
+                {
+                    if (tv < ARMv5TE) break; //UNPREDICTABLE prior to ARM version 5
+                    size = sprintf(str, "blx r%u", rm);
+                }
+                else //BX
+                {
+                    size = sprintf(str, "bx r%u", rm);
+                }
+            }
+            else //ADD (4), CMP (3), MOV (3)
+            {
+                if (!BITS(c, 6, 2)) break; //UNPREDICTABLE
+                size = sprintf(str, "%s r%u, r%u", AddCmpMovHighRegisters[op], rd, rm);
+            }
+            break;
+        }
+        default: //Load from literal pool, Load/Store register offset
+        {
+            if (BITS(c, 12, 1)) //Load/store register offset
+            {
+                size = sprintf(str, "%s r%u, [r%u, r%u]", LoadStoreRegister[BITS(c, 9, 3)], BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 3));
+            }
+            else //LDR (3)
+            {
+                if (!BITS(c, 11, 1)) break; //Should-Be-One
+                size = sprintf(str, "ldr r%u, [pc, #0x%X]", BITS(c, 8, 3), 4 * BITS(c, 0, 8));
+            }
+        }
+        }
+        break;
+    }
+
+    case 3: //0x6000 //STR, LDR, STRB, LDRB
+    {
+        switch (BITS(c, 11, 2))
+        {
+        case 0: //STR (1)
+        {
+            size = sprintf(str, "str r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), 4 * BITS(c, 6, 5));
+            break;
+        }
+        case 1: //LDR (1)
+        {
+            size = sprintf(str, "ldr r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), 4 * BITS(c, 6, 5));
+            break;
+        }
+        case 2: //STRB (1)
+        {
+            size = sprintf(str, "strb r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 5));
+            break;
+        }
+        case 3: //LDRB (1)
+        {
+            size = sprintf(str, "ldrb r%u, [r%u, #0x%X]", BITS(c, 0, 3), BITS(c, 3, 3), BITS(c, 6, 5));
+            break;
+        }
+        }
+        break;
+    }
+
+    case 4: //0x8000 //STR, LDR, STRH, LDRH
+    {
+        if (BITS(c, 12, 1)) //LDR (4), STR (3)
+        {
+            u8* op = (BITS(c, 11, 1)) ? "ldr" : "str";
+            size = sprintf(str, "%s r%u, [sp, #0x%X]", op, BITS(c, 8, 3), 4 * BITS(c, 0, 8));
+        }
+        else //LDRH (1), STRH (1)
+        {
+            u8* op = (BITS(c, 11, 1)) ? "ldrh" : "strh";
+            size = sprintf(str, "%s r%u, [r%u, #0x%X]", op, BITS(c, 0, 3), BITS(c, 3, 3), 2 * BITS(c, 6, 5));
+        }
+        break;
+    }
+
+    case 5: //0xA000 //Misc and ADD to sp or pc
+    {
+        if (BITS(c, 12, 1)) //Misc, fig 6-2
+        {
+            switch (BITS(c, 8, 4))
+            {
+            case 0: //ADD (4), SUB (7) to/from SP
+            {
+                u8* op = (BITS(c, 7, 1)) ? "sub" : "add";
+                size = sprintf(str, "%s sp, #0x%X", op, 4 * BITS(c, 0, 7));
+                break;
+            }
+            //PUSH/POP
+            case 4:
+            case 5:
+            case 12:
+            case 13:
+            {
+                u8 reglist[STRING_LENGTH] = { 0 };
+                u16 registers = BITS(c, 0, 9);
+                if (BITS(c, 11, 1)) //POP
+                {
+                    if (FormatStringRegisterList_thumb(reglist, registers, 0)) //if BitCount(registers) < 1 then UNPREDICTABLE
+                    {
+                        size = sprintf(str, "pop {%s}", reglist);
+                    }
+                }
+                else //PUSH
+                {
+                    if (FormatStringRegisterList_thumb(reglist, registers, 1)) //if BitCount(registers) < 1 then UNPREDICTABLE
+                    {
+                        size = sprintf(str, "push {%s}", reglist);
+                    }
+                }
+                break;
+            }
+            case 14: //BKPT
+            {
+                if (tv >= ARMv5TE) //undefined prior to ARM version 5
+                {
+                    size = sprintf(str, "bkpt #0x%X", BITS(c, 0, 8));
+                }
+                break;
+            }
+            }
+        }
+        else //ADD (5), ADD (6) to SP or PC
+        {
+            u8* sppc = (BITS(c, 11, 2)) ? "sp" : "pc";
+            size = sprintf(str, "add r%u, %s, #0x%X", BITS(c, 8, 3), sppc, 4 * BITS(c, 0, 8));
+        }
+        break;
+    }
+
+    case 6: //0xC000 //B, SWI, LDMIA, STMIA
+    {
+        if (BITS(c, 12, 1)) //Conditional branch, Undefined, System call
+        {
+            switch (BITS(c, 8, 4))
+            {
+            case 14: //UDF "Permanently undefined space", OS dependant
+            {
+                //size = sprintf(str, "udf #0x%X", BITS(c, 0, 8)); //note: not an instruction in ARMv5TE, just UNDEFINED
+                break;
+            }
+            case 15: //SWI
+            {
+                size = sprintf(str, "swi #0x%X", BITS(c, 0, 8));
+                break;
+            }
+            default: //B (1) conditional
+            {
+                size = sprintf(str, "b%s #0x%X", Conditions[BITS(c, 8, 4)], 4 + 2 * SIGNEX32_BITS(c, 0, 8));
+            }
+            }
+        }
+        else //LDMIA/STMIA
+        {
+            u8 reglist[STRING_LENGTH] = { 0 };
+            u8* op = (BITS(c, 11, 1)) ? "ldmia" : "stmia";
+            if (FormatStringRegisterList_thumb(reglist, BITS(c, 0, 8), 0))
+            {
+                size = sprintf(str, "%s r%u!, {%s}", op, BITS(c, 8, 3), reglist);
+            }
+        }
+        break;
+    }
+
+    case 7: //0xE000 //B, then 32-bit instructions
+    {
+        switch (BITS(c, 11, 2))
+        {
+        case 0:
+        {
+            size = sprintf(str, "b #0x%X", 4 + 2 * SIGNEX32_BITS(c, 0, 11)); //11 bits to signed 32 bits
+            break;
+        }
+        //case 1: break; //undefined on first pass
+        case 2: //BL/BLX prefix
+        {
+            c = code >> 16; //get high 16 bits
+            if (c >> 13 == 7)
+            {
+                switch (BITS(c, 11, 2))
+                {
+                case 1: //BLX (1)
+                {
+                    if (tv < ARMv5TE) break;
+                    if (!BITS(c, 0, 1))
+                    {
+                        thumb_size = SIZE_32;
+
+                        int ofs = (BITS((code & 0xffff), 0, 11)) << 12;
+                        ofs = SIGNEX32_VAL(ofs, 23);
+                        ofs += 4;
+                        ofs += 2 * BITS(c, 0, 11);
+                        //note: bit 1 should be cleared (word aligned target address)
+                        size = sprintf(str, "blx #0x%X", ofs);
+                    }
+                    break;
+                }
+                //case 2: break; //BL/BLX prefix
+                case 3: //BL
+                {
+                    thumb_size = SIZE_32;
+
+                    int ofs = (BITS((code & 0xffff), 0, 11)) << 12;
+                    ofs = SIGNEX32_VAL(ofs, 23);
+                    ofs += 4;
+                    ofs += 2 * BITS(c, 0, 11);
+
+                    size = sprintf(str, "bl #0x%X", ofs);
+                    break;
+                }
+                }
+            }
+            break;
+        }
+        }
+        break;
+    }
+    }
+    if (!str[0]) //in case nothing was written to it
+    {
+        debug_na_count++;
+        sprintf(str, "n/a");
+    }
+    else
+    {
+        CheckSpecialRegister(str, size); //formatting
+    }
+    return thumb_size;
+}
+
+DTHUMB_SPECIALIZE(u32, Disassemble_thumb, u8*)
+
+static DTHUMB_INLINE void Disassemble_arm_generic(u32 code, u8 str[STRING_LENGTH], ARMARCH av) {
+    /**/
+    //Reference: page 68 of 811 from the ARM Architecture reference manual june 2000 edition
+    //todo: proper support for ARMv4T 
+    //todo: extra caution for UNPREDICTABLE instructions, need to remove them? or decode regardless?
+
+    int size = 0; //return value of sprintf to be passed to CheckSpecialRegister
+    u32 c = code; //alias
+    u8 cond = BITS(c, 28, 4); //condition bits
+
+    //todo: check unconditional instructions first to avoid putting a check later at each stage
+
+    switch (BITS(c, 25, 3))
+    {
+    case 0: //Data processing, DSP instructions, ...
+    {
+        if (cond == NV) break; //undefined
+        if (BITS(c, 4, 1))
+        {
+            if (BITS(c, 7, 1)) //Multiplies, extra load/stores: see fig 3-2
+            {
+                u8 oplo = BITS(c, 5, 2);
+                if (!oplo)
+                {
+                    if (!BITS(c, 22, 3)) //Multiply (accumulate)
+                    {
+                        u8 rm = BITS(c, 0, 4);
+                        u8 rs = BITS(c, 8, 4);
+                        u8 rn = BITS(c, 12, 4);
+                        u8 rd = BITS(c, 16, 4);
+                        u8* s = BITS(c, 20, 1) ? "s" : "";
+                        if (BITS(c, 21, 1)) //MLA
+                        {
+                            size = sprintf(str, "mla%s%s r%u, r%u, r%u, r%u", s, Conditions[cond], rd, rm, rs, rn);
+                        }
+                        else //MUL
+                        {
+                            if (rn) break; //Should-Be-Zero
+                            size = sprintf(str, "mul%s%s r%u, r%u, r%u", s, Conditions[cond], rd, rm, rs);
+                        }
+                    }
+                    else if (BITS(c, 23, 1)) //Multiply (accumulate) long
+                    {
+                        u8* s = BITS(c, 20, 1) ? "s" : "";
+                        size = sprintf(str, "%s%s%s r%u, r%u, r%u, r%u", MultiplyLong[BITS(c, 21, 2)], s, Conditions[cond], BITS(c, 12, 4), BITS(c, 16, 4), BITS(c, 0, 4), BITS(c, 8, 4));
+                    }
+                    else //Swap/swap byte (SWP, SWPB)
+                    {
+                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
+                        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or no
+                        size = sprintf(str, "swp%s%s r%u, r%u, [r%u]", b, Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4), BITS(c, 16, 4));
+                    }
+                }
+                else
+                {
+                    if (!BITS(c, 22, 1) && BITS(c, 8, 4)) break; //Should-Be-Zero if register offset
+                    if (oplo == 1) //Load/store halfword
+                    {
+                        u8* l = BITS(c, 20, 1) ? "ldrh" : "strh"; //load or store
+                        size = FormatExtraLoadStore(c, str, cond, l);
+                    }
+                    else
+                    {
+                        if (BITS(c, 20, 1)) //Load signed halfword/byte
+                        {
+                            u8* h = BITS(c, 5, 1) ? "ldrsh" : "ldrsb"; //halfword/byte
+                            size = FormatExtraLoadStore(c, str, cond, h);
+                        }
+                        else //Load/store two words
+                        {
+                            if (BITS(c, 12, 1)) break; //undefined if Rd is odd
+                            u8* s = BITS(c, 5, 1) ? "strd" : "ldrd"; //store or load
+                            size = FormatExtraLoadStore(c, str, cond, s);
+                        }
+                    }
+                }
+            }
+            else
+            {
+                if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
+                {
+                    u8 oplo = BITS(c, 5, 2);
+                    u8 ophi = BITS(c, 21, 2);
+                    switch (oplo)
+                    {
+                    case 0:
+                    {
+                        if (ophi == 3) //CLZ
+                        {
+                            //note: if PC is in either register, UNPREDICTABLE
+                            if (av < ARMv5TE) break;
+                            if (!BITS(c, 16, 4) || !BITS(c, 8, 4)) break; //Should-Be-One
+                            size = sprintf(str, "clz%s r%u, r%u", Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4));
+                        }
+                        else if (ophi == 1)//Branch/exchange instruction set (BX)
+                        {
+                            if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
+                            size = sprintf(str, "bx%s r%u", Conditions[cond], BITS(c, 0, 4));
+                        }
+                        break;
+                    }
+                    case 1: //BLX (2)
+                    {
+                        if (av < ARMv5TE) break;
+                        if (ophi != 1) break;
+                        if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
+                        size = sprintf(str, "blx%s r%u", Conditions[cond], BITS(c, 0, 4));
+                        break;
+                    }
+                    case 2: //Enhanced DSP add/sub (QADD, QDADD, QSUB, QDSUB)
+                    {
+                        //note: if PC is in either register, UNPREDICTABLE
+                        if (av < ARMv5TE) break;
+                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
+                        size = sprintf(str, "%s%s r%u, r%u, r%u", DSP_AddSub[ophi], Conditions[cond], BITS(c, 12, 4), BITS(c, 0, 4), BITS(c, 16, 4));
+                        break;
+                    }
+                    case 3: //Software breakpoint (BKPT)
+                    {
+                        if (av < ARMv5TE) break;
+                        if (ophi != 1) break;
+                        size = sprintf(str, "bkpt #0x%X", (BITS(c, 8, 12) << 4) | BITS(c, 0, 4));
+                        break;
+                    }
+                    }
+                }
+                else //Data processing register shift
+                {
+                    u8 rm = BITS(c, 0, 4);
+                    u8 shift = BITS(c, 5, 2);
+                    u8 rs = BITS(c, 8, 4);
+                    u8 rd = BITS(c, 12, 4);
+                    u8 rn = BITS(c, 16, 4);
+                    u8 op = BITS(c, 21, 4);
+                    u8* s = BITS(c, 20, 1) ? "s" : "";
+                    switch (op)
+                    {
+                    case 8: //TST
+                    case 9: //TEQ
+                    case 10: //CMP
+                    case 11: //CMN
+                    {
+                        size = sprintf(str, "%s%s r%u, r%u, %s r%u", DataProcessing_arm[op], Conditions[cond], rn, rm, Shifters[shift], rs);
+                        break;
+                    }
+                    case 13: //MOV
+                    case 15: //MVN
+                    {
+                        size = sprintf(str, "%s%s%s r%u, r%u, %s r%u", DataProcessing_arm[op], s, Conditions[cond], rd, rm, Shifters[shift], rs);
+                        break;
+                    }
+                    default:
+                    {
+                        size = sprintf(str, "%s%s%s r%u, r%u, r%u, %s r%u", DataProcessing_arm[op], s, Conditions[cond], rd, rn, rm, Shifters[shift], rs);
+                    }
+                    }
+                }
+            }
+        }
+        else //bit 4 == 0
+        {
+            if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
+            {
+                if (BITS(c, 7, 1)) //Enhanced DSP multiplies
+                {
+                    if (av < ARMv5TE) break;
+                    //note: PC for any register is UNPREDICTABLE
+                    u8 rm = BITS(c, 0, 4);
+                    u8* x = BITS(c, 5, 1) ? "t" : "b";
+                    u8* y = BITS(c, 6, 1) ? "t" : "b";
+                    u8 rs = BITS(c, 8, 4);
+                    u8 rn_rdlo = BITS(c, 12, 4);
+                    u8 rd_rdhi = BITS(c, 16, 4);
+                    u8 op = BITS(c, 21, 2);
+                    switch (op)
+                    {
+                    case 0: //SMLA
+                    {
+                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rd_rdhi, rm, rs, rn_rdlo);
+                        break;
+                    }
+                    case 1: //SMLAW, SMULW
+                    {
+                        if (BITS(c, 5, 1)) //SMULW
+                        {
+                            if (rn_rdlo) break; //Should-Be-Zero 
+                            size = sprintf(str, "smulw%s%s r%u, r%u, r%u", y, Conditions[cond], rd_rdhi, rm, rs);
+                        }
+                        else //SMLAW
+                        {
+                            size = sprintf(str, "smlaw%s%s r%u, r%u, r%u, r%u", y, Conditions[cond], rd_rdhi, rm, rs, rn_rdlo);
+                        }
+                        break;
+                    }
+                    case 2: //SMLAL
+                    {
+                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rn_rdlo, rd_rdhi, rm, rs);
+                        break;
+                    }
+                    case 3: //SMUL
+                    {
+                        if (rn_rdlo) break; //Should-Be-Zero
+                        size = sprintf(str, "%s%s%s%s r%u, r%u, r%u", DSP_Multiplies[op], x, y, Conditions[cond], rd_rdhi, rm, rs);
+                        break;
+                    }
+                    }
+                }
+                else
+                {
+                    if (!BITS(c, 0, 12) && BITS(c, 16, 4) == 15) //Move status reg to reg (MRS)
+                    {
+                        //note: if Rd == PC, UNPREDICTABLE
+                        u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
+                        size = sprintf(str, "mrs%s r%u, %cpsr", Conditions[cond], BITS(c, 12, 4), sreg);
+                    }
+                    else if (BITS(c, 12, 4) == 15 && !BITS(c, 4, 8) && BITS(c, 21, 1)) //Move reg to status reg (MSR register)
+                    {
+                        u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
+                        size = sprintf(str, "msr%s %cpsr_%s, r%u", Conditions[cond], sreg, MSR_cxsf[BITS(c, 16, 4)], BITS(c, 0, 4));
+                    }
+                }
+            }
+            else //Data processing immediate shift
+            {
+                //todo: write a function for all 3 Data Processing switch-cases
+                u8 op = BITS(c, 21, 4);
+                u8 rm = BITS(c, 0, 4);
+                u8 shift = BITS(c, 5, 2);
+                u8 shift_imm = BITS(c, 7, 5);
+                u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
+                if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
+                if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm);
+                u8 rd = BITS(c, 12, 4);
+                u8 rn = BITS(c, 16, 4);
+                u8* s = BITS(c, 20, 1) ? "s" : "";
+                switch (op)
+                {
+                case 8: //TST
+                case 9: //TEQ
+                case 10: //CMP
+                case 11: //CMN
+                {
+                    size = sprintf(str, "%s%s r%u, r%u, %s", DataProcessing_arm[op], Conditions[cond], rn, rm, sstr);
+                    break;
+                }
+                case 13: //MOV
+                case 15: //MVN
+                {
+                    size = sprintf(str, "%s%s%s r%u, r%u, %s", DataProcessing_arm[op], s, Conditions[cond], rd, rm, sstr);
+                    break;
+                }
+                default:
+                {
+                    size = sprintf(str, "%s%s%s r%u, r%u, r%u, %s", DataProcessing_arm[op], s, Conditions[cond], rd, rn, rm, sstr);
+                }
+                }
+            }
+        }
+        break;
+    }
+    case 1: //Data processing and MSR immediate
+    {
+        if (cond == NV) break; //undefined
+        u32 imm = ROR(BITS(c, 0, 8), 2 * BITS(c, 8, 4));
+
+        if (BITS(c, 12, 4) == 15 && !BITS(c, 20, 1)) //MSR immediate
+        {
+            u8 sreg = BITS(c, 22, 1) ? 's' : 'c'; //SPSR (1) or CPSR (0)
+            size = sprintf(str, "msr%s %cpsr_%s, #0x%X", Conditions[cond], sreg, MSR_cxsf[BITS(c, 16, 4)], imm);
+        }
+        else //Data processing immediate
+        {
+            u8 op = BITS(c, 21, 4);
+            u8 rd = BITS(c, 12, 4);
+            u8 rn = BITS(c, 16, 4);
+            u8* s = BITS(c, 20, 1) ? "s" : "";
+            switch (op)
+            {
+            case 8: //TST
+            case 9: //TEQ
+            case 10: //CMP
+            case 11: //CMN
+                //always update the condition codes: <op>{<cond>} <Rn>, <shift>
+            {
+                size = sprintf(str, "%s%s r%u, #0x%X", DataProcessing_arm[op], Conditions[cond], rn, imm);
+                break;
+            }
+            case 13: //MOV
+            case 15: //MVN
+                //only one source operand: <op>{<cond>}{S} <Rd>, <shift>
+            {
+                size = sprintf(str, "%s%s%s r%u, #0x%X", DataProcessing_arm[op], s, Conditions[cond], rd, imm);
+                break;
+            }
+
+            default: //others: <op>{<cond>}{S} <Rd>, <Rn>, <shift>
+            {
+                size = sprintf(str, "%s%s%s r%u, r%u, #0x%X", DataProcessing_arm[op], s, Conditions[cond], rd, rn, imm);
+            }
+            }
+        }
+        break;
+    }
+    case 2: //Load/store immediate offset
+    {
+        if (cond == NV) break; //undefined
+        //bits 25, 24, 23 and 21 decide the addressing mode
+        u8 rd = BITS(c, 12, 4);
+        u8 rn = BITS(c, 16, 4);
+        u16 imm = BITS(c, 0, 12); //12 bits for LDR and LDRB (8 bits for LDRH and LDRSB)
+        u8* sign = BITS(c, 23, 1) ? "+" : "-"; //sign of the immediate offset
+        u8* ls = BITS(c, 20, 1) ? "ldr" : "str"; //load or store
+        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or word
+        if (BITS(c, 24, 1)) //offset or pre-indexed
+        {
+            u8* w = BITS(c, 21, 1) ? "!" : ""; //pre-indexed if 1
+            size = sprintf(str, "%s%s%s r%u, [r%u, #%s0x%X]%s", ls, b, Conditions[cond], rd, rn, sign, imm, w);
+        }
+        else //post-indexed
+        {
+            u8* w = BITS(c, 21, 1) ? "t" : ""; //user mode
+            size = sprintf(str, "%s%s%s%s r%u, [r%u], #%s0x%X", ls, b, w, Conditions[cond], rd, rn, sign, imm);
+        }
+        break;
+    }
+    case 3: //Load/store register offset
+    {
+        if (cond == NV) break; //undefined
+        if (BITS(c, 4, 1)) break; //undefined
+        u8 rm = BITS(c, 0, 4);
+        u8 shift = BITS(c, 5, 2);
+        u16 shift_imm = BITS(c, 7, 5);
+        u8 rd = BITS(c, 12, 4);
+        u8 rn = BITS(c, 16, 4);
+        u8* sign = BITS(c, 23, 1) ? "" : "-"; //sign of the immediate offset, + implicit
+        u8* ls = BITS(c, 20, 1) ? "ldr" : "str"; //load or store
+        u8* b = BITS(c, 22, 1) ? "b" : ""; //byte or word
+        u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
+        if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
+        if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm);
+        //note: if rm==r15 or rn==r15 then UNPREDICTABLE
+        //note: if rn==rm then UNPREDICTABLE
+        if (BITS(c, 24, 1)) //offset or pre-indexed
+        {
+            u8* w = BITS(c, 21, 1) ? "!" : ""; //pre-indexed if 1
+            size = sprintf(str, "%s%s%s r%u, [r%u, %sr%u, %s]%s", ls, b, Conditions[cond], rd, rn, sign, rm, sstr, w);
+        }
+        else //post-indexed
+        {
+            u8* w = BITS(c, 21, 1) ? "t" : ""; //user mode
+            size = sprintf(str, "%s%s%s%s r%u, [r%u], %sr%u, %s", ls, b, w, Conditions[cond], rd, rn, sign, rm, sstr);
+        }
+        break;
+    }
+    case 4: //Load/store multiple
+    {
+        if (cond == NV) break; //undefined
+        u8 reglist[STRING_LENGTH] = { 0 };
+        FormatStringRegisterList_arm(reglist, BITS(c, 0, 16));
+        u8 rn = BITS(c, 16, 4);
+        u8* w = BITS(c, 21, 1) ? "!" : ""; //W bit
+        u8* s = BITS(c, 22, 1) ? "^" : ""; //S bit
+        u8 am = BITS(c, 23, 2); //PU bits
+        u8* op = (BITS(c, 20, 1)) ? "ldm" : "stm"; //LDM or STM
+        size = sprintf(str, "%s%s%s r%u%s, {%s}%s", op, AddressingModes[am], Conditions[cond], rn, w, reglist, s);
+        break;
+    }
+    case 5: //Branch instructions
+    {
+        if (cond == NV && av >= ARMv5TE) //BLX (1)
+        {
+            size = sprintf(str, "blx #0x%X", 8 + 4 * SIGNEX32_BITS(c, 0, 24) + 2 * BITS(c, 24, 1));
+        }
+        else //B, BL
+        {
+            u8* l = (BITS(c, 24, 1)) ? "l" : "";
+            size = sprintf(str, "b%s%s #0x%X", l, Conditions[cond], 8 + 4 * SIGNEX32_BITS(c, 0, 24));
+        }
+        break;
+    }
+    case 6: //Coprocessor load/store, Double register transfers 
+    {
+        if (av < ARMv5TE) break;
+        //if (cond == NV) break; //only unpredictable prior to ARMv5
+        if (BITS(c, 21, 4) == 2) //MCRR, MRRC
+        {
+            //note: if PC is specified for Rn or Rd, UNPREDICTABLE
+            u8* op = BITS(c, 20, 1) ? "mrrc" : "mcrr";
+            size = sprintf(str, "%s%s p%u, #0x%X, r%u, r%u, c%u", op, Conditions[cond], BITS(c, 8, 4), BITS(c, 4, 4), BITS(c, 12, 4), BITS(c, 16, 4), BITS(c, 0, 4));
+        }
+        else //LDC, STC
+        {
+            //todo: reformat the cond checks into only 1
+            if (cond == NV && av < ARMv5TE) break;
+
+            u8* op = BITS(c, 20, 1) ? "ldc" : "stc";
+            u8* str_cond = (cond == NV) ? "2" : Conditions[cond]; //LDC2, STC2
+            u8* l = BITS(c, 22, 1) ? "l" : ""; //long
+            u8 str_cond_long[8] = { 0 };
+            if (cond == NV) sprintf(str_cond_long, "%s%s", str_cond, l);
+            else sprintf(str_cond_long, "%s%s", l, str_cond);
+            u8 ofs_opt = BITS(c, 0, 8);
+            u8 cp_num = BITS(c, 8, 4);
+            u8 crd = BITS(c, 12, 4);
+            u8 rn = BITS(c, 16, 4);
+            u8* sign = BITS(c, 23, 1) ? "+" : "-";
+            switch ((2 * BITS(c, 24, 1)) | BITS(c, 21, 1)) //(p*2) | w
+            {
+            case 0: //p==0, w==0 //unindexed: [<Rn>], <option>
+            {
+                size = sprintf(str, "%s%s p%u, c%u, [r%u], {0x%X}", op, str_cond_long, cp_num, crd, rn, ofs_opt);
+                break;
+            }
+            case 1: //p==0, w==1 //post indexed: [<Rn>], #+/-<offset_8>*4
+            {
+                size = sprintf(str, "%s%s p%u, c%u, [r%u], #%s0x%X", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
+                break;
+            }
+            case 2: //p==1, w==0 //immediate offset: [<Rn>, #+/-<offset_8>*4]
+            {
+                size = sprintf(str, "%s%s p%u, c%u, [r%u, #%s0x%X]", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
+                break;
+            }
+            case 3: //p==1, w==1 //pre indexed: [<Rn>, #+/-<offset_8>*4]!
+            {
+                size = sprintf(str, "%s%s p%u, c%u, [r%u, #%s0x%X]!", op, str_cond_long, cp_num, crd, rn, sign, 4 * ofs_opt);
+                break;
+            }
+            }
+        }
+        break;
+    }
+    case 7: //Software Interrupt, Coprocessor register transfer, Coprocessor data processing
+    {
+        if (BITS(c, 24, 1)) //SWI
+        {
+            if (cond == NV) break;
+            size = sprintf(str, "swi%s #0x%X", Conditions[cond], BITS(c, 0, 24));
+        }
+        else
+        {
+            if (cond == NV && av < ARMv5TE) break;
+
+            u8 crn = BITS(c, 16, 4);
+            u8 p = BITS(c, 8, 4);
+            u8 rd_crd = BITS(c, 12, 4);
+            u8 crm = BITS(c, 0, 4);
+            u8 op2 = BITS(c, 5, 3);
+            u8* str_cond = (cond == NV) ? "2" : Conditions[cond]; //suffix
+            if (BITS(c, 4, 1)) //MCR, MRC
+            {
+                u8* str_op = BITS(c, 20, 1) ? "mrc" : "mcr";
+                size = sprintf(str, "%s%s p%u, #0x%X, r%u, c%u, c%u, #0x%X", str_op, str_cond, p, BITS(c, 21, 3), rd_crd, crn, crm, op2);
+            }
+            else //CDP
+            {
+                size = sprintf(str, "cdp%s p%u, #0x%X, c%u, c%u, c%u, #0x%X", str_cond, p, BITS(c, 20, 4), rd_crd, crn, crm, op2); //no condition suffix for cdp2
+            }
+        }
+        break;
+    }
+    }
+
+    //also: unconditionnal instructions if bits 28 to 31 are 1111
+    if (!str[0] && (c & 0xFD70F000) == 0xF550F000) //Cache preload (PLD)
+    {
+        //todo: placing it here is wasteful, find a workaround
+        //bit-pattern: 1111 01x1 x101 xxxx 1111 xxxx xxxx xxxx
+        //data mask  : 1111 1101 0111 0000 1111 0000 0000 0000
+        //inst. mask : 1111 0101 0101 0000 1111 0000 0000 0000
+        //note: only offset addressing modes
+        // [<Rn>, #+/-<offset_12>] //immediate
+        // [<Rn>, +/-<Rm>] //register
+        // [<Rn>, +/-<Rm>, <shift> #<shift_imm>] //scaled register
+        u8 rn = BITS(c, 16, 4);
+        if (BITS(c, 25, 1)) //(scaled) register
+        {
+            u8 rm = BITS(c, 0, 4);
+            u8 shift = BITS(c, 5, 2);
+            u16 shift_imm = BITS(c, 7, 5);
+            u8* sign = BITS(c, 23, 1) ? "" : "-";
+            u8 sstr[STRING_LENGTH] = "rrx"; //default, overwrite if incorrect
+            if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
+            if (!(shift == 3 && !shift_imm)) sprintf(sstr, "%s #%u", Shifters[shift], shift_imm); //intermediate sprintf
+            size = sprintf(str, "pld [r%u, %sr%u, %s]", rn, sign, rm, sstr);
+        }
+        else //immediate
+        {
+            u8* sign = BITS(c, 23, 1) ? "+" : "-";
+            size = sprintf(str, "pld [r%u, #%s0x%X]", rn, sign, BITS(c, 0, 12));
+        }
+    }
+
+    if (!str[0]) //in case nothing was written to it
+    {
+        debug_na_count++;
+        sprintf(str, "n/a"); //don't need to get size, no special register formatting
+    }
+    else
+    {
+        CheckSpecialRegister(str, size); //formatting of SP, LR, PC
+    }
+}
+
+DTHUMB_SPECIALIZE_VOID(Disassemble_arm, u8*)
+
+#undef sprintf
+#ifdef DTHUMB_INSTRUMENT
+#undef CheckSpecialRegister
+#endif
+
+/* STRUCTURED DECODING */
+
+static void SetInstruction(DINST* di, u32 mnemonic, u32 form) {
+    /* Fill in the mnemonic and everything that follows from it */
+    di->mnemonic = mnemonic;
+    di->iclass = MnemonicClasses[mnemonic];
+    di->form = form;
+}
+
+static void SetMemoryOffset(DINST* di, u32 c, u32 form_offset, u32 form_pre, u32 form_post) {
+    /* ARM addressing modes 2 and 3: pick the form from the P and W bits, and the sign from the U bit */
+    if (!BITS(c, 23, 1))
+    {
+        di->flags |= DF_SUBTRACT;
+        di->imm = -di->imm;
+    }
+    if (!BITS(c, 24, 1)) di->form = form_post; //post-indexed, always written back
+    else if (BITS(c, 21, 1)) di->form = form_pre;
+    else di->form = form_offset;
+    if (di->form != form_offset) di->flags |= DF_WRITEBACK;
+}
+
+static u32 CountRegisters(u16 reglist) {
+    /* Number of registers in a register list */
+    return CountBits(reglist & 0xff) + CountBits(reglist >> 8);
+}
+
+static DTHUMB_INLINE u32 Decode_thumb_generic(u32 code, DINST* di, ARMARCH tv) {
+    /* Same as Disassemble_thumb without any text, return size of the processed code (SIZE_16 or SIZE_32) */
+    /* di->mnemonic is MN_NA where Disassemble_thumb prints "n/a" */
+
+    THUMBSIZE thumb_size = SIZE_16; //return value
+    u16 c = code & 0xffff; //low 16 bits
+    memset(di, 0, sizeof(DINST));
+    di->rd = di->rn = di->rm = di->rs = REG_NONE;
+    di->cond = AL;
+    di->flags = DF_THUMB;
+
+    switch (c >> 13)
+    {
+    case 0: //0x0000 //LSL, LSR, ASR, ADD, SUB
+    {
+        di->rd = BITS(c, 0, 3);
+        di->flags |= DF_S;
+        u8 index = BITS(c, 11, 2);
+        if (index == 3) //ADD, SUB, MOV
+        {
+            if (BITS(c, 6, 5) == 16) //MOV (2)
+            {
+                SetInstruction(di, MN_MOV, FORM_REG);
+                di->rm = BITS(c, 3, 3);
+            }
+            else
+            {
+                di->rn = BITS(c, 3, 3);
+                SetInstruction(di, BITS(c, 9, 1) ? MN_SUB : MN_ADD, FORM_REG);
+                if (BITS(c, 10, 1)) //ADD (1), SUB (1) -immediate
+                {
+                    di->form = FORM_IMM;
+                    di->imm = BITS(c, 6, 3);
+                }
+                else //ADD (3), SUB (3) -register
+                {
+                    di->rm = BITS(c, 6, 3);
+                }
+            }
+        }
+        else //Shift by immediate: LSL (1), LSR (1), ASR (1)
+        {
+            SetInstruction(di, MN_LSL + index, FORM_REG_SHIFT_IMM);
+            di->rm = BITS(c, 3, 3);
+            di->imm = BITS(c, 6, 5);
+        }
+        break;
+    }
+
+    case 1: //0x2000 //MOV (1), CMP (1), ADD (2), SUB (2)
+    {
+        static const u16 mn[4] = { MN_MOV, MN_CMP, MN_ADD, MN_SUB };
+        u8 op = BITS(c, 11, 2);
+        SetInstruction(di, mn[op], FORM_IMM);
+        if (op != 1) di->rd = BITS(c, 8, 3);
+        if (op) di->rn = BITS(c, 8, 3);
+        di->imm = BITS(c, 0, 8);
+        di->flags |= DF_S;
+        break;
+    }
+
+    case 2: //0x4000 //lots...
+    {
+        switch (BITS(c, 10, 3))
+        {
+        case 0: //Data-processing registers
+        {
+            u8 rd = BITS(c, 0, 3);
+            u8 rm = BITS(c, 3, 3);
+            u16 mn = DataProcessingMnemonics_thumb[BITS(c, 6, 4)];
+            SetInstruction(di, mn, FORM_REG);
+            di->flags |= DF_S;
+            switch (mn)
+            {
+            case MN_LSL:
+            case MN_LSR:
+            case MN_ASR:
+            case MN_ROR:
+            {
+                di->form = FORM_REG_SHIFT_REG;
+                di->rd = di->rm = rd;
+                di->rs = rm;
+                break;
+            }
+            case MN_TST:
+            case MN_CMP:
+            case MN_CMN:
+            {
+                di->rn = rd;
+                di->rm = rm;
+                break;
+            }
+            case MN_NEG:
+            case MN_MVN:
+            {
+                di->rd = rd;
+                di->rm = rm;
+                break;
+            }
+            case MN_MUL:
+            {
+                di->rd = di->rs = rd;
+                di->rm = rm;
+                break;
+            }
+            default:
+            {
+                di->rd = di->rn = rd;
+                di->rm = rm;
+            }
+            }
+            break;
+        }
+        case 1: //Special data processing
+        {
+            u8 rd = (BITS(c, 7, 1) << 3) | (BITS(c, 0, 3));
+            u8 rm = BITS(c, 3, 4);
+            u8 op = BITS(c, 8, 2);
+            if (op == 3) //Branch/exchange instruction set
+            {
+                if (BITS(c, 0, 3)) break; //Should-Be-Zero
+                if (BITS(c, 7, 1)) //BLX (2)
+                {
+                    if (tv < ARMv5TE) break; //UNPREDICTABLE prior to ARM version 5
+                    SetInstruction(di, MN_BLX, FORM_BRANCH_REG);
+                    di->flags |= DF_LINK;
+                }
+                else //BX
+                {
+                    SetInstruction(di, MN_BX, FORM_BRANCH_REG);
+                }
+                di->rm = rm;
+            }
+            else //ADD (4), CMP (3), MOV (3)
+            {
+                if (!BITS(c, 6, 2)) break; //UNPREDICTABLE
+                static const u16 mn[3] = { MN_ADD, MN_CMP, MN_MOV };
+                SetInstruction(di, mn[op], FORM_REG);
+                if (op != 1) di->rd = rd;
+                if (op != 2) di->rn = rd;
+                if (op == 1) di->flags |= DF_S;
+                di->rm = rm;
+            }
+            break;
+        }
+        default: //Load from literal pool, Load/Store register offset
+        {
+            if (BITS(c, 12, 1)) //Load/store register offset
+            {
+                u8 op = BITS(c, 9, 3);
+                SetInstruction(di, LoadStoreRegisterMnemonics[op], FORM_MEM_REG);
+                di->flags |= (op == 0 || op == 1 || op == 2) ? DF_STORE : DF_LOAD;
+                di->rd = BITS(c, 0, 3);
+                di->rn = BITS(c, 3, 3);
+                di->rm = BITS(c, 6, 3);
+            }
+            else //LDR (3)
+            {
+                if (!BITS(c, 11, 1)) break; //Should-Be-One
+                SetInstruction(di, MN_LDR, FORM_MEM_IMM);
+                di->flags |= DF_LOAD;
+                di->rd = BITS(c, 8, 3);
+                di->rn = 15;
+                di->imm = 4 * BITS(c, 0, 8);
+            }
+        }
+        }
+        break;
+    }
+
+    case 3: //0x6000 //STR, LDR, STRB, LDRB
+    {
+        static const u16 mn[4] = { MN_STR, MN_LDR, MN_STRB, MN_LDRB };
+        u8 op = BITS(c, 11, 2);
+        SetInstruction(di, mn[op], FORM_MEM_IMM);
+        di->flags |= (op & 1) ? DF_LOAD : DF_STORE;
+        di->rd = BITS(c, 0, 3);
+        di->rn = BITS(c, 3, 3);
+        di->imm = (op < 2) ? 4 * BITS(c, 6, 5) : BITS(c, 6, 5);
+        break;
+    }
+
+    case 4: //0x8000 //STR, LDR, STRH, LDRH
+    {
+        u8 l = BITS(c, 11, 1);
+        di->flags |= l ? DF_LOAD : DF_STORE;
+        if (BITS(c, 12, 1)) //LDR (4), STR (3)
+        {
+            SetInstruction(di, l ? MN_LDR : MN_STR, FORM_MEM_IMM);
+            di->rd = BITS(c, 8, 3);
+            di->rn = 13;
+            di->imm = 4 * BITS(c, 0, 8);
+        }
+        else //LDRH (1), STRH (1)
+        {
+            SetInstruction(di, l ? MN_LDRH : MN_STRH, FORM_MEM_IMM);
+            di->rd = BITS(c, 0, 3);
+            di->rn = BITS(c, 3, 3);
+            di->imm = 2 * BITS(c, 6, 5);
+        }
+        break;
+    }
+
+    case 5: //0xA000 //Misc and ADD to sp or pc
+    {
+        if (BITS(c, 12, 1)) //Misc, fig 6-2
+        {
+            switch (BITS(c, 8, 4))
+            {
+            case 0: //ADD (4), SUB (7) to/from SP
+            {
+                SetInstruction(di, BITS(c, 7, 1) ? MN_SUB : MN_ADD, FORM_IMM);
+                di->rd = di->rn = 13;
+                di->imm = 4 * BITS(c, 0, 7);
+                break;
+            }
+            //PUSH/POP
+            case 4:
+            case 5:
+            case 12:
+            case 13:
+            {
+                u16 registers = BITS(c, 0, 8);
+                if (!registers && !BITS(c, 8, 1)) break; //if BitCount(registers) < 1 then UNPREDICTABLE
+                di->rn = 13;
+                di->flags |= DF_WRITEBACK;
+                if (BITS(c, 11, 1)) //POP
+                {
+                    SetInstruction(di, MN_POP, FORM_LIST_IA);
+                    di->reglist = registers | (BITS(c, 8, 1) << 15);
+                    di->flags |= DF_LOAD;
+                }
+                else //PUSH
+                {
+                    SetInstruction(di, MN_PUSH, FORM_LIST_DB);
+                    di->reglist = registers | (BITS(c, 8, 1) << 14);
+                    di->flags |= DF_STORE;
+                }
+                break;
+            }
+            case 14: //BKPT
+            {
+                if (tv >= ARMv5TE) //undefined prior to ARM version 5
+                {
+                    SetInstruction(di, MN_BKPT, FORM_IMM);
+                    di->imm = BITS(c, 0, 8);
+                }
+                break;
+            }
+            }
+        }
+        else //ADD (5), ADD (6) to SP or PC
+        {
+            SetInstruction(di, MN_ADD, FORM_IMM);
+            di->rd = BITS(c, 8, 3);
+            di->rn = BITS(c, 11, 1) ? 13 : 15;
+            di->imm = 4 * BITS(c, 0, 8);
+        }
+        break;
+    }
+
+    case 6: //0xC000 //B, SWI, LDMIA, STMIA
+    {
+        if (BITS(c, 12, 1)) //Conditional branch, Undefined, System call
+        {
+            switch (BITS(c, 8, 4))
+            {
+            case 14: break; //UDF, UNDEFINED
+            case 15: //SWI
+            {
+                SetInstruction(di, MN_SWI, FORM_IMM);
+                di->imm = BITS(c, 0, 8);
+                break;
+            }
+            default: //B (1) conditional
+            {
+                SetInstruction(di, MN_B, FORM_BRANCH_IMM);
+                di->cond = BITS(c, 8, 4);
+                di->imm = 4 + 2 * SIGNEX32_BITS(c, 0, 8);
+            }
+            }
+        }
+        else //LDMIA/STMIA
+        {
+            di->reglist = BITS(c, 0, 8);
+            if (!di->reglist) break;
+            u8 l = BITS(c, 11, 1);
+            SetInstruction(di, l ? MN_LDM : MN_STM, FORM_LIST_IA);
+            di->flags |= DF_WRITEBACK | (l ? DF_LOAD : DF_STORE);
+            di->rn = BITS(c, 8, 3);
+        }
+        break;
+    }
+
+    case 7: //0xE000 //B, then 32-bit instructions
+    {
+        switch (BITS(c, 11, 2))
+        {
+        case 0:
+        {
+            SetInstruction(di, MN_B, FORM_BRANCH_IMM);
+            di->imm = 4 + 2 * SIGNEX32_BITS(c, 0, 11); //11 bits to signed 32 bits
+            break;
+        }
+        case 2: //BL/BLX prefix
+        {
+            c = code >> 16; //get high 16 bits
+            if (c >> 13 != 7) break;
+            int ofs = (BITS((code & 0xffff), 0, 11)) << 12;
+            ofs = SIGNEX32_VAL(ofs, 23);
+            ofs += 4;
+            ofs += 2 * BITS(c, 0, 11);
+            switch (BITS(c, 11, 2))
+            {
+            case 1: //BLX (1)
+            {
+                if (tv < ARMv5TE) break;
+                if (BITS(c, 0, 1)) break;
+                thumb_size = SIZE_32;
+                SetInstruction(di, MN_BLX, FORM_BRANCH_IMM);
+                di->flags |= DF_LINK;
+                di->imm = ofs;
+                break;
+            }
+            case 3: //BL
+            {
+                thumb_size = SIZE_32;
+                SetInstruction(di, MN_BL, FORM_BRANCH_IMM);
+                di->flags |= DF_LINK;
+                di->imm = ofs;
+                break;
+            }
+            }
+            break;
+        }
+        }
+        break;
+    }
+    }
+    di->size = (thumb_size == SIZE_32) ? 4 : 2;
+    return thumb_size;
+}
+
+DTHUMB_SPECIALIZE(u32, Decode_thumb, DINST*)
+
+static DTHUMB_INLINE void Decode_arm_generic(u32 code, DINST* di, ARMARCH av) {
+    /* Same as Disassemble_arm without any text */
+    /* di->mnemonic is MN_NA where Disassemble_arm prints "n/a" */
+
+    u32 c = code; //alias
+    u8 cond = BITS(c, 28, 4); //condition bits
+    memset(di, 0, sizeof(DINST));
+    di->rd = di->rn = di->rm = di->rs = REG_NONE;
+    di->cond = cond;
+    di->size = 4;
+
+    switch (BITS(c, 25, 3))
+    {
+    case 0: //Data processing, DSP instructions, ...
+    {
+        if (cond == NV) break; //undefined
+        if (BITS(c, 4, 1))
+        {
+            if (BITS(c, 7, 1)) //Multiplies, extra load/stores: see fig 3-2
+            {
+                u8 oplo = BITS(c, 5, 2);
+                if (!oplo)
+                {
+                    if (!BITS(c, 22, 3)) //Multiply (accumulate)
+                    {
+                        di->rm = BITS(c, 0, 4);
+                        di->rs = BITS(c, 8, 4);
+                        di->rd = BITS(c, 16, 4);
+                        if (BITS(c, 20, 1)) di->flags |= DF_S;
+                        if (BITS(c, 21, 1)) //MLA
+                        {
+                            SetInstruction(di, MN_MLA, FORM_REG);
+                            di->rn = BITS(c, 12, 4);
+                        }
+                        else //MUL
+                        {
+                            if (BITS(c, 12, 4)) break; //Should-Be-Zero
+                            SetInstruction(di, MN_MUL, FORM_REG);
+                        }
+                    }
+                    else if (BITS(c, 23, 1)) //Multiply (accumulate) long
+                    {
+                        SetInstruction(di, MultiplyLongMnemonics[BITS(c, 21, 2)], FORM_REG);
+                        if (BITS(c, 20, 1)) di->flags |= DF_S;
+                        di->rd = BITS(c, 12, 4);
+                        di->rn = BITS(c, 16, 4);
+                        di->rm = BITS(c, 0, 4);
+                        di->rs = BITS(c, 8, 4);
+                    }
+                    else //Swap/swap byte (SWP, SWPB)
+                    {
+                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
+                        SetInstruction(di, BITS(c, 22, 1) ? MN_SWPB : MN_SWP, FORM_MEM_IMM);
+                        di->flags |= DF_LOAD | DF_STORE;
+                        di->rd = BITS(c, 12, 4);
+                        di->rm = BITS(c, 0, 4);
+                        di->rn = BITS(c, 16, 4);
+                    }
+                }
+                else
+                {
+                    if (!BITS(c, 22, 1) && BITS(c, 8, 4)) break; //Should-Be-Zero if register offset
+                    u32 mn = MN_NA;
+                    if (oplo == 1) //Load/store halfword
+                    {
+                        mn = BITS(c, 20, 1) ? MN_LDRH : MN_STRH;
+                    }
+                    else if (BITS(c, 20, 1)) //Load signed halfword/byte
+                    {
+                        mn = BITS(c, 5, 1) ? MN_LDRSH : MN_LDRSB;
+                    }
+                    else //Load/store two words
+                    {
+                        if (BITS(c, 12, 1)) break; //undefined if Rd is odd
+                        mn = BITS(c, 5, 1) ? MN_STRD : MN_LDRD;
+                    }
+                    if (!BITS(c, 24, 1) && BITS(c, 21, 1)) break; //post-indexed with W set, see FormatExtraLoadStore
+                    SetInstruction(di, mn, FORM_NONE);
+                    di->flags |= (mn == MN_STRH || mn == MN_STRD) ? DF_STORE : DF_LOAD;
+                    di->rd = BITS(c, 12, 4);
+                    di->rn = BITS(c, 16, 4);
+                    if (BITS(c, 22, 1)) //immediate
+                    {
+                        di->imm = (BITS(c, 8, 4) << 4) | BITS(c, 0, 4);
+                        SetMemoryOffset(di, c, FORM_MEM_IMM, FORM_MEM_PRE_IMM, FORM_MEM_POST_IMM);
+                    }
+                    else //register
+                    {
+                        di->rm = BITS(c, 0, 4);
+                        SetMemoryOffset(di, c, FORM_MEM_REG, FORM_MEM_PRE_REG, FORM_MEM_POST_REG);
+                    }
+                }
+            }
+            else
+            {
+                if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
+                {
+                    u8 oplo = BITS(c, 5, 2);
+                    u8 ophi = BITS(c, 21, 2);
+                    switch (oplo)
+                    {
+                    case 0:
+                    {
+                        if (ophi == 3) //CLZ
+                        {
+                            if (av < ARMv5TE) break;
+                            if (!BITS(c, 16, 4) || !BITS(c, 8, 4)) break; //Should-Be-One
+                            SetInstruction(di, MN_CLZ, FORM_REG);
+                            di->rd = BITS(c, 12, 4);
+                            di->rm = BITS(c, 0, 4);
+                        }
+                        else if (ophi == 1) //Branch/exchange instruction set (BX)
+                        {
+                            if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
+                            SetInstruction(di, MN_BX, FORM_BRANCH_REG);
+                            di->rm = BITS(c, 0, 4);
+                        }
+                        break;
+                    }
+                    case 1: //BLX (2)
+                    {
+                        if (av < ARMv5TE) break;
+                        if (ophi != 1) break;
+                        if (BITS(c, 8, 12) != 0xfff) break; //Should-Be-One
+                        SetInstruction(di, MN_BLX, FORM_BRANCH_REG);
+                        di->flags |= DF_LINK;
+                        di->rm = BITS(c, 0, 4);
+                        break;
+                    }
+                    case 2: //Enhanced DSP add/sub (QADD, QDADD, QSUB, QDSUB)
+                    {
+                        if (av < ARMv5TE) break;
+                        if (BITS(c, 8, 4)) break; //Should-Be-Zero
+                        SetInstruction(di, DSP_AddSubMnemonics[ophi], FORM_REG);
+                        di->rd = BITS(c, 12, 4);
+                        di->rm = BITS(c, 0, 4);
+                        di->rn = BITS(c, 16, 4);
+                        break;
+                    }
+                    case 3: //Software breakpoint (BKPT)
+                    {
+                        if (av < ARMv5TE) break;
+                        if (ophi != 1) break;
+                        SetInstruction(di, MN_BKPT, FORM_IMM);
+                        di->imm = (BITS(c, 8, 12) << 4) | BITS(c, 0, 4);
+                        break;
+                    }
+                    }
+                }
+                else //Data processing register shift
+                {
+                    u8 op = BITS(c, 21, 4);
+                    SetInstruction(di, MN_AND + op, FORM_REG_SHIFT_REG);
+                    di->rm = BITS(c, 0, 4);
+                    di->rs = BITS(c, 8, 4);
+                    if (op < 8 || op > 11) di->rd = BITS(c, 12, 4); //TST, TEQ, CMP, CMN have no destination
+                    if (op != 13 && op != 15) di->rn = BITS(c, 16, 4); //MOV, MVN have no first operand
+                    if (BITS(c, 20, 1)) di->flags |= DF_S;
+                }
+            }
+        }
+        else //bit 4 == 0
+        {
+            if (BITS(c, 23, 2) == 2 && !BITS(c, 20, 1)) //Miscellanous instructions, see fig 3-3
+            {
+                if (BITS(c, 7, 1)) //Enhanced DSP multiplies
+                {
+                    if (av < ARMv5TE) break;
+                    u8 rn_rdlo = BITS(c, 12, 4);
+                    u8 rd_rdhi = BITS(c, 16, 4);
+                    di->rm = BITS(c, 0, 4);
+                    di->rs = BITS(c, 8, 4);
+                    switch (BITS(c, 21, 2))
+                    {
+                    case 0: //SMLA
+                    {
+                        SetInstruction(di, MN_SMLAXY, FORM_REG);
+                        di->rd = rd_rdhi;
+                        di->rn = rn_rdlo;
+                        break;
+                    }
+                    case 1: //SMLAW, SMULW
+                    {
+                        if (BITS(c, 5, 1)) //SMULW
+                        {
+                            if (rn_rdlo) break; //Should-Be-Zero
+                            SetInstruction(di, MN_SMULWY, FORM_REG);
+                        }
+                        else //SMLAW
+                        {
+                            SetInstruction(di, MN_SMLAWY, FORM_REG);
+                            di->rn = rn_rdlo;
+                        }
+                        di->rd = rd_rdhi;
+                        break;
+                    }
+                    case 2: //SMLAL
+                    {
+                        SetInstruction(di, MN_SMLALXY, FORM_REG);
+                        di->rd = rn_rdlo;
+                        di->rn = rd_rdhi;
+                        break;
+                    }
+                    case 3: //SMUL
+                    {
+                        if (rn_rdlo) break; //Should-Be-Zero
+                        SetInstruction(di, MN_SMULXY, FORM_REG);
+                        di->rd = rd_rdhi;
+                        break;
+                    }
+                    }
+                }
+                else
+                {
+                    if (BITS(c, 22, 1)) di->flags |= DF_SPSR;
+                    if (!BITS(c, 0, 12) && BITS(c, 16, 4) == 15) //Move status reg to reg (MRS)
+                    {
+                        SetInstruction(di, MN_MRS, FORM_NONE);
+                        di->rd = BITS(c, 12, 4);
+                    }
+                    else if (BITS(c, 12, 4) == 15 && !BITS(c, 4, 8) && BITS(c, 21, 1)) //Move reg to status reg (MSR register)
+                    {
+                        SetInstruction(di, MN_MSR, FORM_REG);
+                        di->rm = BITS(c, 0, 4);
+                        di->reglist = BITS(c, 16, 4); //fields
+                    }
+                }
+            }
+            else //Data processing immediate shift
+            {
+                u8 op = BITS(c, 21, 4);
+                u8 shift = BITS(c, 5, 2);
+                u8 shift_imm = BITS(c, 7, 5);
+                if ((shift == 1 || shift == 2) && !shift_imm) shift_imm = 32; //0~31 for LSL, 1~32 for LSR, ASR and ROR, always 0 for RRX
+                SetInstruction(di, MN_AND + op, (shift || shift_imm) ? FORM_REG_SHIFT_IMM : FORM_REG);
+                di->rm = BITS(c, 0, 4);
+                di->imm = shift_imm;
+                if (op < 8 || op > 11) di->rd = BITS(c, 12, 4); //TST, TEQ, CMP, CMN have no destination
+                if (op != 13 && op != 15) di->rn = BITS(c, 16, 4); //MOV, MVN have no first operand
+                if (BITS(c, 20, 1)) di->flags |= DF_S;
+            }
+        }
+        break;
+    }
+    case 1: //Data processing and MSR immediate
+    {
+        if (cond == NV) break; //undefined
+        di->imm = ROR(BITS(c, 0, 8), 2 * BITS(c, 8, 4));
+        if (BITS(c, 12, 4) == 15 && !BITS(c, 20, 1)) //MSR immediate
+        {
+            SetInstruction(di, MN_MSR, FORM_IMM);
+            if (BITS(c, 22, 1)) di->flags |= DF_SPSR;
+            di->reglist = BITS(c, 16, 4); //fields
+        }
+        else //Data processing immediate
+        {
+            u8 op = BITS(c, 21, 4);
+            SetInstruction(di, MN_AND + op, FORM_IMM);
+            if (op < 8 || op > 11) di->rd = BITS(c, 12, 4); //TST, TEQ, CMP, CMN have no destination
+            if (op != 13 && op != 15) di->rn = BITS(c, 16, 4); //MOV, MVN have no first operand
+            if (BITS(c, 20, 1)) di->flags |= DF_S;
+        }
+        break;
+    }
+    case 2: //Load/store immediate offset
+    case 3: //Load/store register offset
+    {
+        if (cond == NV) break; //undefined
+        u8 reg = BITS(c, 25, 1);
+        if (reg && BITS(c, 4, 1)) break; //undefined
+        u8 l = BITS(c, 20, 1);
+        u8 b = BITS(c, 22, 1);
+        u8 t = !BITS(c, 24, 1) && BITS(c, 21, 1); //post-indexed with W set: user mode access
+        static const u16 mn[8] = { MN_STR, MN_LDR, MN_STRB, MN_LDRB, MN_STRT, MN_LDRT, MN_STRBT, MN_LDRBT };
+        SetInstruction(di, mn[(t << 2) | (b << 1) | l], FORM_NONE);
+        di->flags |= (l ? DF_LOAD : DF_STORE) | (t ? DF_USER : 0);
+        di->rd = BITS(c, 12, 4);
+        di->rn = BITS(c, 16, 4);
+        if (reg)
+        {
+            di->rm = BITS(c, 0, 4);
+            SetMemoryOffset(di, c, FORM_MEM_REG, FORM_MEM_PRE_REG, FORM_MEM_POST_REG);
+        }
+        else
+        {
+            di->imm = BITS(c, 0, 12);
+            SetMemoryOffset(di, c, FORM_MEM_IMM, FORM_MEM_PRE_IMM, FORM_MEM_POST_IMM);
+        }
+        break;
+    }
+    case 4: //Load/store multiple
+    {
+        if (cond == NV) break; //undefined
+        u8 l = BITS(c, 20, 1);
+        SetInstruction(di, l ? MN_LDM : MN_STM, FORM_LIST_DA + BITS(c, 23, 2));
+        di->flags |= (l ? DF_LOAD : DF_STORE) | (BITS(c, 21, 1) ? DF_WRITEBACK : 0) | (BITS(c, 22, 1) ? DF_USER : 0);
+        di->rn = BITS(c, 16, 4);
+        di->reglist = BITS(c, 0, 16);
+        break;
+    }
+    case 5: //Branch instructions
+    {
+        if (cond == NV && av >= ARMv5TE) //BLX (1)
+        {
+            SetInstruction(di, MN_BLX, FORM_BRANCH_IMM);
+            di->flags |= DF_LINK;
+            di->imm = 8 + 4 * SIGNEX32_BITS(c, 0, 24) + 2 * BITS(c, 24, 1);
+        }
+        else //B, BL
+        {
+            SetInstruction(di, BITS(c, 24, 1) ? MN_BL : MN_B, FORM_BRANCH_IMM);
+            if (BITS(c, 24, 1)) di->flags |= DF_LINK;
+            di->imm = 8 + 4 * SIGNEX32_BITS(c, 0, 24);
+        }
+        break;
+    }
+    case 6: //Coprocessor load/store, Double register transfers
+    {
+        if (av < ARMv5TE) break;
+        if (BITS(c, 21, 4) == 2) //MCRR, MRRC
+        {
+            SetInstruction(di, BITS(c, 20, 1) ? MN_MRRC : MN_MCRR, FORM_NONE);
+            di->rd = BITS(c, 12, 4);
+            di->rn = BITS(c, 16, 4);
+        }
+        else //LDC, STC
+        {
+            u8 l = BITS(c, 20, 1);
+            SetInstruction(di, l ? MN_LDC : MN_STC, FORM_NONE);
+            di->flags |= l ? DF_LOAD : DF_STORE;
+            di->rn = BITS(c, 16, 4);
+            di->imm = 4 * BITS(c, 0, 8);
+            if (!BITS(c, 24, 1) && !BITS(c, 21, 1)) //unindexed, imm is an option for the coprocessor
+            {
+                di->form = FORM_MEM_IMM;
+                di->imm = 0;
+            }
+            else
+            {
+                SetMemoryOffset(di, c, FORM_MEM_IMM, FORM_MEM_PRE_IMM, FORM_MEM_POST_IMM);
+            }
+        }
+        break;
+    }
+    case 7: //Software Interrupt, Coprocessor register transfer, Coprocessor data processing
+    {
+        if (BITS(c, 24, 1)) //SWI
+        {
+            if (cond == NV) break;
+            SetInstruction(di, MN_SWI, FORM_IMM);
+            di->imm = BITS(c, 0, 24);
+        }
+        else
+        {
+            if (cond == NV && av < ARMv5TE) break;
+            if (BITS(c, 4, 1)) //MCR, MRC
+            {
+                SetInstruction(di, BITS(c, 20, 1) ? MN_MRC : MN_MCR, FORM_NONE);
+                di->rd = BITS(c, 12, 4);
+            }
+            else //CDP
+            {
+                SetInstruction(di, MN_CDP, FORM_NONE);
+            }
+        }
+        break;
+    }
+    }
+
+    if (di->mnemonic == MN_NA && (c & 0xFD70F000) == 0xF550F000) //Cache preload (PLD), see Disassemble_arm
+    {
+        SetInstruction(di, MN_PLD, FORM_NONE);
+        di->rn = BITS(c, 16, 4);
+        if (BITS(c, 25, 1)) //(scaled) register
+        {
+            di->rm = BITS(c, 0, 4);
+            SetMemoryOffset(di, c, FORM_MEM_REG, FORM_MEM_REG, FORM_MEM_REG);
+        }
+        else //immediate
+        {
+            di->imm = BITS(c, 0, 12);
+            SetMemoryOffset(di, c, FORM_MEM_IMM, FORM_MEM_IMM, FORM_MEM_IMM);
+        }
+    }
+
+    if (di->mnemonic == MN_NA) //clear partially decoded fields
+    {
+        memset(di, 0, sizeof(DINST));
+        di->rd = di->rn = di->rm = di->rs = REG_NONE;
+        di->cond = cond;
+        di->size = 4;
+    }
+}
+
+DTHUMB_SPECIALIZE_VOID(Decode_arm, DINST*)
+
+static u64 DecodeTablesHash(u64 h, const u8* data, u64 size) {
+    /* FNV-1a over 8-byte words then the tail bytes, with a fold so high bits reach the low ones */
+    u64 i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        u64 w;
+        memcpy(&w, &data[i], 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++) h = (h ^ data[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+static u64 DecodeTablesSize(u32 text_size) {
+    /* Header, THUMB DINSTs and text offsets for both arches, ARM class tables, then the text */
+    return sizeof(DECODETABLESHEADER) + 2 * 0x10000 * (u64)(sizeof(DINST) + sizeof(u32)) + 2 * 0x1000 + text_size;
+}
+
+static void LocateDecodeTables(DECODETABLES* t, const u8* data) {
+    /* Point t into a block laid out like DecodeTablesSize */
+    const u8* p = data + sizeof(DECODETABLESHEADER);
+    for (u32 a = 0; a < 2; a++, p += 0x10000 * sizeof(DINST)) t->thumb[a] = (const DINST*)p;
+    for (u32 a = 0; a < 2; a++, p += 0x10000 * sizeof(u32)) t->thumb_text[a] = (const u32*)p;
+    for (u32 a = 0; a < 2; a++, p += 0x1000) t->arm_class[a] = p;
+    t->text = p;
+}
+
+static u64 DecodeTablesFingerprint(void) {
+    /* Hash of what the live decoders make of a spread of codes, tables built by other decoders don't match it */
+    u32 na_count = debug_na_count; //not a real n/a
+    u64 h = 0xcbf29ce484222325ULL;
+    for (u32 a = 0; a < 2; a++)
+    {
+        ARMARCH arch = a ? ARMv5TE : ARMv4T;
+        DINST di;
+        for (u32 code = 0; code < 0x10000; code += 61) //prime step, every format gets hit
+        {
+            u8 str[STRING_LENGTH] = { 0 };
+            Disassemble_thumb(code, str, arch);
+            Decode_thumb(code, &di, arch);
+            h = DecodeTablesHash(h, str, strlen(str));
+            h = DecodeTablesHash(h, (const u8*)&di, sizeof(DINST));
+        }
+        for (u32 key = 0; key < 0x1000; key++)
+        {
+            u32 code = 0xe0000000 | (key >> 4) << 20 | (key & 15) << 4 | ((key * 0x9e3779b1) & 0x000fff0f);
+            Decode_arm(code, &di, arch);
+            h = DecodeTablesHash(h, (const u8*)&di, sizeof(DINST));
+        }
+    }
+    debug_na_count = na_count;
+    return h;
+}
+
+static u8 ClassifyArmKey(u32 key, ARMARCH arch) {
+    /* ICLASS shared by the codes with bits 27-20 and 7-4 from key, but not the NV condition, IC_MAX if the other bits change it */
+    /* Each free nibble is tried at 0, 1, 14, 15 and a varying value, which covers the zero, one and pc checks of the decoder */
+    const u8 values[4] = { 0, 1, 14, 15 };
+    const u8 conditions[3] = { AL, EQ, LE };
+    u32 seed = key * 0x9e3779b1;
+    u8 iclass = IC_MAX;
+    for (u32 k = 0; k < 3 * 5 * 5 * 5 * 5; k++)
+    {
+        u32 code = (u32)conditions[k % 3] << 28 | (key >> 4) << 20 | (key & 15) << 4;
+        u32 digits = k / 3;
+        for (u32 n = 0; n < 4; n++, digits /= 5) //nibbles at bits 0, 8, 12 and 16
+        {
+            seed = seed * 1103515245 + 12345;
+            u32 v = (digits % 5 < 4) ? values[digits % 5] : (seed >> 16) & 15;
+            code |= v << (n ? 4 + 4 * n : 0);
+        }
+        DINST di;
+        Decode_arm(code, &di, arch);
+        if (k == 0) iclass = di.iclass;
+        else if (di.iclass != iclass) return IC_MAX;
+    }
+    return iclass;
+}
+
+static u8* BuildDecodeTables(u64* size) {
+    /* Decode every THUMB halfword and classify every ARM key for both arches, into a block for AttachDecodeTables */
+    /* Return NULL on failure, or the block to free */
+    u32 na_count = debug_na_count;
+    u32 pool_size = 2 * 0x10000 * STRING_LENGTH;
+    u8* pool = malloc(pool_size);
+    u32* offsets = malloc(2 * 0x10000 * sizeof(u32));
+    DINST* insts = malloc(2 * 0x10000 * sizeof(DINST));
+    if (!pool || !offsets || !insts)
+    {
+        free(pool);
+        free(offsets);
+        free(insts);
+        return NULL;
+    }
+    u32 text_size = 0;
+    for (u32 a = 0; a < 2; a++)
+    {
+        ARMARCH arch = a ? ARMv5TE : ARMv4T;
+        for (u32 h = 0; h < 0x10000; h++)
+        {
+            u8 str[STRING_LENGTH] = { 0 };
+            DINST* di = &insts[a * 0x10000 + h];
+            Disassemble_thumb(h, str, arch);
+            Decode_thumb(h, di, arch);
+            offsets[a * 0x10000 + h] = text_size;
+            u32 len = (u32)strlen(str);
+            memcpy(&pool[text_size], str, len + 1);
+            text_size += len + 1;
+            const u32 next[3] = { 0xe800, 0xf800, 0xffff }; //a halfword whose decoding depends on the next one is left to the live decoders
+            for (u32 n = 0; n < 3; n++)
+            {
+                u8 other[STRING_LENGTH] = { 0 };
+                DINST odi;
+                Disassemble_thumb(next[n] << 16 | h, other, arch);
+                Decode_thumb(next[n] << 16 | h, &odi, arch);
+                if (strcmp(str, other) || memcmp(di, &odi, sizeof(DINST))) offsets[a * 0x10000 + h] = DECODETABLES_LIVE;
+            }
+        }
+    }
+
+    *size = DecodeTablesSize(text_size);
+    u8* data = calloc(1, *size);
+    if (data)
+    {
+        DECODETABLESHEADER hd;
+        memset(&hd, 0, sizeof(hd));
+        memcpy(hd.magic, DECODETABLES_MAGIC, 4);
+        hd.version = DECODETABLES_VERSION;
+        hd.dinst_size = sizeof(DINST);
+        hd.text_size = text_size;
+        hd.fingerprint = DecodeTablesFingerprint();
+        u8* p = data + sizeof(DECODETABLESHEADER);
+        memcpy(p, insts, 2 * 0x10000 * sizeof(DINST));
+        p += 2 * 0x10000 * sizeof(DINST);
+        memcpy(p, offsets, 2 * 0x10000 * sizeof(u32));
+        p += 2 * 0x10000 * sizeof(u32);
+        for (u32 a = 0; a < 2; a++)
+        {
+            for (u32 key = 0; key < 0x1000; key++) *p++ = ClassifyArmKey(key, a ? ARMv5TE : ARMv4T);
+        }
+        memcpy(p, pool, text_size);
+        hd.checksum = DecodeTablesHash(0xcbf29ce484222325ULL, data + sizeof(DECODETABLESHEADER), *size - sizeof(DECODETABLESHEADER));
+        memcpy(data, &hd, sizeof(hd));
+    }
+    free(pool);
+    free(offsets);
+    free(insts);
+    debug_na_count = na_count;
+    return data;
+}
+
+static int AttachDecodeTables(const u8* data, u64 size) {
+    /* Decode THUMB through tables built by BuildDecodeTables, return 0 and keep decoding live if they are damaged or stale */
+    /* data has to stay mapped while they are attached, the decoders picked by SelectDecoders after this read it directly */
+    DECODETABLESHEADER hd;
+    DECODETABLES t;
+    memset(&decode_tables, 0, sizeof(DECODETABLES));
+    if (size < sizeof(hd)) return 0;
+    memcpy(&hd, data, sizeof(hd));
+    if (memcmp(hd.magic, DECODETABLES_MAGIC, 4) || hd.version != DECODETABLES_VERSION || hd.dinst_size != sizeof(DINST)) return 0;
+    if (!hd.text_size || DecodeTablesSize(hd.text_size) != size) return 0;
+    if (hd.checksum != DecodeTablesHash(0xcbf29ce484222325ULL, data + sizeof(hd), size - sizeof(hd))) return 0;
+    if (hd.fingerprint != DecodeTablesFingerprint()) return 0;
+    LocateDecodeTables(&t, data);
+    if (t.text[hd.text_size - 1]) return 0;
+    for (u32 i = 0; i < 2 * 0x10000; i++)
+    {
+        u32 offset = t.thumb_text[0][i]; //both arches follow each other
+        if (offset != DECODETABLES_LIVE && offset >= hd.text_size) return 0;
+    }
+    decode_tables = t;
+    return 1;
+}
+
+static void DetachDecodeTables(void) {
+    /* Back to live decoding, for the decoders selected after this */
+    memset(&decode_tables, 0, sizeof(DECODETABLES));
+}
+
+#ifndef DTHUMB_INSTRUMENT //only picked by SelectDecoders without it
+static DTHUMB_INLINE u32 DisassembleTable_thumb_generic(u32 code, u8 str[STRING_LENGTH], ARMARCH tv) {
+    /* Disassemble_thumb from the attached tables */
+    u32 a = tv >= ARMv5TE;
+    u16 h = code & 0xffff;
+    u32 offset = decode_tables.thumb_text[a][h];
+    if (offset == DECODETABLES_LIVE) return Disassemble_thumb_generic(code, str, tv);
+    if (decode_tables.thumb[a][h].mnemonic == MN_NA) debug_na_count++;
+    const u8* s = &decode_tables.text[offset];
+    u32 n = 0;
+    for (; s[n] && n < STRING_LENGTH - 1; n++) str[n] = s[n];
+    str[n] = 0;
+    return SIZE_16;
+}
+
+static u32 DisassembleTable_thumb_v4t(u32 code, u8* str) { return DisassembleTable_thumb_generic(code, str, ARMv4T); }
+static u32 DisassembleTable_thumb_v5te(u32 code, u8* str) { return DisassembleTable_thumb_generic(code, str, ARMv5TE); }
+
+static DTHUMB_INLINE u32 DecodeTable_thumb_generic(u32 code, DINST* di, ARMARCH tv) {
+    /* Decode_thumb from the attached tables */
+    u32 a = tv >= ARMv5TE;
+    u16 h = code & 0xffff;
+    if (decode_tables.thumb_text[a][h] == DECODETABLES_LIVE) return Decode_thumb_generic(code, di, tv);
+    *di = decode_tables.thumb[a][h];
+    return SIZE_16;
+}
+
+static u32 DecodeTable_thumb_v4t(u32 code, DINST* di) { return DecodeTable_thumb_generic(code, di, ARMv4T); }
+static u32 DecodeTable_thumb_v5te(u32 code, DINST* di) { return DecodeTable_thumb_generic(code, di, ARMv5TE); }
+#endif
+
+static inline u32 Classify_arm(u32 code, ARMARCH arch) {
+    /* ICLASS of an ARM code, from the attached class table when its key settles it */
+    u32 a = arch >= ARMv5TE;
+    if (decode_tables.arm_class[a] && (code >> 28) != NV)
+    {
+        u8 iclass = decode_tables.arm_class[a][BITS(code, 20, 8) << 4 | BITS(code, 4, 4)];
+        if (iclass != IC_MAX) return iclass;
+    }
+    DINST di;
+    Decode_arm(code, &di, arch);
+    return di.iclass;
+}
+
+static void SelectDecoders(DECODERS* d, ARMARCH arch) {
+    /* Pick the specialized copies once, instead of checking arch on every call */
+    int v5 = arch >= ARMv5TE;
+    d->disassemble_thumb = v5 ? Disassemble_thumb_v5te : Disassemble_thumb_v4t;
+    d->disassemble_arm = v5 ? Disassemble_arm_v5te : Disassemble_arm_v4t;
+    d->decode_thumb = v5 ? Decode_thumb_v5te : Decode_thumb_v4t;
+    d->decode_arm = v5 ? Decode_arm_v5te : Decode_arm_v4t;
+#ifndef DTHUMB_INSTRUMENT //the counters are for the decoders themselves
+    if (decode_tables.thumb[0]) //see AttachDecodeTables
+    {
+        d->disassemble_thumb = v5 ? DisassembleTable_thumb_v5te : DisassembleTable_thumb_v4t;
+        d->decode_thumb = v5 ? DecodeTable_thumb_v5te : DecodeTable_thumb_v4t;
+    }
+#endif
+}
+
+static void GetEffects(const DINST* di, ARMARCH arch, EFFECTS* e) {
+    /* Registers, flags and memory used by a decoded instruction, without going through its text */
+    static const u8 ConditionFlags[CONDITIONS_MAX] = {
+        EF_Z, EF_Z, EF_C, EF_C, EF_N, EF_N, EF_V, EF_V,
+        EF_C | EF_Z, EF_C | EF_Z, EF_N | EF_V, EF_N | EF_V, EF_N | EF_Z | EF_V, EF_N | EF_Z | EF_V, 0, 0
+    };
+    u32 mn = di->mnemonic;
+    u16 rd = (di->rd != REG_NONE) ? 1 << di->rd : 0;
+    u16 rn = (di->rn != REG_NONE) ? 1 << di->rn : 0;
+    u16 operands = rn | ((di->rm != REG_NONE) ? 1 << di->rm : 0) | ((di->rs != REG_NONE) ? 1 << di->rs : 0);
+    memset(e, 0, sizeof(EFFECTS));
+    e->flags_read = ConditionFlags[di->cond];
+    if (di->cond != AL && di->cond != NV) e->bits |= EB_CONDITIONAL;
+    if (di->flags & DF_WRITEBACK) e->writes |= rn;
+    switch (di->iclass)
+    {
+    case IC_DATA:
+    {
+        e->reads |= operands;
+        e->writes |= rd;
+        if (mn == MN_ADC || mn == MN_SBC || mn == MN_RSC) e->flags_read |= EF_C;
+        if (di->form == FORM_REG_SHIFT_IMM && di->imm == 0 && !(di->flags & DF_THUMB)) e->flags_read |= EF_C; //RRX
+        if (rd & 0x8000)
+        {
+            e->bits |= EB_WRITES_PC;
+            if (di->flags & DF_S) //CPSR from the SPSR
+            {
+                e->bits |= EB_MODE | EB_EXCHANGE;
+                e->flags_written = EF_NZCV | EF_Q;
+                break;
+            }
+        }
+        if (!(di->flags & DF_S)) break;
+        if ((mn >= MN_SUB && mn <= MN_RSC) || mn == MN_CMP || mn == MN_CMN || mn == MN_NEG) e->flags_written = EF_NZCV;
+        else if ((di->flags & DF_THUMB) && mn == MN_MOV && di->form == FORM_REG) e->flags_written = EF_NZCV; //MOV (2) is ADD #0, clears C and V
+        else //logical, C from the shifter
+        {
+            e->flags_written = EF_N | EF_Z;
+            if (di->form == FORM_REG_SHIFT_IMM && !(mn == MN_LSL && di->imm == 0)) e->flags_written |= EF_C; //THUMB LSL #0 keeps it, RRX doesn't
+            else if (di->form == FORM_REG_SHIFT_REG || (di->form == FORM_IMM && !(di->flags & DF_THUMB))) //a shift by 0 or an immediate without rotation keeps it
+            {
+                e->flags_written |= EF_C;
+                e->flags_maybe |= EF_C;
+            }
+        }
+        break;
+    }
+    case IC_MULTIPLY:
+    {
+        e->reads |= operands;
+        e->writes |= rd;
+        if (mn >= MN_UMULL && mn <= MN_SMLAL) //RdLo in rd, RdHi in rn
+        {
+            e->writes |= rn;
+            if (mn == MN_UMULL || mn == MN_SMULL) e->reads &= ~rn;
+            else e->reads |= rd;
+        }
+        else if (mn == MN_SMLALXY)
+        {
+            e->reads |= rd;
+            e->writes |= rn;
+        }
+        if (mn == MN_SMLAXY || mn == MN_SMLAWY || (mn >= MN_QADD && mn <= MN_QDSUB)) //saturation or overflow sets Q, never clears it
+        {
+            e->flags_written = e->flags_maybe = EF_Q;
+        }
+        else if (di->flags & DF_S)
+        {
+            e->flags_written = EF_N | EF_Z;
+            if (arch < ARMv5TE) //C unpredictable, V too for the long multiplies
+            {
+                e->flags_maybe = (mn >= MN_UMULL) ? EF_C | EF_V : EF_C;
+                e->flags_written |= e->flags_maybe;
+            }
+        }
+        break;
+    }
+    case IC_LOADSTORE:
+    {
+        static const u8 Widths[MN_PLD - MN_LDR + 1] = { 4, 4, 1, 1, 4, 4, 1, 1, 2, 2, 1, 2, 8, 8, 4, 1, 0 };
+        u16 pair = (mn == MN_LDRD || mn == MN_STRD) ? rd << 1 : 0;
+        e->reads |= operands;
+        e->width = Widths[mn - MN_LDR];
+        if (mn == MN_PLD) break; //a hint, no access
+        if (di->flags & DF_LOAD) e->bits |= EB_LOAD;
+        if (di->flags & DF_STORE) e->bits |= EB_STORE;
+        if (di->flags & DF_USER) e->bits |= EB_USER;
+        if (mn == MN_LDRSB || mn == MN_LDRSH) e->bits |= EB_SIGNED;
+        if (di->flags & DF_LOAD) e->writes |= rd | pair; //SWP too
+        else e->reads |= rd | pair;
+        if ((di->flags & DF_LOAD) && (rd & 0x8000))
+        {
+            e->bits |= EB_WRITES_PC;
+            if (arch >= ARMv5TE) e->bits |= EB_EXCHANGE;
+        }
+        break;
+    }
+    case IC_MULTIPLE:
+    {
+        e->reads |= rn;
+        e->width = 4;
+        if (di->flags & DF_USER) e->bits |= EB_USER;
+        if (di->flags & DF_STORE)
+        {
+            e->bits |= EB_STORE;
+            e->reads |= di->reglist;
+            break;
+        }
+        e->bits |= EB_LOAD;
+        e->writes |= di->reglist;
+        if (di->reglist & 0x8000)
+        {
+            e->bits |= EB_WRITES_PC;
+            if (arch >= ARMv5TE) e->bits |= EB_EXCHANGE;
+            if (di->flags & DF_USER) //CPSR from the SPSR, not user mode registers
+            {
+                e->bits = (e->bits & ~EB_USER) | EB_MODE | EB_EXCHANGE;
+                e->flags_written = EF_NZCV | EF_Q;
+            }
+        }
+        break;
+    }
+    case IC_BRANCH:
+    {
+        e->bits |= EB_WRITES_PC;
+        e->reads |= (di->form == FORM_BRANCH_IMM) ? 0x8000 : operands;
+        if (di->flags & DF_LINK) e->writes |= 1 << 14;
+        if (mn == MN_BX || mn == MN_BLX) e->bits |= EB_EXCHANGE;
+        break;
+    }
+    case IC_STATUS:
+    {
+        if (mn == MN_MRS)
+        {
+            e->writes |= rd;
+            if (!(di->flags & DF_SPSR)) e->flags_read |= EF_NZCV | EF_Q;
+            break;
+        }
+        e->reads |= operands;
+        if (di->flags & DF_SPSR) break;
+        if (di->reglist & 8) e->flags_written = EF_NZCV | ((arch >= ARMv5TE) ? EF_Q : 0);
+        if (di->reglist & 1) e->bits |= EB_MODE; //T is not changed by MSR
+        break;
+    }
+    case IC_COPROCESSOR:
+    {
+        e->reads |= rn;
+        if (mn == MN_MRC)
+        {
+            if (rd & 0x8000) e->flags_written = EF_NZCV; //to the flags instead of pc
+            else e->writes |= rd;
+        }
+        else if (mn == MN_MRRC) e->writes |= rd;
+        else e->reads |= rd; //MCR, MCRR
+        if (mn == MN_LDC || mn == MN_STC)
+        {
+            e->width = 4;
+            e->bits |= (mn == MN_LDC) ? EB_LOAD : EB_STORE;
+        }
+        break;
+    }
+    default: //SWI, BKPT and undefined instructions
+    {
+        e->bits |= EB_WRITES_PC | EB_MODE | EB_EXCEPTION;
+        e->flags_read |= EF_NZCV | EF_Q; //saved to the SPSR
+        break;
+    }
+    }
+}
+
+static inline u32 Effects_thumb(u32 code, EFFECTS* e, ARMARCH arch) {
+    /* GetEffects of a THUMB code, return its size like Disassemble_thumb (SIZE_16 or SIZE_32) */
+    DINST di;
+    u32 size = Decode_thumb(code, &di, arch);
+    GetEffects(&di, arch, e);
+    return size;
+}
+
+static inline void Effects_arm(u32 code, EFFECTS* e, ARMARCH arch) {
+    /* GetEffects of an ARM code */
+    DINST di;
+    Decode_arm(code, &di, arch);
+    GetEffects(&di, arch, e);
+}
+
+static void EstimateCycles(const DINST* di, ARMARCH arch, CYCLES* c) {
+    /* Cycles of a decoded instruction on the ARM7TDMI (ARMv4T) or the ARM946E-S (ARMv5TE): condition passed, */
+    /* no wait states, caches and TCM hit, no interlock with the previous instruction */
+    /* The ARM7TDMI counts N/S/I cycles like its datasheet, multiplies take 1 to 4 more I cycles depending on the operand */
+    u32 n = 0, s = 0, i = 0, i_min = 0;
+    u32 cycles = 1; //ARM946E-S
+    u32 regs = CountRegisters(di->reglist);
+    int to_pc = di->rd == 15 || ((di->mnemonic == MN_LDM || di->mnemonic == MN_POP) && (di->reglist & 0x8000));
+    if (regs == 0) regs = 1;
+    switch (di->mnemonic)
+    {
+    case MN_MUL: case MN_MLA: case MN_SMULL: case MN_UMULL: case MN_SMLAL: case MN_UMLAL:
+    {
+        u32 extra = (di->mnemonic == MN_MUL) ? 0 : (di->mnemonic == MN_MLA || di->mnemonic == MN_SMULL || di->mnemonic == MN_UMULL) ? 1 : 2;
+        s = 1;
+        i_min = 1 + extra;
+        i = 4 + extra;
+        cycles = (di->mnemonic == MN_MUL || di->mnemonic == MN_MLA) ? 2 : 3;
+        if (di->flags & DF_S) cycles += 2;
+        break;
+    }
+    case MN_SMLAXY: case MN_SMLAWY: case MN_SMULWY: case MN_SMULXY: case MN_QADD: case MN_QSUB: case MN_QDADD: case MN_QDSUB: case MN_CLZ:
+    {
+        s = 1;
+        break;
+    }
+    case MN_SMLALXY:
+    {
+        cycles = 2;
+        break;
+    }
+    case MN_LDR: case MN_LDRB: case MN_LDRT: case MN_LDRBT: case MN_LDRH: case MN_LDRSB: case MN_LDRSH: case MN_LDRD:
+    {
+        s = to_pc ? 2 : 1;
+        n = to_pc ? 2 : 1;
+        i = 1;
+        cycles = to_pc ? 5 : (di->mnemonic == MN_LDRD) ? 2 : 1;
+        break;
+    }
+    case MN_STR: case MN_STRB: case MN_STRT: case MN_STRBT: case MN_STRH: case MN_STRD:
+    {
+        n = 2;
+        cycles = (di->mnemonic == MN_STRD) ? 2 : 1;
+        break;
+    }
+    case MN_SWP: case MN_SWPB:
+    {
+        s = 1;
+        n = 2;
+        i = 1;
+        cycles = 2;
+        break;
+    }
+    case MN_PLD:
+    {
+        s = 1;
+        break;
+    }
+    case MN_LDM: case MN_POP:
+    {
+        s = regs + (to_pc ? 1 : 0);
+        n = to_pc ? 2 : 1;
+        i = 1;
+        cycles = regs + (to_pc ? 4 : 0);
+        break;
+    }
+    case MN_STM: case MN_PUSH:
+    {
+        s = regs - 1;
+        n = 2;
+        cycles = (regs < 2) ? 2 : regs;
+        break;
+    }
+    case MN_B: case MN_BL: case MN_BLX: case MN_BX:
+    {
+        s = 2;
+        n = 1;
+        cycles = 3;
+        if ((di->flags & DF_THUMB) && di->size == 4) //BL or BLX pair, runs as two instructions, the first one sequential
+        {
+            s = 3;
+            cycles = 4;
+        }
+        break;
+    }
+    case MN_MRS:
+    {
+        s = 1;
+        cycles = 2;
+        break;
+    }
+    case MN_MSR:
+    {
+        s = 1;
+        if (di->reglist & 7) cycles = 3; //1 for the flags only, 3 when the control, extension or status field changes
+        break;
+    }
+    case MN_NA: case MN_SWI: case MN_BKPT: //undefined instruction or software exception, both take the vector
+    {
+        s = 2;
+        n = 1;
+        cycles = 3;
+        break;
+    }
+    case MN_MCR: case MN_MCRR:
+    {
+        n = 1;
+        i = 1;
+        cycles = 2;
+        break;
+    }
+    case MN_MRC: case MN_MRRC:
+    {
+        s = 1;
+        i = 2;
+        cycles = 2;
+        break;
+    }
+    case MN_CDP:
+    {
+        s = 1;
+        i = 1;
+        cycles = 3; //no coprocessor besides CP15 on the ARM946E-S, undefined
+        break;
+    }
+    case MN_LDC: case MN_STC:
+    {
+        s = 1;
+        n = 2;
+        i = 1;
+        cycles = 3;
+        break;
+    }
+    default: //data processing
+    {
+        s = 1;
+        if (di->form == FORM_REG_SHIFT_REG) i = 1, cycles = 2;
+        if (to_pc) s++, n++, cycles += 2;
+        break;
+    }
+    }
+    if (i_min == 0) i_min = i;
+    memset(c, 0, sizeof(CYCLES));
+    if (arch >= ARMv5TE)
+    {
+        c->min = (u8)cycles;
+        c->max = (u8)cycles;
+    }
+    else
+    {
+        c->n = (u8)n;
+        c->s = (u8)s;
+        c->i = (u8)i;
+        c->min = (u8)(n + s + i_min);
+        c->max = (u8)(n + s + i);
+    }
+}
+
+static inline void InitView(VIEW* v, const u8* data, u32 base, u32 size, u8 thumb, ARMARCH arch) {
+    /* Start a view over size bytes of data, mapped at base */
+    memset(v, 0, sizeof(VIEW));
+    v->data = data;
+    v->base = base;
+    v->size = size;
+    v->thumb = thumb;
+    v->arch = arch;
+}
+
+static inline void InvalidateView(VIEW* v, u32 address, u32 size) {
+    /* Drop the cached lines overlapping a written range */
+    for (u32 i = 0; i < VIEW_CACHE_SIZE; i++)
+    {
+        VIEWLINE* line = &v->cache[i];
+        if (line->size && line->address < address + size && address < line->address + line->size) line->size = 0;
+    }
+}
+
+static u32 ReadView(const VIEW* v, u32 offset) {
+    /* 32 bits at offset, zero past the end */
+    u32 code = 0;
+    if (offset < v->size) memcpy(&code, &v->data[offset], (v->size - offset < 4) ? v->size - offset : 4);
+    return code;
+}
+
+static const VIEWLINE* DecodeViewLine(VIEW* v, u32 offset, u32 code) {
+    /* Decoded line at offset, from the cache if the memory hasn't changed since */
+    VIEWLINE* line = &v->cache[(offset >> (v->thumb ? 1 : 2)) & (VIEW_CACHE_SIZE - 1)];
+    u32 address = v->base + offset;
+    if (v->thumb && (code & 0xf800) != 0xf000) code &= 0xffff; //only a BL/BLX prefix depends on the next halfword
+    if (line->size && line->address == address && line->code == code) return line;
+    line->address = address;
+    line->code = code;
+    memset(line->text, 0, STRING_LENGTH); //the decoders only write "n/a" over an empty string
+    if (v->thumb)
+    {
+        line->size = (Disassemble_thumb(code, line->text, v->arch) == SIZE_32) ? 4 : 2;
+    }
+    else
+    {
+        Disassemble_arm(code, line->text, v->arch);
+        line->size = 4;
+    }
+    return line;
+}
+
+static inline u32 DisassembleView(VIEW* v, u32 anchor, u32 before, u32 after, VIEWLINE* lines, u32* anchor_line) {
+    /* Fill lines with up to before lines ending at anchor, the line at anchor and up to after lines following it */
+    /* lines needs room for before + 1 + after, return the number of lines written, *anchor_line is the index of the line holding the anchor */
+    u32 align = v->thumb ? 2 : 4;
+    if (anchor < v->base || anchor - v->base >= v->size) return 0;
+    u32 start = (anchor - v->base) & ~(align - 1);
+    if (v->thumb && start >= 2) //an anchor on the second half of a BL/BLX pair shows the pair
+    {
+        DINST di;
+        u32 pair = ReadView(v, start - 2);
+        if ((pair & 0xf800) == 0xf000 && Decode_thumb(pair, &di, v->arch) == SIZE_32) start -= 2;
+    }
+
+    /* Backward, a line ends where the next one starts: a THUMB halfword preceded by a BL/BLX prefix forms a pair with it, */
+    /* a prefix can never be the second half of a pair so one halfword of context is enough */
+    u32 n = 0;
+    u32 offset = start;
+    while (n < before && offset >= align)
+    {
+        u32 size = align;
+        if (v->thumb && offset >= 4)
+        {
+            DINST di;
+            u32 pair = ReadView(v, offset - 4);
+            if ((pair & 0xf800) == 0xf000 && Decode_thumb(pair, &di, v->arch) == SIZE_32) size = 4;
+        }
+        offset -= size;
+        u32 code = ReadView(v, offset);
+        if (v->thumb && size == 2) code &= 0xffff; //must not run into the next line
+        lines[n++] = *DecodeViewLine(v, offset, code);
+    }
+    for (u32 i = 0; i < n / 2; i++) //was filled backward
+    {
+        VIEWLINE tmp = lines[i];
+        lines[i] = lines[n - 1 - i];
+        lines[n - 1 - i] = tmp;
+    }
+    *anchor_line = n;
+
+    /* Forward from the anchor */
+    offset = start;
+    for (u32 i = 0; i <= after && offset < v->size; i++)
+    {
+        const VIEWLINE* line = DecodeViewLine(v, offset, ReadView(v, offset));
+        lines[n++] = *line;
+        offset += line->size;
+    }
+    return n;
+}
+
+static inline void InitReader(READER* r, READFUNC read, void* user, ARMARCH arch) {
+    /* Start reading the target memory through read, one page at a time */
+    memset(r, 0, sizeof(READER));
+    r->read = read;
+    r->user = user;
+    r->arch = arch;
+    SelectDecoders(&r->dec, arch);
+}
+
+static inline void InvalidateReader(READER* r) {
+    /* Forget the pages read so far, call it when the target memory may have changed (the emulator ran, a byte was written) */
+    for (u32 i = 0; i < READER_PAGES; i++) r->pages[i].size = 0;
+}
+
+static int ReadReader(READER* r, u32 address, u32 size, u32* value) {
+    /* size (up to 4) bytes at address into *value, fetching whole pages, return 0 if some of them can't be read */
+    *value = 0;
+    for (u32 i = 0; i < size; i++)
+    {
+        u32 a = address + i;
+        READERPAGE* page = &r->pages[(a / READER_PAGE_SIZE) & (READER_PAGES - 1)];
+        if (page->size == 0 || page->address != (a & ~(READER_PAGE_SIZE - 1)))
+        {
+            page->address = a & ~(READER_PAGE_SIZE - 1);
+            page->size = r->read(r->user, page->address, page->data, READER_PAGE_SIZE);
+        }
+        if (a - page->address >= page->size) return 0;
+        *value |= (u32)page->data[a - page->address] << (i * 8);
+    }
+    return 1;
+}
+
+static inline u32 DisassembleRead(READER* r, u32 pc, u8 thumb, u8* str) {
+    /* Disassemble the instruction at pc into str (zeroed, STRING_LENGTH bytes), return its size or 0 if pc can't be read */
+    /* Pc-relative loads get the value they load appended, as " ; =0x..." */
+    u32 code = 0;
+    u32 size = 4;
+    DINST di;
+    if (thumb)
+    {
+        if (!ReadReader(r, pc, 2, &code)) return 0;
+        u32 suffix = 0;
+        if ((code & 0xf800) == 0xf000 && ReadReader(r, pc + 2, 2, &suffix)) code |= suffix << 16; //BL/BLX prefix
+        size = (r->dec.disassemble_thumb(code, str) == SIZE_32) ? 4 : 2;
+        r->dec.decode_thumb(code, &di);
+    }
+    else
+    {
+        if (!ReadReader(r, pc, 4, &code)) return 0;
+        r->dec.disassemble_arm(code, str);
+        r->dec.decode_arm(code, &di);
+    }
+    if (!(di.flags & DF_LOAD) || di.rn != 15 || di.form != FORM_MEM_IMM) return size;
+
+    u32 width = 0;
+    switch (di.mnemonic)
+    {
+    case MN_LDR: width = 4; break;
+    case MN_LDRH: case MN_LDRSH: width = 2; break;
+    case MN_LDRB: case MN_LDRSB: width = 1; break;
+    default: return size; //LDRD, LDC: more than a word, or not into a register
+    }
+    u32 literal = thumb ? ((pc + 4) & ~3u) + di.imm : pc + 8 + di.imm;
+    u32 value = 0;
+    if (!ReadReader(r, literal, width, &value)) return size;
+    u32 digits = width * 2;
+    if (di.mnemonic == MN_LDRSH) value = (u32)(int)(short)value, digits = 8; //as the register holds it
+    if (di.mnemonic == MN_LDRSB) value = (u32)(int)(signed char)value, digits = 8;
+    size_t len = strlen(str);
+    snprintf(&str[len], STRING_LENGTH - len, " ; =0x%0*X", (int)digits, value);
+    return size;
+}
+
+static u32 DecodeBlockFrom(BLOCK* b, const u8* data, u32 base, u32 size, READER* r, u32 address, u8 thumb, ARMARCH arch, const DECODERS* dec) {
+    /* Decode from address until the first instruction that writes pc, from data (r is NULL) or through r */
+    /* Return the number of instructions, 0 if address can't be read */
+    memset(b, 0, offsetof(BLOCK, insts));
+    b->start = address;
+    b->thumb = thumb;
+    b->arch = (u8)arch;
+    b->end = BLOCK_UNREADABLE;
+    u32 a = address;
+    while (b->count < BLOCK_MAX)
+    {
+        u32 code = 0;
+        u32 width = thumb ? 2 : 4;
+        if (r == NULL)
+        {
+            if (a < base || a - base > size || size - (a - base) < width) break;
+            u32 left = size - (a - base);
+            memcpy(&code, &data[a - base], (left < 4) ? left : 4);
+        }
+        else if (!ReadReader(r, a, width, &code)) break;
+        BLOCKINST* inst = &b->insts[b->count++];
+        if (thumb)
+        {
+            u32 suffix = 0;
+            if (r == NULL) code &= ((code & 0xf800) == 0xf000) ? 0xffffffff : 0xffff; //only a BL/BLX prefix needs the next halfword
+            else if ((code & 0xf800) == 0xf000 && ReadReader(r, a + 2, 2, &suffix)) code |= suffix << 16;
+            dec->decode_thumb(code, &inst->di);
+            if (inst->di.size == 2) code &= 0xffff;
+        }
+        else dec->decode_arm(code, &inst->di);
+        inst->address = a;
+        inst->code = code;
+        a += inst->di.size;
+
+        EFFECTS e;
+        GetEffects(&inst->di, arch, &e);
+        if (!(e.bits & EB_WRITES_PC)) continue;
+        const DINST* di = &inst->di;
+        BLOCKEXIT next = { a, thumb, EXIT_NEXT };
+        if (e.bits & EB_EXCEPTION)
+        {
+            b->end = BLOCK_EXCEPTION;
+        }
+        else if (di->form == FORM_BRANCH_IMM)
+        {
+            BLOCKEXIT* x = &b->exits[b->exit_count++];
+            u8 switch_mode = (di->mnemonic == MN_BLX);
+            x->address = inst->address + di->imm;
+            if (switch_mode && thumb) x->address &= ~3u; //to ARM
+            x->thumb = thumb ^ switch_mode;
+            x->kind = (di->flags & DF_LINK) ? EXIT_CALL : EXIT_JUMP;
+            b->end = BLOCK_BRANCH;
+        }
+        else b->end = BLOCK_INDIRECT;
+        if ((e.bits & EB_CONDITIONAL) || (di->flags & DF_LINK) || di->mnemonic == MN_SWI) b->exits[b->exit_count++] = next; //not taken, or returning from the call
+        b->size = a - address;
+        return b->count;
+    }
+    if (b->count == BLOCK_MAX) //cut
+    {
+        BLOCKEXIT next = { a, thumb, EXIT_NEXT };
+        b->end = BLOCK_LIMIT;
+        b->exits[b->exit_count++] = next;
+    }
+    b->size = a - address;
+    return b->count;
+}
+
+static inline u32 DecodeBlock(BLOCK* b, const u8* data, u32 base, u32 size, u32 address, u8 thumb, ARMARCH arch) {
+    /* Block starting at address, from size bytes of memory at data, data[0] being at address base */
+    DECODERS dec;
+    SelectDecoders(&dec, arch);
+    return DecodeBlockFrom(b, data, base, size, NULL, address, thumb, arch, &dec);
+}
+
+static inline u32 DecodeBlockRead(BLOCK* b, READER* r, u32 address, u8 thumb) {
+    /* Block starting at address, read through a READER set up by InitReader */
+    return DecodeBlockFrom(b, NULL, 0, 0, r, address, thumb, r->arch, &r->dec);
+}
+
+static inline void BlockText(const BLOCK* b, u32 index, u8* str) {
+    /* Text of an instruction of a block into str (zeroed, STRING_LENGTH bytes), only when asked for */
+    if (b->thumb) Disassemble_thumb(b->insts[index].code, str, (ARMARCH)b->arch);
+    else Disassemble_arm(b->insts[index].code, str, (ARMARCH)b->arch);
+}
+
+static u32 ShiftValue(u32 v, u32 type, u32 amount) {
+    /* LSL, LSR, ASR or ROR (type 0 to 3) of v by an immediate amount, 32 included */
+    switch (type)
+    {
+    case 0: return (amount >= 32) ? 0 : v << amount;
+    case 1: return (amount >= 32) ? 0 : v >> amount;
+    case 2: return (amount >= 32) ? (u32)((int)v >> 31) : (u32)((int)v >> amount);
+    default: return (amount & 31) ? ROR(v, (amount & 31)) : v;
+    }
+}
+
+static int BlockDataValue(const BLOCKINST* bi, u8 thumb, const u32* values, u16 known, u32* out) {
+    /* Result of a data processing instruction from the known values of its operands, 0 if it can't be worked out */
+    const DINST* di = &bi->di;
+    u32 mn = di->mnemonic;
+    u32 op2 = 0;
+    u32 rn = 0;
+    if (di->rd == REG_NONE) return 0; //compares
+    switch (di->form)
+    {
+    case FORM_IMM: op2 = di->imm; break;
+    case FORM_REG:
+    {
+        if (!(known >> di->rm & 1)) return 0;
+        op2 = values[di->rm];
+        break;
+    }
+    case FORM_REG_SHIFT_IMM:
+    {
+        if (!(known >> di->rm & 1)) return 0;
+        u32 type = thumb ? mn - MN_LSL : BITS(bi->code, 5, 2);
+        u32 amount = di->imm;
+        if (thumb && type && !amount) amount = 32; //THUMB LSR and ASR #0 mean #32
+        if (!thumb && type == 3 && !amount) return 0; //RRX, needs the carry
+        op2 = ShiftValue(values[di->rm], type, amount);
+        if (thumb) mn = MN_MOV; //the shift is the whole instruction
+        break;
+    }
+    default: return 0; //shifts by a register
+    }
+    if (di->rn != REG_NONE)
+    {
+        if (!(known >> di->rn & 1)) return 0;
+        rn = values[di->rn];
+        if (thumb && di->rn == 15) rn &= ~3u; //ADD (5), like a literal load
+    }
+    switch (mn)
+    {
+    case MN_MOV: *out = op2; return 1;
+    case MN_MVN: *out = ~op2; return 1;
+    case MN_NEG: *out = 0 - op2; return 1;
+    case MN_ADD: *out = rn + op2; return 1;
+    case MN_SUB: *out = rn - op2; return 1;
+    case MN_RSB: *out = op2 - rn; return 1;
+    case MN_AND: *out = rn & op2; return 1;
+    case MN_ORR: *out = rn | op2; return 1;
+    case MN_EOR: *out = rn ^ op2; return 1;
+    case MN_BIC: *out = rn & ~op2; return 1;
+    default: return 0; //carry in, or not arithmetic
+    }
+}
+
+static u32 ResolveBlockAccesses(const BLOCK* b, const u8* data, u32 base, u32 size, REGSTATE* rs, MEMACCESS accesses[2 * BLOCK_MAX]) {
+    /* Addresses of the memory accesses of a block decoded by DecodeBlock from the same data, return how many were resolved */
+    /* Registers follow literal pool loads, and mov, add, sub, orr, bic... with known operands */
+    /* rs holds those known at the start of the block (zeroed for none) and gets those known at its end, for the next block of a BLOCK_LIMIT cut */
+    u32* values = rs->values;
+    u16 known = rs->known;
+    u32 count = 0;
+    for (u32 i = 0; i < b->count; i++)
+    {
+        const BLOCKINST* bi = &b->insts[i];
+        const DINST* di = &bi->di;
+        EFFECTS e;
+        GetEffects(di, (ARMARCH)b->arch, &e);
+        values[15] = bi->address + (b->thumb ? 4 : 8);
+        known |= 1 << 15;
+        u32 result = 0;
+        int resolved = 0; //result goes to rd
+        u16 kept = 0; //written registers whose new value is in values
+
+        if (di->iclass == IC_DATA)
+        {
+            resolved = BlockDataValue(bi, b->thumb, values, known, &result);
+        }
+        else if (di->iclass == IC_LOADSTORE && di->mnemonic != MN_PLD && di->rn != REG_NONE && (known >> di->rn & 1))
+        {
+            u32 rn = values[di->rn];
+            if (b->thumb && di->rn == 15) rn &= ~3u;
+            u32 offset = 0;
+            int ok = 1;
+            switch (di->form)
+            {
+            case FORM_MEM_IMM: case FORM_MEM_PRE_IMM: offset = di->imm; break;
+            case FORM_MEM_REG: case FORM_MEM_PRE_REG:
+            {
+                //ARM addressing mode 2 can shift rm, only the plain register is followed
+                int shifted = !b->thumb && BITS(bi->code, 26, 2) == 1 && BITS(bi->code, 4, 8);
+                ok = (known >> di->rm & 1) && !shifted;
+                if (ok) offset = (di->flags & DF_SUBTRACT) ? 0 - values[di->rm] : values[di->rm];
+                break;
+            }
+            default: break; //post-indexed, at rn
+            }
+            if (ok)
+            {
+                u32 address = rn + offset;
+                if (e.bits & EB_LOAD)
+                {
+                    MEMACCESS a = { address, e.width, (u8)i, 0 };
+                    accesses[count++] = a;
+                }
+                if (e.bits & EB_STORE)
+                {
+                    MEMACCESS a = { address, e.width, (u8)i, 1 };
+                    accesses[count++] = a;
+                }
+                if (di->rn == 15 && (e.bits & EB_LOAD) && e.width <= 4 && address >= base && address - base < size && size - (address - base) >= e.width) //literal pool
+                {
+                    memcpy(&result, &data[address - base], e.width);
+                    if (di->mnemonic == MN_LDRSH) result = (u32)(int)(short)result;
+                    if (di->mnemonic == MN_LDRSB) result = (u32)(int)(signed char)result;
+                    resolved = (di->mnemonic != MN_SWP && di->mnemonic != MN_SWPB);
+                }
+            }
+            if ((di->flags & DF_WRITEBACK) && (di->form == FORM_MEM_PRE_IMM || di->form == FORM_MEM_POST_IMM) && di->rn != di->rd)
+            {
+                values[di->rn] = rn + di->imm;
+                kept = 1 << di->rn;
+            }
+        }
+        else if (di->iclass == IC_MULTIPLE && di->rn != REG_NONE && (known >> di->rn & 1) && di->reglist)
+        {
+            u32 n = CountRegisters(di->reglist);
+            u32 rn = values[di->rn];
+            u32 lowest = rn;
+            switch (di->form)
+            {
+            case FORM_LIST_DA: lowest = rn - 4 * n + 4; break;
+            case FORM_LIST_DB: lowest = rn - 4 * n; break;
+            case FORM_LIST_IB: lowest = rn + 4; break;
+            default: break;
+            }
+            MEMACCESS a = { lowest, 4 * n, (u8)i, (u8)((e.bits & EB_STORE) != 0) };
+            accesses[count++] = a;
+            if ((di->flags & DF_WRITEBACK) && !(di->reglist >> di->rn & 1))
+            {
+                values[di->rn] = (di->form == FORM_LIST_DA || di->form == FORM_LIST_DB) ? rn - 4 * n : rn + 4 * n;
+                kept = 1 << di->rn;
+            }
+        }
+
+        if (resolved && di->rd != REG_NONE) //values only has the 16 registers
+        {
+            values[di->rd] = result;
+            kept |= 1 << di->rd;
+        }
+        if (e.bits & EB_CONDITIONAL) kept = 0; //may not happen
+        known = (known & ~e.writes) | (e.writes & kept);
+    }
+    rs->known = known;
+    return count;
+}
+
+#endif // !DTHUMB_H
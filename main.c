@@ -1,379 +1,4731 @@
-#include "dthumb.h"
-
-typedef enum {
-    DARM,
-    DTHUMB
-}DMODE;
-
-typedef enum {
-    DARGS_INVALID,
-    DARGS_SINGLE,
-    DARGS_STDOUT,
-    DARGS_FILEOUT
-}DARGS_STATUS;
-
-typedef struct {
-    int start; //starting address
-    int end; //end address
-}FILERANGE;
-
-typedef struct {
-    u8* fname_in;
-    u8* fname_out;
-    FILERANGE frange;
-    DMODE dmode;
-    ARMARCH arch;
-    u32 code;
-}DARGS;
-
-static int GetFileSize_mine(FILE* fp) {
-    /* Return the size of an opened file */
-    fseek(fp, 0, SEEK_END);
-    int size = ftell(fp);
-    rewind(fp);
-    return size;
-}
-
-static int DisassembleFile(FILE* in, FILE* out, DARGS* dargs) {
-    /* Disassemble from a binary file, print to another file */
-    int size = GetFileSize_mine(in);
-    if (dargs->frange.start > size || dargs->frange.end > size) return 0; //out of range
-    if (dargs->frange.end == 0) dargs->frange.end = size;
-    size = dargs->frange.end - dargs->frange.start;
-    fprintf(out, "Disassembly of %u (0x%X) bytes:\n\n", size, size);
-
-    fseek(in, dargs->frange.start, SEEK_SET);
-
-    if (dargs->dmode == DARM)
-    {
-        for (int i = 0; i < size / 4; i++)
-        {
-            u8 str[STRING_LENGTH] = { 0 };
-            u32 code = 0;
-            fread(&code, 4, 1, in); //read 32 bits
-            Disassemble_arm(code, str, dargs->arch);
-            fprintf(out, "%08X: %08X %s\n", dargs->frange.start + i * 4, code, str);
-        }
-    }
-    else //DTHUMB
-    {
-        for (int i = 0; i < size / 2; i++)
-        {
-            u8 str[STRING_LENGTH] = { 0 };
-            u32 code = 0;
-            fread(&code, 4, 1, in); //prefetch 32 bits
-            if (Disassemble_thumb(code, str, dargs->arch) == SIZE_32) //32-bit
-            {
-                fprintf(out, "%08X: %08X %s\n", dargs->frange.start + i * 2, code, str);
-                i++;
-            }
-            else //16-bit
-            {
-                fseek(in, -2, SEEK_CUR); //go back 2 bytes
-                fprintf(out, "%08X: %04X     %s\n", dargs->frange.start + i * 2, code & 0xffff, str);
-            }
-        }
-    }
-
-    fprintf(out, "\n%u unknown instructions.", debug_na_count);
-    return 1; //success
-}
-
-static void DisassembleSingle(DARGS* dargs) {
-    /* Disassemble a single code and prints it to stdout */
-    u8 str[STRING_LENGTH] = { 0 };
-    if (dargs->dmode == DARM)
-    {
-        Disassemble_arm(dargs->code, str, dargs->arch);
-        printf("%08X %s\n", dargs->code, str);
-    }
-    else
-    {
-        if (Disassemble_thumb(dargs->code, str, dargs->arch) == SIZE_32) //32-bit
-        {
-            printf("%08X %s\n", dargs->code, str);
-        }
-        else //16-bit
-        {
-            printf("%04X     %s\n", dargs->code & 0xffff, str);
-        }
-    }
-}
-
-static int IsValidPath(u8* path) {
-    /* Check if length of path/filename is */
-    u32 hasDotAndEom = 0;
-    if (!path || !path[0]) return 0; //needs to be at least one char
-    for (u32 i = 1; i < PATH_LENGTH; i++)
-    {
-        if (path[i] == '.') hasDotAndEom = 1;
-        if (!path[i])
-        {
-            hasDotAndEom++;
-            break; //found EOM
-        }
-    }
-    if (hasDotAndEom == 2) return 1;
-    return 0;
-}
-
-static int IfValidCodeSet(u32* code, u8* str) {
-    /* Convert string to 32-bit hex value */
-    if (strlen(str) > 8) return 0;
-    *code = (u32)strtoll(str, NULL, 16);
-    return 1;
-}
-
-static int IfValidRangeSet(FILERANGE* range, u8* r) {
-    /* Check to see if the range string yields a valid FILERANGE */
-    //Acceptable formats:
-    //"X-X" //start to end
-    //"--X" //unspecified start (default to beginning of file, 0) to end
-    //"X--" //start to unspecified end (default to end of file)
-
-    //todo: new acceptable format: <start>:<size>
-
-    u32 start = 0;
-    u32 end = 0;
-    u32 valid = 0;
-
-    if (!r || !r[0] || r[0] == '/') return 0; //needs to be at least one char, +smart abort for detecting "/a"
-
-    /* Init buffer (memcpy with two limit conditions) */
-    u8 str[RANGE_LENGTH] = { 0 };
-    u32 i = 0; //count chars
-    while (r[i] && (i < RANGE_LENGTH - 1)) //must be null terminated
-    {
-        str[i] = r[i];
-        i++;
-    }
-
-    switch (*(u16*)str)
-    {
-    case 0x2d2d: //-- detect double dash
-    case 0x3a2d: //-: detect size
-    {
-        end = strtol(&str[2], NULL, 16);
-        valid = 1;
-        break;
-    }
-    default: //go through the string
-    {
-        for (u32 j = 0; j < i; j++)
-        {
-            if (str[j] == '-') //first dash
-            {
-                start = strtol(str, NULL, 16);
-                end = strtol(&str[j + 1], NULL, 16);
-                valid = 1;
-                break;
-            }
-            else if (str[j] == ':') //start + size
-            {
-                start = strtol(str, NULL, 16);
-                end = start + strtol(&str[j + 1], NULL, 16);
-                valid = 1;
-                break;
-            }
-        }
-    }
-    }
-
-    if (!valid) return 0;
-
-    if (end && (start > end))
-    {
-        printf("WARNING: If END is specified and non-zero, it cannot be greater than START. The whole file will be disassembled.\n");
-        return 0; //start can't be greater than end if end is non-zero
-    }
-
-    /* Success, set */
-    range->start = start;
-    range->end = end;
-    return 1;
-}
-
-static int IfValidModeSet(DARGS* dargs, u8* m) {
-    /* Only check first two chars to change from default DTHUMB to DARM mode */
-    //valid inputs: (/a, /a4, /a5), (/t, /t4, /t5, /4, /5) -> (/a, /a4), (/4)
-
-    if (!m || !m[0] || m[0] != '/') return 0; //needs to be at least one char, beggining with "/"
-    if (strlen(m) > 3) return 0; //can't have more than 3 printable characters
-
-    switch (*(u16*)(&m[1])) //treat as a 16-bit value to decode faster
-    {
-    case 0x0061: //a
-    case 0x3561: //a5
-    {
-        dargs->dmode = DARM;
-        dargs->arch = ARMv5TE; //redundant
-        return 1;
-    }
-    case 0x3461: //a4
-    {
-        dargs->dmode = DARM;
-        dargs->arch = ARMv4T;
-        return 1;
-    }
-    case 0x3474: //t4
-    case 0x0034: //4
-    {
-        dargs->dmode = DTHUMB; //redundant
-        dargs->arch = ARMv4T;
-        return 1;
-    }
-    case 0x0074: //t
-    case 0x0035: //5
-    case 0x3574: //t5
-    {
-        dargs->dmode = DTHUMB; //redundant
-        dargs->arch = ARMv5TE; //redundant
-        return 1;
-    }
-    default:
-    {
-        return 0; //invalid input
-    }
-    }
-}
-
-static int ParseCommandLineArguments(DARGS* dargs, int argc, char* argv[]) {
-    /* You can pass arguments in any order, but they need to be valid */
-    /* fname_in has to be valid, else return 0 (failed) */
-    /* The other arguments can be invalid, default behavior is handled */
-
-    //todo: make better use of argc to know which argv you can read from (careful with invalid pointers, oob reads)
-
-    if (argc < 2 || argc > 5) return DARGS_INVALID;
-
-    if (IsValidPath(argv[1])) //filein
-    {
-        dargs->fname_in = argv[1];
-        if (IsValidPath(argv[2])) //fileout
-        {
-            dargs->fname_out = argv[2];
-            if (IfValidRangeSet(&dargs->frange, argv[3]))
-            {
-                IfValidModeSet(dargs, argv[4]);
-            }
-            else if (IfValidModeSet(dargs, argv[3]))
-            {
-                IfValidRangeSet(&dargs->frange, argv[4]);
-            }
-            return DARGS_FILEOUT;
-        }
-        else //stdout
-        {
-            if (IfValidRangeSet(&dargs->frange, argv[2]))
-            {
-                IfValidModeSet(dargs, argv[3]);
-            }
-            else if (IfValidModeSet(dargs, argv[2]))
-            {
-                IfValidRangeSet(&dargs->frange, argv[3]);
-            }
-            return DARGS_STDOUT;
-        }
-    }
-    else if (IfValidCodeSet(&dargs->code, argv[1])) //single code
-    {
-        IfValidModeSet(dargs, argv[2]);
-        return DARGS_SINGLE;
-    }
-    return DARGS_INVALID;
-}
-
-//#define DEBUG //comment out to disable debug ifdefs
-
-int main(int argc, char* argv[]) {
-
-    clock_t start = clock();
-
-#ifdef DEBUG
-    /* Performance test */
-    FILE* fdebug = fopen("fdebug.txt", "w+");
-    printf("Performance test started.\n");
-    u32 i = 0;
-    do
-    {
-        u8 s[STRING_LENGTH] = { 0 };
-        Disassemble_arm(i, s, ARMv5TE);
-        //Disassemble_thumb(i, s, ARMv5TE);
-        //fprintf(fdebug, "%08X %s\n", i, s);
-
-        if (!(i & 0xfffffff)) printf("%08X\n", i);
-
-    } while (++i);
-    fclose(fdebug);
-#else
-
-    DARGS dargs = { NULL, NULL, {0}, ARMv5TE, DTHUMB, 0 };
-    DARGS_STATUS ds = ParseCommandLineArguments(&dargs, argc, argv);
-
-    switch (ds)
-    {
-    case DARGS_INVALID:
-    {
-        printf("Nothing was done\n");
-        return 0; //terminate
-    }
-    case DARGS_SINGLE:
-    {
-        DisassembleSingle(&dargs);
-        break;
-    }
-    case DARGS_STDOUT:
-    {
-        FILE* file_in = fopen(dargs.fname_in, "rb"); //ignore warning, IsValidPath makes sure it isn't NULL
-        if (file_in == NULL)
-        {
-            printf("ERROR: The file \"%s\" doesn't exist. Aborting.\n", dargs.fname_in);
-            return 0; //terminate
-        }
-        printf("Starting disassembly of \"%s\".\n", dargs.fname_in);
-        if (DisassembleFile(file_in, stdout, &dargs))
-        {
-            printf("\nSuccessfully disassembled \"%s\".\n", dargs.fname_in);
-        }
-        else
-        {
-            printf("ERROR: DisassembleFile failed.\n");
-        }
-        fclose(file_in);
-        break;
-    }
-    case DARGS_FILEOUT:
-    {
-        FILE* file_in = fopen(dargs.fname_in, "rb"); //ignore warning, IsValidPath makes sure it isn't NULL
-        if (file_in == NULL)
-        {
-            printf("ERROR: The file \"%s\" doesn't exist. Aborting.\n", dargs.fname_in);
-            return 0; //terminate
-        }
-        FILE* file_out = fopen(dargs.fname_out, "w+"); //ignore warning, IsValidPath makes sure it isn't NULL
-        if (file_out == NULL)
-        {
-            printf("ERROR: The file \"%s\" could not be created. Aborting.\n", dargs.fname_out);
-            return 0; //terminate
-        }
-
-        printf("Starting disassembly of \"%s\".\n", dargs.fname_in);
-        if (DisassembleFile(file_in, file_out, &dargs))
-        {
-            printf("Successfully disassembled \"%s\" to \"%s\".\n", dargs.fname_in, dargs.fname_out);
-        }
-        else
-        {
-            printf("ERROR: DisassembleFile failed.\n");
-        }
-        fclose(file_in);
-        fclose(file_out);
-        break;
-    }
-    }
-
-#endif // DEBUG
-
-    printf("Completion time: %.0f ms\n", (double)clock() - (double)start);
-    return 0;
-}
+#define _FILE_OFFSET_BITS 64 //off_t, fseeko and mmap past 2 GiB on 32-bit systems
+#define _POSIX_C_SOURCE 200809L //fseeko, clock_gettime and sockets with -std=c99 or c11
+#define _DEFAULT_SOURCE //madvise
+
+#include "dthumb.h"
+
+#include <stdarg.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define DTHUMB_SSE2 //hex columns of the listing 16 digits at once
+#endif
+
+/* MACROS */
+
+#define WORKERS_MAX (64)
+#define OUTBUF_SIZE (1 << 20) //1 MiB of text between two writes
+#define LISTING_BLOCK (1 << 12) //bytes of code read, decoded, formatted then written at once
+#define LISTING_SLOTS_PER_WORKER (2) //blocks in flight per thread of the listing pipeline
+#define CLASSIFY_WINDOW (256) //bytes scored at once by the code/data classifier, divides LISTING_BLOCK
+#define DETECT_WINDOW (512) //bytes scored at once as ARM and as THUMB by the mode detector, multiple of 4
+#define DETECT_MIN (40) //score under which a window keeps the mode of the previous one
+#define DETECT_MARGIN (15) //difference of scores under which a window also counts its neighbours
+#define TRACE_CHUNK (1 << 18) //records given to a worker at once
+#define TRACE_LOOP_MAX (64) //longest loop body folded into a single "x" line
+#define MIX_ARM_KEYS (1 << 20) //MixKeyArm values, counters of each /mix worker
+#define MIX_ARM_BLOCK (1ULL << 33) //bytes of ARM code counted before the keys are decoded, fewer than 2^32 codes
+#define SCAN_LINE_LENGTH (4096) //longest line of a signature file
+#define SCAN_CACHE_BITS (14) //ARM codes remembered by each scan worker
+#define FUNCTIONTABLE_MAGIC "DTFN"
+#define FUNCTIONTABLE_VERSION (1)
+#define XREFTABLE_MAGIC "DTXR"
+#define XREFTABLE_VERSION (1)
+#define DIFF_CONTEXT (3) //unchanged instructions printed around a change
+#define DIFF_RUN_MAX (32) //longest run of instructions used to align regions without unique instructions
+#define SERVE_FILES (16) //files kept mapped by the server, the input file included
+#define SERVE_REQUEST_MAX (64 + PATH_LENGTH) //longest request frame
+#define SERVE_RANGE_MAX (1 << 20) //most bytes listed by a single range request
+#define SERVE_CLIENTS_MAX (64) //clients connected at once, the next ones are refused
+#define SERVE_LINES (SERVE_RANGE_MAX / 2) //decoded lines kept for each served file between requests, by offset, enough for a THUMB range
+#define PROFILE_GAP (64) //bytes between two sampled addresses still listed as one range, without a function table
+#define PROFILE_THRESHOLD (1.0) //percent of the hits, default
+#define MMIO_START (0x04000000) //I/O registers of the GBA and the DS
+#define MMIO_END (0x05000000)
+
+/* TYPEDEFS */
+
+typedef enum {
+    DARM,
+    DTHUMB
+}DMODE;
+
+typedef enum {
+    DTOOL_DISASSEMBLE, //default, listing of a binary file
+    DTOOL_TRACE, //listing of an emulator trace file
+    DTOOL_MIX, //instruction mix statistics, no listing
+    DTOOL_SCAN, //search for instruction signatures
+    DTOOL_FUNCTIONS, //function table
+    DTOOL_XREF, //cross-reference table, or references of an address
+    DTOOL_DIFF, //instruction-level difference with another file
+    DTOOL_SERVE, //answer requests on a local socket
+    DTOOL_PROFILE, //listing of the hot spots of a sampling profile
+    DTOOL_DETECT, //mode map guessed from the code
+    DTOOL_MMIO, //instructions accessing each I/O register
+    DTOOL_MAX
+}DTOOL;
+
+typedef enum {
+    DARGS_INVALID,
+    DARGS_SINGLE,
+    DARGS_STDOUT,
+    DARGS_FILEOUT
+}DARGS_STATUS;
+
+typedef struct {
+    u64 start; //starting address
+    u64 end; //end address
+}FILERANGE;
+
+typedef struct {
+    u32 na; //percentage of n/a instructions
+    u32 ascii; //percentage of bytes in printable text runs
+    u32 repeat; //percentage of words equal to the previous one
+    u32 cond; //percentage of ARM codes with a condition other than AL
+}CLASSIFYTHRESHOLDS; //a window reaching any of them is listed as data
+
+typedef struct {
+    u64 start; //first byte
+    u64 end; //past the last byte
+    DMODE dmode;
+    ARMARCH arch;
+    DECODERS dec; //selected for arch when the listing starts
+}MODERANGE;
+
+typedef struct {
+    MODERANGE* ranges; //sorted by start, they don't overlap
+    u32 count;
+}MODEMAP;
+
+typedef struct {
+    u8* fname_in;
+    u8* fname_out;
+    FILERANGE frange;
+    DMODE dmode;
+    ARMARCH arch;
+    u32 code;
+    DTOOL tool;
+    u8* tool_value; //text after ':' in the tool switch, NULL if none
+    u8* fname_functions; //function table used to label the listing, NULL if none
+    u8 stats; //print where the time went after a listing
+    u8 classify; //list windows that look like data as .word/.byte
+    CLASSIFYTHRESHOLDS thresholds;
+    u8* fname_modes; //mode map, NULL if none
+    MODEMAP modemap; //ranges decoded in another mode than dmode/arch, ranges is NULL if the map couldn't be read
+    u8 detect_modes; //1 with /modes:auto, modemap is filled by DetectModeMap before the tool runs
+    u8 cycles; //annotate the listing with cycle estimates, then total them
+    u64 base; //address of the first byte of the input file, for /profile
+    u8* fname_tables; //decode tables, NULL to decode live
+    u8* fname_served[SERVE_FILES - 1]; //other files named on the command line, the only ones /serve lists besides the input file
+    u32 served_count;
+}DARGS;
+
+typedef struct {
+    u8* data;
+    u64 size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+}MAPPEDFILE;
+
+typedef struct {
+    FILE* fp; //NULL if the text stays in memory
+    u8* data;
+    size_t size;
+    size_t capacity;
+}OUTBUF;
+
+typedef void (*WORKER)(void* arg);
+
+typedef struct {
+    WORKER func;
+    void* arg;
+#ifdef DTHUMB_INSTRUMENT
+    INSTRUMENTATION* instrumentation; //counters of the thread, merged by RunWorkers
+#endif
+}WORKERSTART;
+
+typedef enum {
+    TRACE_ARM,
+    TRACE_THUMB
+}TRACEMODE;
+
+typedef enum {
+    TRACE_ARM9, //ARM946E-S, decoded as ARMv5TE
+    TRACE_ARM7 //ARM7TDMI, decoded as ARMv4T
+}TRACECPU;
+
+typedef struct {
+    u32 pc; //address of the instruction
+    u32 opcode; //ARM: the instruction, THUMB: the instruction in the low halfword, the next halfword in the high halfword
+    u8 mode; //TRACEMODE
+    u8 cpu; //TRACECPU
+    u16 reserved; //should be zero
+}TRACERECORD; //12 bytes, little-endian, see README.md
+
+typedef struct {
+    u64* keys; //0 marks an empty slot
+    u32* values; //offset of the formatted code in pool, bit 31 set if n/a
+    u32 capacity; //power of 2
+    u32 count;
+    u32 shift; //64 - log2(capacity)
+    OUTBUF pool; //formatted codes, null terminated
+}DECODECACHE;
+
+typedef struct {
+    const TRACERECORD* records;
+    size_t begin;
+    size_t end;
+    size_t count; //records in the file, a loop starting before end can go on past it
+    size_t stop; //past the last record formatted
+    DECODECACHE cache; //kept from one chunk to the next
+    OUTBUF text;
+    u64 na_count;
+    u64 loops;
+}TRACEJOB;
+
+typedef struct {
+    u64 mnemonics[MN_MAX];
+    u64 classes[IC_MAX];
+    u64 conditions[CONDITIONS_MAX];
+    u64 forms[FORM_MAX];
+    u64 reglists[17]; //LDM, STM, PUSH, POP by number of registers
+    u64 total;
+}MIXCOUNTS;
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //start of the range
+    u64 begin; //first byte of the chunk
+    u64 end; //end of the chunk
+    DMODE dmode;
+    ARMARCH arch;
+    MIXCOUNTS counts;
+}MIXJOB;
+
+typedef struct {
+    u64 count;
+    u32 index;
+}SORTENTRY;
+
+typedef enum {
+    PREDICATE_ANY, //*
+    PREDICATE_CODE, //masked code
+    PREDICATE_TEXT //template
+}PREDICATEKIND;
+
+typedef struct {
+    u8 kind; //PREDICATEKIND
+    u32 mask; //PREDICATE_CODE: bits that have to match
+    u32 value;
+    u8 text[STRING_LENGTH]; //normalized element, the template for PREDICATE_TEXT
+}PREDICATE;
+
+typedef struct {
+    u8 name[64];
+    u32 first; //position of the first element in the automaton
+    u32 length; //number of elements
+}SIGNATURE;
+
+typedef struct {
+    DMODE dmode;
+    ARMARCH arch;
+    PREDICATE* predicates; //distinct elements
+    u32 predicate_count;
+    SIGNATURE* signatures;
+    u32 signature_count;
+    u32 length; //elements of all signatures, one bit each
+    u32 words; //u64 per bit vector
+    u32 longest; //elements of the longest signature
+    u64* start; //first element of each signature
+    u64* final; //last element of each signature
+    u32* owners; //signature of each element
+    u64* positions; //elements matched by each predicate, predicate_count bit vectors
+    u64* table; //THUMB: elements matched by each halfword, 0x10000 bit vectors
+}SCANNER;
+
+typedef struct {
+    u64 address;
+    u32 signature;
+}SCANMATCH;
+
+typedef struct {
+    SCANNER* scanner;
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //start of the scanned range
+    u64 begin; //matches starting in [begin, end) belong to this job
+    u64 end;
+    u64 limit; //end of the scanned range
+    u64* cache; //ARM: code and element bit vector, direct mapped
+    SCANMATCH* matches;
+    u64 match_count;
+}SCANJOB;
+
+typedef struct {
+    u64* data;
+    u64 count;
+    u64 capacity;
+}ADDRESSLIST;
+
+typedef struct {
+    u64 start;
+    u64 end; //first byte after the function
+    DMODE mode;
+}FUNCTION;
+
+typedef struct {
+    FUNCTION* functions; //sorted by start
+    u64 count;
+    u64 other_mode; //calls to the other instruction set, not followed
+}FUNCTIONTABLE;
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //start of the range
+    u64 begin; //chunk
+    u64 end;
+    u64 limit; //end of the range
+    DMODE dmode;
+    ARMARCH arch;
+    ADDRESSLIST starts; //call targets and prologues
+    ADDRESSLIST ends; //end of epilogues
+    u64 other_mode;
+}FUNCTIONJOB;
+
+typedef enum {
+    XREF_NONE,
+    XREF_CALL, //bl, blx
+    XREF_JUMP, //b
+    XREF_LITERAL //pc-relative load
+}XREFKIND;
+
+typedef struct {
+    u32 source; //address of the instruction
+    u32 target; //address it branches to or loads from
+    u32 kind; //XREFKIND
+}XREF;
+
+typedef struct {
+    XREF* by_target; //sorted by (target, source)
+    XREF* by_source; //sorted by (source, target)
+    u64 count;
+}XREFTABLE;
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //start of the range
+    u64 begin; //chunk
+    u64 end;
+    DMODE dmode;
+    ARMARCH arch;
+    XREF* xrefs;
+    u64 count;
+    u64 capacity;
+}XREFJOB;
+
+typedef struct {
+    XREF* src;
+    XREF* dst;
+    u64 begin; //slice of src
+    u64 end;
+    u32 shift; //digit position in the key
+    int by_source;
+    u64 histogram[256];
+}RADIXJOB;
+
+typedef struct {
+    u64 hash; //what the alignment compares, see HashDiffInstruction
+    u64 address;
+    u32 code; //high halfword is 0 for a 16-bit THUMB instruction
+    u8 size;
+    u8 dmode; //DMODE
+    u8 arch; //ARMARCH
+}DIFFINST;
+
+typedef struct {
+    u64 hash;
+    u32 generation; //the slot is empty unless it matches the current one
+    u32 count_a; //occurrences in the region of each stream
+    u32 count_b;
+    u32 pos_b; //last occurrence in the region of the new stream
+}DIFFSLOT;
+
+typedef struct {
+    u32 a; //index in the old stream
+    u32 b; //index in the new stream
+}DIFFMATCH;
+
+typedef struct {
+    const DIFFINST* a; //old stream
+    const DIFFINST* b; //new stream
+    DIFFSLOT* slots; //open addressing, cleared by bumping generation
+    u32 mask;
+    u32 generation;
+    DIFFMATCH* matches; //in order of both streams
+    u32 match_count;
+}DIFF;
+
+typedef enum {
+    SERVE_CODE = 1, //u8 thumb, u8 arch (4 or 5), u32 code: a single code
+    SERVE_RANGE, //u8 thumb, u8 arch, u64 start, u32 size, then a file name or nothing for the input file: a listing
+    SERVE_XREF, //u32 address: references to and from it in the input file
+    SERVE_STOP //stop the server once answered
+}SERVEREQUEST; //first byte of a request frame
+
+typedef struct {
+    u64 offset; //in the file
+    u32 code; //as decoded, high halfword is 0 for a 16-bit THUMB line
+    u8 size; //2 or 4 bytes, 0 if the slot is empty
+    u8 mode; //1 for THUMB, plus 2 for ARMv4T
+    u8 text[STRING_LENGTH];
+}SERVELINE; //line of a served file, reused while the file holds the same code there
+
+typedef struct {
+    DARGS* dargs;
+    MAPPEDFILE files[SERVE_FILES]; //mapped on their first request, files[0] is the input file
+    u8 names[SERVE_FILES][PATH_LENGTH];
+    volatile u32 file_count;
+    volatile u32 lock; //for the files
+    XREFTABLE xrefs; //of the input file
+    SERVELINE* lines[SERVE_FILES]; //SERVE_LINES of each file, NULL until its first range request
+    volatile u32 line_locks[SERVE_FILES]; //for lines, held for a whole request
+    int socket; //listening
+    int client_fds[SERVE_CLIENTS_MAX]; //of the connected clients, -1 for a free slot, shut down when the server stops
+    volatile u32 client_lock; //for client_fds
+    volatile u32 clients; //connected, their threads read the server until they are done
+    volatile u32 busy; //requests being answered
+    volatile u32 stopping;
+}SERVER;
+
+typedef struct {
+    SERVER* server;
+    int fd;
+    u32 slot; //in client_fds
+}SERVECLIENT;
+
+typedef struct {
+    u32 pc; //address of the instruction
+    u32 hits; //samples taken there
+    u8 mode; //TRACEMODE
+    u8 cpu; //TRACECPU
+    u16 reserved; //should be zero
+}PROFILERECORD; //12 bytes, little-endian, see README.md
+
+typedef struct {
+    u64* keys; //0 marks an empty slot, see ProfileKey
+    u64* hits;
+    u32 capacity; //power of 2
+    u32 count;
+    u32 shift; //64 - log2(capacity)
+}PROFILEMAP;
+
+typedef struct {
+    u64 start; //in the input file
+    u64 end;
+    u64 hits;
+    u8 mode; //TRACEMODE
+    u8 cpu; //TRACECPU
+    u8 function; //1 if from the function table
+}PROFILEGROUP; //function or range listed by /profile
+
+typedef struct {
+    u32 code;
+    u32 size; //2 or 4 bytes, any size for data
+    u32 data; //1 for bytes listed as .word/.byte without decoding them
+    u8 text[STRING_LENGTH];
+    CYCLES cycles; //with /cycles only
+    ARMARCH arch; //of the cycle estimate
+}LISTINGLINE;
+
+typedef enum {
+    SLOT_FREE, //the reader may fill it
+    SLOT_READ, //waiting for a decoder
+    SLOT_DONE //waiting for the writer
+}SLOTSTATE;
+
+typedef struct {
+    volatile u32 state; //SLOTSTATE
+    u64 address; //of the first byte of the block
+    u32 size; //bytes of the range in the block
+    u8* data; //2 bytes before the block, the block, 4 bytes after it
+    OUTBUF text; //listing of the block, in memory
+    u32 na; //n/a instructions in the block
+    u32 instructions;
+}LISTINGSLOT;
+
+typedef struct {
+    double read; //seconds in each phase
+    double decode; //includes the text of the instruction, the decoders write it as they go
+    double format; //lines of the listing
+    double write;
+    double wall; //from start to end, the phases overlap when pipelined
+    u64 bytes_in;
+    u64 bytes_out;
+    u64 instructions;
+    u64 na;
+}LISTINGSTATS;
+
+typedef struct {
+    FILE* in;
+    FILE* out;
+    const MODERANGE* ranges; //follow each other from start to end
+    u32 range_count;
+    const FUNCTIONTABLE* ft;
+    const u8* windows; //1 for each CLASSIFY_WINDOW of the range classified as data, NULL to decode everything
+    u8 cycles; //annotate each instruction with its cycle estimate
+    u64 start; //range
+    u64 end;
+    u32 blocks; //LISTING_BLOCK bytes each, the last one can be shorter
+    LISTINGSLOT* slots; //ring, block i goes to slot i % slot_count
+    u32 slot_count;
+    volatile u32 read_count; //blocks read so far
+    volatile u32 decode_next; //next block to decode
+    volatile u32 write_count; //blocks written so far
+    volatile u32 reading; //1 while a thread is the reader
+    volatile u32 writing; //1 while a thread is the writer
+}LISTING; //pipeline of a listing: read blocks in order, decode them in any order, write them in order
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //range
+    u64 end;
+    DMODE dmode;
+    DECODERS dec;
+    const CLASSIFYTHRESHOLDS* thresholds;
+    u8* windows; //result, shared by the jobs
+    u32 first; //windows of this job
+    u32 last;
+    u32 data_windows; //classified as data
+}CLASSIFYJOB;
+
+typedef struct {
+    u64 start; //function or mode range
+    u64 end;
+    DMODE dmode;
+    u64 instructions;
+    u64 min; //cycles
+    u64 max;
+    u64 n; //ARM7TDMI memory and internal cycles, at most
+    u64 s;
+    u64 i;
+}CYCLETOTAL;
+
+typedef struct {
+    int arm; //score as ARM code, higher is more likely, 100 at best
+    int thumb; //score as THUMB code
+    u8 dmode; //DMODE picked, from this window and its neighbours
+}DETECTWINDOW;
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //range
+    u64 end;
+    DECODERS dec;
+    DETECTWINDOW* windows; //result, shared by the jobs
+    u32 first; //windows of this job
+    u32 last;
+}DETECTJOB;
+
+typedef struct {
+    u32 address; //of the I/O register
+    u32 source; //address of the instruction
+    u8 store; //1 for a write, 0 for a read
+    u8 size; //bytes, each register of an LDM/STM is a separate access
+}MMIOREF;
+
+typedef struct {
+    const u8* data; //whole file
+    u64 size; //of the whole file
+    u64 start; //start of the range
+    u64 begin; //chunk
+    u64 end;
+    u64 stop; //end of the range
+    u32 base; //address of data[0]
+    DMODE dmode;
+    ARMARCH arch;
+    MMIOREF* refs;
+    u64 count;
+    u64 capacity;
+}MMIOJOB;
+
+typedef struct {
+    u32 address;
+    const u8* name;
+}MMIONAME;
+
+typedef struct {
+    LISTING* listing;
+    LISTINGLINE* lines; //decoded block
+    LISTINGSTATS stats; //of this thread
+}LISTINGJOB;
+
+const u8* ToolNames[DTOOL_MAX] = { "DisassembleFile", "DisassembleTrace", "InstructionMix", "ScanSignatures", "ExportFunctions", "CrossReference", "DiffFiles", "Serve", "ProfileFile", "DetectModes", "MmioIndex" };
+const u8* XrefKindNames[4] = { "", "call", "jump", "literal" };
+const u8* ConditionNames[CONDITIONS_MAX] = { "eq", "ne", "cs", "cc", "mi", "pl", "vs", "vc", "hi", "ls", "ge", "lt", "gt", "le", "al", "nv" };
+const u8* TraceCpuNames[2] = { "arm9", "arm7" };
+const MMIONAME MmioNames[] = { //by address, names shared by the GBA and the DS unless marked
+    { 0x04000000, "DISPCNT" }, { 0x04000004, "DISPSTAT" }, { 0x04000006, "VCOUNT" },
+    { 0x04000008, "BG0CNT" }, { 0x0400000A, "BG1CNT" }, { 0x0400000C, "BG2CNT" }, { 0x0400000E, "BG3CNT" },
+    { 0x04000010, "BG0HOFS" }, { 0x04000012, "BG0VOFS" }, { 0x04000014, "BG1HOFS" }, { 0x04000016, "BG1VOFS" },
+    { 0x04000040, "WIN0H" }, { 0x04000044, "WIN0V" }, { 0x04000048, "WININ" }, { 0x0400004A, "WINOUT" },
+    { 0x0400004C, "MOSAIC" }, { 0x04000050, "BLDCNT" }, { 0x04000052, "BLDALPHA" }, { 0x04000054, "BLDY" },
+    { 0x040000B0, "DMA0SAD" }, { 0x040000B4, "DMA0DAD" }, { 0x040000B8, "DMA0CNT" },
+    { 0x040000BC, "DMA1SAD" }, { 0x040000C0, "DMA1DAD" }, { 0x040000C4, "DMA1CNT" },
+    { 0x040000C8, "DMA2SAD" }, { 0x040000CC, "DMA2DAD" }, { 0x040000D0, "DMA2CNT" },
+    { 0x040000D4, "DMA3SAD" }, { 0x040000D8, "DMA3DAD" }, { 0x040000DC, "DMA3CNT" },
+    { 0x04000100, "TM0CNT" }, { 0x04000104, "TM1CNT" }, { 0x04000108, "TM2CNT" }, { 0x0400010C, "TM3CNT" },
+    { 0x04000130, "KEYINPUT" }, { 0x04000132, "KEYCNT" },
+    { 0x04000180, "IPCSYNC (DS)" }, { 0x04000184, "IPCFIFOCNT (DS)" }, { 0x04000188, "IPCFIFOSEND (DS)" },
+    { 0x04000200, "IE (GBA)" }, { 0x04000202, "IF (GBA)" }, { 0x04000204, "WAITCNT/EXMEMCNT" }, { 0x04000208, "IME" },
+    { 0x04000210, "IE (DS)" }, { 0x04000214, "IF (DS)" }, { 0x04000240, "VRAMCNT (DS)" },
+    { 0x04000280, "DIVCNT (DS)" }, { 0x040002B0, "SQRTCNT (DS)" }, { 0x04000300, "POSTFLG" }, { 0x04000301, "HALTCNT" },
+    { 0x04000304, "POWCNT (DS)" }, { 0x04100000, "IPCFIFORECV (DS)" }
+};
+
+/* PLATFORM */
+
+static int SeekFile(FILE* fp, u64 offset) {
+    /* fseek from the start of the file, past 2 GiB too */
+#ifdef _WIN32
+    return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+static void* CheckedRealloc(void* p, size_t size) {
+    /* realloc that gives up on the whole program when memory runs out */
+    void* q = realloc(p, size ? size : 1);
+    if (q == NULL)
+    {
+        printf("ERROR: Out of memory. Aborting.\n");
+        exit(1);
+    }
+    return q;
+}
+
+static int MapFile(MAPPEDFILE* mf, const u8* fname) {
+    /* Map a whole file read-only into memory, return 0 on failure */
+    memset(mf, 0, sizeof(MAPPEDFILE));
+#ifdef _WIN32
+    mf->file = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (mf->file == INVALID_HANDLE_VALUE) return 0;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mf->file, &size))
+    {
+        CloseHandle(mf->file);
+        return 0;
+    }
+    mf->size = size.QuadPart;
+    if (!mf->size) return 1; //nothing to map
+    mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf->mapping) mf->data = MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (mf->data) return 1;
+    if (mf->mapping) CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+    return 0;
+#else
+    struct stat st;
+    mf->fd = open(fname, O_RDONLY);
+    if (mf->fd < 0) return 0;
+    if (fstat(mf->fd, &st))
+    {
+        close(mf->fd);
+        return 0;
+    }
+    mf->size = st.st_size;
+    if (!mf->size) return 1; //nothing to map
+    void* p = mmap(NULL, mf->size, PROT_READ, MAP_PRIVATE, mf->fd, 0);
+    if (p == MAP_FAILED)
+    {
+        close(mf->fd);
+        return 0;
+    }
+    madvise(p, mf->size, MADV_SEQUENTIAL);
+    mf->data = p;
+    return 1;
+#endif
+}
+
+static void UnmapFile(MAPPEDFILE* mf) {
+    /* Release a file mapped by MapFile */
+#ifdef _WIN32
+    if (mf->data) UnmapViewOfFile(mf->data);
+    if (mf->mapping) CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+#else
+    if (mf->data) munmap(mf->data, mf->size);
+    close(mf->fd);
+#endif
+    memset(mf, 0, sizeof(MAPPEDFILE));
+}
+
+static int WriteDecodeTables(const u8* data, u64 size, const u8* fname) {
+    /* Write a block of BuildDecodeTables under another name then rename it, a process mapping fname never sees it half written */
+    u8 path[PATH_LENGTH + 16] = { 0 };
+    if (strlen(fname) >= PATH_LENGTH) return 0;
+#ifdef _WIN32
+    sprintf(path, "%s.%lu", fname, (unsigned long)GetCurrentProcessId());
+#else
+    sprintf(path, "%s.%lu", fname, (unsigned long)getpid());
+#endif
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL) return 0;
+    int ok = fwrite(data, 1, size, fp) == size;
+    if (fclose(fp)) ok = 0;
+#ifdef _WIN32
+    if (ok) remove(fname); //rename doesn't replace a file here
+#endif
+    if (ok && rename(path, fname)) ok = 0;
+    if (!ok) remove(path);
+    return ok;
+}
+
+static int OpenDecodeTables(MAPPEDFILE* mf, const u8* fname) {
+    /* Map the decode tables of fname read-only and attach them, after writing the file if it is missing or stale */
+    /* Return 0 if decoding stays live, mf is then empty */
+    if (MapFile(mf, fname))
+    {
+        if (AttachDecodeTables(mf->data, mf->size)) return 1;
+        UnmapFile(mf);
+    }
+    u64 size = 0;
+    u8* data = BuildDecodeTables(&size);
+    if (data == NULL) return 0;
+    int ok = WriteDecodeTables(data, size, fname);
+    free(data);
+    if (!ok)
+    {
+        printf("WARNING: The file \"%s\" could not be created, decoding without tables.\n", fname);
+        return 0;
+    }
+    printf("Decode tables written to \"%s\".\n", fname);
+    if (MapFile(mf, fname))
+    {
+        if (AttachDecodeTables(mf->data, mf->size)) return 1;
+        UnmapFile(mf);
+    }
+    return 0;
+}
+
+static u32 GetCoreCount(void) {
+    /* Number of worker threads to use, one per logical core */
+    long n = 1;
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    n = si.dwNumberOfProcessors;
+#else
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (n < 1) n = 1;
+    if (n > WORKERS_MAX) n = WORKERS_MAX;
+    return (u32)n;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WorkerEntry(LPVOID p) {
+    WORKERSTART* ws = p;
+    ws->func(ws->arg);
+#ifdef DTHUMB_INSTRUMENT
+    ws->instrumentation = calloc(1, sizeof(INSTRUMENTATION));
+    if (ws->instrumentation) MergeInstrumentation(ws->instrumentation);
+#endif
+    return 0;
+}
+#else
+static void* WorkerEntry(void* p) {
+    WORKERSTART* ws = p;
+    ws->func(ws->arg);
+#ifdef DTHUMB_INSTRUMENT
+    ws->instrumentation = calloc(1, sizeof(INSTRUMENTATION));
+    if (ws->instrumentation) MergeInstrumentation(ws->instrumentation);
+#endif
+    return NULL;
+}
+#endif
+
+static void RunWorkers(WORKER func, void* args, size_t arg_size, u32 count) {
+    /* Run func on count threads at once, thread i gets the i-th element of args, return when all are done */
+    WORKERSTART ws[WORKERS_MAX];
+    u32 started[WORKERS_MAX] = { 0 };
+#ifdef _WIN32
+    HANDLE threads[WORKERS_MAX];
+#else
+    pthread_t threads[WORKERS_MAX];
+#endif
+    if (count > WORKERS_MAX) count = WORKERS_MAX;
+    for (u32 i = 1; i < count; i++) //worker 0 runs on the calling thread
+    {
+        ws[i].func = func;
+        ws[i].arg = (u8*)args + i * arg_size;
+#ifdef DTHUMB_INSTRUMENT
+        ws[i].instrumentation = NULL;
+#endif
+#ifdef _WIN32
+        threads[i] = CreateThread(NULL, 0, WorkerEntry, &ws[i], 0, NULL);
+        started[i] = threads[i] != NULL;
+#else
+        started[i] = !pthread_create(&threads[i], NULL, WorkerEntry, &ws[i]);
+#endif
+        if (!started[i]) func(ws[i].arg); //could not create a thread, do it here instead
+    }
+    if (count) func(args);
+    for (u32 i = 1; i < count; i++)
+    {
+        if (!started[i]) continue;
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+#ifdef DTHUMB_INSTRUMENT
+        if (ws[i].instrumentation) AddInstrumentation(&dthumb_instrumentation, ws[i].instrumentation); //into the calling thread's
+        free(ws[i].instrumentation);
+#endif
+    }
+}
+
+static double GetTime(void) {
+    /* Wall clock time in seconds, from a monotonic clock */
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static u32 AtomicLoad(volatile u32* p) {
+    /* Read, later reads can't move before it */
+#ifdef _WIN32
+    return (u32)InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static void AtomicStore(volatile u32* p, u32 v) {
+    /* Write, earlier writes can't move after it */
+#ifdef _WIN32
+    InterlockedExchange((volatile LONG*)p, (LONG)v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#endif
+}
+
+static int AtomicCompareExchange(volatile u32* p, u32 expected, u32 desired) {
+    /* *p = desired if *p == expected, return 1 if it was */
+#ifdef _WIN32
+    return (u32)InterlockedCompareExchange((volatile LONG*)p, (LONG)desired, (LONG)expected) == expected;
+#else
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static u32 AtomicAdd(volatile u32* p, u32 v) {
+    /* *p += v, return the new value */
+    u32 old;
+    do old = AtomicLoad(p);
+    while (!AtomicCompareExchange(p, old, old + v));
+    return old + v;
+}
+
+static void Backoff(u32* spins) {
+    /* Wait a little longer each time nothing could be done */
+    if (++*spins < 64) return;
+#ifdef _WIN32
+    if (*spins < 256) SwitchToThread();
+    else Sleep(1);
+#else
+    if (*spins < 256) sched_yield();
+    else usleep(1000);
+#endif
+}
+
+static void SetBinaryMode(FILE* fp) {
+    /* No newline translation, for files opened in text mode */
+#ifdef _WIN32
+    _setmode(_fileno(fp), _O_BINARY);
+#else
+    (void)fp;
+#endif
+}
+
+/* BUFFERED OUTPUT */
+
+static void OutBufInit(OUTBUF* ob, FILE* fp, size_t capacity) {
+    /* Text is written to fp every time the buffer is full, or kept in memory (growing) if fp is NULL */
+    ob->fp = fp;
+    ob->data = CheckedRealloc(NULL, capacity);
+    ob->size = 0;
+    ob->capacity = capacity;
+}
+
+static void OutBufFlush(OUTBUF* ob) {
+    /* Write the buffered text to the file, no effect on memory buffers */
+    if (!ob->fp || !ob->size) return;
+    fwrite(ob->data, 1, ob->size, ob->fp);
+    ob->size = 0;
+}
+
+static u8* OutBufReserve(OUTBUF* ob, size_t n) {
+    /* Make room for n more bytes, return where to write them */
+    if (ob->size + n > ob->capacity)
+    {
+        OutBufFlush(ob);
+        if (ob->size + n > ob->capacity)
+        {
+            while (ob->size + n > ob->capacity) ob->capacity *= 2;
+            ob->data = CheckedRealloc(ob->data, ob->capacity);
+        }
+    }
+    return &ob->data[ob->size];
+}
+
+static void OutBufWrite(OUTBUF* ob, const void* src, size_t n) {
+    /* Append n bytes */
+    memcpy(OutBufReserve(ob, n), src, n);
+    ob->size += n;
+}
+
+static void OutBufPrintf(OUTBUF* ob, const char* fmt, ...) {
+    /* Append formatted text */
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(OutBufReserve(ob, STRING_LENGTH * 2), STRING_LENGTH * 2, fmt, args);
+    va_end(args);
+    if (n >= STRING_LENGTH * 2) //didn't fit, try again with the right size
+    {
+        va_start(args, fmt);
+        vsnprintf(OutBufReserve(ob, n + 1), n + 1, fmt, args);
+        va_end(args);
+    }
+    if (n > 0) ob->size += n;
+}
+
+static void OutBufFree(OUTBUF* ob) {
+    /* Flush and release */
+    OutBufFlush(ob);
+    free(ob->data);
+    memset(ob, 0, sizeof(OUTBUF));
+}
+
+static void WriteHex32(u8* dst, u32 v) {
+    /* Write v as 8 uppercase hex digits, no null terminator */
+    static const u8 digits[16] = "0123456789ABCDEF";
+    for (int i = 7; i >= 0; i--)
+    {
+        dst[i] = digits[v & 0xf];
+        v >>= 4;
+    }
+}
+
+static void WriteHex64(u8* dst, u64 v) {
+    /* Write v as 16 uppercase hex digits, no null terminator: all the nibbles at once with SSE2 */
+#ifdef DTHUMB_SSE2
+#ifdef _MSC_VER
+    u64 be = _byteswap_uint64(v);
+#else
+    u64 be = __builtin_bswap64(v);
+#endif
+    __m128i x = _mm_loadl_epi64((const __m128i*)&be); //most significant byte first
+    __m128i mask = _mm_set1_epi8(0x0f);
+    __m128i n = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(x, 4), mask), _mm_and_si128(x, mask)); //high then low nibble of each byte
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(n, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '0' - 10));
+    _mm_storeu_si128((__m128i*)dst, _mm_add_epi8(_mm_add_epi8(n, _mm_set1_epi8('0')), letters));
+#else
+    WriteHex32(dst, (u32)(v >> 32));
+    WriteHex32(&dst[8], (u32)v);
+#endif
+}
+
+static void WriteListingLine(OUTBUF* out, u64 address, u32 code, u32 size, const u8* text) {
+    /* "%08llX: %08X %s\n", or "%08llX: %04X     %s\n" for 16 bits, without going through printf */
+    if (address >> 32) //more than 8 digits
+    {
+        if (size == 4) OutBufPrintf(out, "%08llX: %08X %s\n", address, code, text);
+        else OutBufPrintf(out, "%08llX: %04X     %s\n", address, code & 0xffff, text);
+        return;
+    }
+    u8 hex[16];
+    WriteHex64(hex, (address << 32) | code); //both columns
+    size_t len = strlen(text);
+    u8* p = OutBufReserve(out, 20 + len);
+    memcpy(p, hex, 8);
+    memcpy(&p[8], ": ", 2);
+    if (size == 4) memcpy(&p[10], &hex[8], 8), p[18] = ' ';
+    else memcpy(&p[10], &hex[12], 4), memcpy(&p[14], "     ", 5);
+    memcpy(&p[19], text, len);
+    p[19 + len] = '\n';
+    out->size += 20 + len;
+}
+
+static u64 GetFileSize_mine(FILE* fp) {
+    /* Return the size of an opened file, past 2 GiB too */
+#ifdef _WIN32
+    _fseeki64(fp, 0, SEEK_END);
+    u64 size = (u64)_ftelli64(fp);
+#else
+    fseeko(fp, 0, SEEK_END);
+    u64 size = (u64)ftello(fp);
+#endif
+    rewind(fp);
+    return size;
+}
+
+static void DisassembleSingle(DARGS* dargs) {
+    /* Disassemble a single code and prints it to stdout */
+    u8 str[STRING_LENGTH] = { 0 };
+    if (dargs->dmode == DARM)
+    {
+        Disassemble_arm(dargs->code, str, dargs->arch);
+        printf("%08X %s\n", dargs->code, str);
+    }
+    else
+    {
+        if (Disassemble_thumb(dargs->code, str, dargs->arch) == SIZE_32) //32-bit
+        {
+            printf("%08X %s\n", dargs->code, str);
+        }
+        else //16-bit
+        {
+            printf("%04X     %s\n", dargs->code & 0xffff, str);
+        }
+    }
+}
+
+static void DecodeCacheInit(DECODECACHE* dc) {
+    /* Empty cache, grows as needed */
+    dc->capacity = 1 << 12;
+    dc->shift = 64 - 12;
+    dc->count = 0;
+    dc->keys = CheckedRealloc(NULL, dc->capacity * sizeof(u64));
+    dc->values = CheckedRealloc(NULL, dc->capacity * sizeof(u32));
+    memset(dc->keys, 0, dc->capacity * sizeof(u64));
+    OutBufInit(&dc->pool, NULL, 1 << 16);
+}
+
+static void DecodeCacheFree(DECODECACHE* dc) {
+    free(dc->keys);
+    free(dc->values);
+    OutBufFree(&dc->pool);
+}
+
+static void DecodeCacheGrow(DECODECACHE* dc) {
+    /* Double the capacity and rehash */
+    u64* keys = dc->keys;
+    u32* values = dc->values;
+    u32 capacity = dc->capacity;
+    dc->capacity *= 2;
+    dc->shift--;
+    dc->keys = CheckedRealloc(NULL, dc->capacity * sizeof(u64));
+    dc->values = CheckedRealloc(NULL, dc->capacity * sizeof(u32));
+    memset(dc->keys, 0, dc->capacity * sizeof(u64));
+    for (u32 i = 0; i < capacity; i++)
+    {
+        if (!keys[i]) continue;
+        u32 slot = (u32)((keys[i] * 0x9E3779B97F4A7C15ULL) >> dc->shift);
+        while (dc->keys[slot]) slot = (slot + 1) & (dc->capacity - 1);
+        dc->keys[slot] = keys[i];
+        dc->values[slot] = values[i];
+    }
+    free(keys);
+    free(values);
+}
+
+static int CompareDecodeKeys(const void* a, const void* b) {
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static const u8* DecodeCacheGet(DECODECACHE* dc, const TRACERECORD* r, u32* na) {
+    /* Formatted code and disassembly of a trace record, each distinct (opcode, mode, cpu) is only decoded once */
+    u32 code = r->opcode;
+    if (r->mode == TRACE_THUMB && (code & 0xf800) != 0xf000) code &= 0xffff; //the high halfword only matters after a BL/BLX prefix
+    u64 key = code | ((u64)(r->mode & 1) << 32) | ((u64)(r->cpu & 1) << 33) | (1ULL << 34); //bit 34 so that no key is 0
+    u32 slot = (u32)((key * 0x9E3779B97F4A7C15ULL) >> dc->shift);
+    while (dc->keys[slot])
+    {
+        if (dc->keys[slot] == key)
+        {
+            *na = dc->values[slot] >> 31;
+            return &dc->pool.data[dc->values[slot] & 0x7fffffff];
+        }
+        slot = (slot + 1) & (dc->capacity - 1);
+    }
+
+    /* Miss, decode */
+    u8 str[STRING_LENGTH] = { 0 };
+    ARMARCH arch = (r->cpu == TRACE_ARM7) ? ARMv4T : ARMv5TE;
+    u32 na_before = debug_na_count;
+    u32 offset = (u32)dc->pool.size;
+    if (r->mode == TRACE_THUMB)
+    {
+        if (Disassemble_thumb(code, str, arch) == SIZE_32) OutBufPrintf(&dc->pool, "%08X %s", code, str);
+        else OutBufPrintf(&dc->pool, "%04X     %s", code & 0xffff, str);
+    }
+    else
+    {
+        Disassemble_arm(code, str, arch);
+        OutBufPrintf(&dc->pool, "%08X %s", code, str);
+    }
+    OutBufWrite(&dc->pool, "", 1); //null terminator
+    *na = debug_na_count != na_before;
+
+    dc->keys[slot] = key;
+    dc->values[slot] = offset | (*na << 31);
+    if (++dc->count * 2 > dc->capacity) DecodeCacheGrow(dc);
+    return &dc->pool.data[offset];
+}
+
+static int TraceRecordsEqual(const TRACERECORD* a, const TRACERECORD* b, size_t n) {
+    /* Compare two runs of n records, ignoring the reserved field */
+    for (size_t i = 0; i < n; i++)
+    {
+        if (a[i].pc != b[i].pc || a[i].opcode != b[i].opcode || a[i].mode != b[i].mode || a[i].cpu != b[i].cpu) return 0;
+    }
+    return 1;
+}
+
+static size_t FindTraceLoop(const TRACERECORD* r, size_t i, size_t end, u32* repeat) {
+    /* Find the shortest run of records starting at i that is repeated right after itself, return its length */
+    for (size_t len = 1; len <= TRACE_LOOP_MAX && i + 2 * len <= end; len++)
+    {
+        if (r[i + len].pc != r[i].pc) continue; //fast reject
+        if (!TraceRecordsEqual(&r[i], &r[i + len], len)) continue;
+        u32 n = 2;
+        while (i + (n + 1) * len <= end && TraceRecordsEqual(&r[i], &r[i + n * len], len)) n++;
+        *repeat = n;
+        return len;
+    }
+    *repeat = 1;
+    return 1;
+}
+
+static void WriteTraceRecord(TRACEJOB* job, const TRACERECORD* r) {
+    /* One listing line: cpu, address, code and disassembly */
+    u32 na = 0;
+    const u8* text = DecodeCacheGet(&job->cache, r, &na);
+    size_t len = strlen(text);
+    u8* dst = OutBufReserve(&job->text, len + 16);
+    memcpy(dst, TraceCpuNames[r->cpu & 1], 4);
+    dst[4] = ' ';
+    WriteHex32(&dst[5], r->pc);
+    dst[13] = ':';
+    dst[14] = ' ';
+    memcpy(&dst[15], text, len);
+    dst[15 + len] = '\n';
+    job->text.size += len + 16;
+    job->na_count += na;
+}
+
+static void TraceWorker(void* arg) {
+    /* Format the records of a chunk, folding back to back repetitions of the same run of records */
+    TRACEJOB* job = arg;
+    const TRACERECORD* r = job->records;
+    size_t i = job->begin;
+    while (i < job->end)
+    {
+        u32 repeat = 1;
+        size_t len = FindTraceLoop(r, i, job->count, &repeat);
+        if (repeat > 1)
+        {
+            OutBufPrintf(&job->text, "loop x%u (%u instructions):\n", repeat, (u32)len);
+            job->loops++;
+        }
+        for (size_t j = 0; j < len; j++) WriteTraceRecord(job, &r[i + j]);
+        for (u32 k = 1; k < repeat; k++) //repetitions aren't printed but still count
+        {
+            for (size_t j = 0; j < len; j++)
+            {
+                u32 na = 0;
+                DecodeCacheGet(&job->cache, &r[i + j], &na);
+                job->na_count += na;
+            }
+        }
+        i += len * repeat;
+    }
+    job->stop = i;
+}
+
+static int DisassembleTrace(DARGS* dargs, FILE* out) {
+    /* Disassemble an emulator trace file (array of TRACERECORD), print to another file */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    const TRACERECORD* records = (const TRACERECORD*)mf.data;
+    size_t count = (size_t)(mf.size / sizeof(TRACERECORD));
+
+    u32 workers = GetCoreCount();
+    TRACEJOB* jobs = CheckedRealloc(NULL, workers * sizeof(TRACEJOB));
+    memset(jobs, 0, workers * sizeof(TRACEJOB));
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].records = records;
+        jobs[i].count = count;
+        DecodeCacheInit(&jobs[i].cache);
+        OutBufInit(&jobs[i].text, NULL, OUTBUF_SIZE);
+    }
+
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    OutBufPrintf(&ob, "Trace of %llu instructions:\n\n", (u64)count);
+
+    /* Rounds of one chunk per worker, written in order so that memory use stays bounded */
+    size_t pos = 0;
+    while (pos < count)
+    {
+        u32 active = 0;
+        for (; active < workers && pos < count; active++)
+        {
+            jobs[active].begin = pos;
+            pos = (count - pos > TRACE_CHUNK) ? pos + TRACE_CHUNK : count;
+            jobs[active].end = pos;
+        }
+        u64 na_counts[WORKERS_MAX];
+        u64 loops[WORKERS_MAX];
+        for (u32 i = 0; i < active; i++)
+        {
+            na_counts[i] = jobs[i].na_count;
+            loops[i] = jobs[i].loops;
+        }
+        RunWorkers(TraceWorker, jobs, sizeof(TRACEJOB), active);
+        for (u32 i = 0; i < active; i++)
+        {
+            size_t previous = i ? jobs[i - 1].stop : jobs[0].begin;
+            if (previous != jobs[i].begin) //the previous chunk ended in a loop that went on into this one, format it again after that loop
+            {
+                jobs[i].text.size = 0;
+                jobs[i].na_count = na_counts[i];
+                jobs[i].loops = loops[i];
+                jobs[i].begin = previous;
+                jobs[i].stop = previous;
+                if (previous < jobs[i].end) TraceWorker(&jobs[i]);
+            }
+            OutBufWrite(&ob, jobs[i].text.data, jobs[i].text.size);
+            jobs[i].text.size = 0;
+        }
+        pos = jobs[active - 1].stop;
+    }
+
+    u64 na_count = 0;
+    u64 loops = 0;
+    u64 decoded = 0;
+    for (u32 i = 0; i < workers; i++) decoded += jobs[i].cache.count;
+    u64* keys = CheckedRealloc(NULL, decoded * sizeof(u64));
+    u64 n = 0;
+    for (u32 i = 0; i < workers; i++)
+    {
+        na_count += jobs[i].na_count;
+        loops += jobs[i].loops;
+        for (u32 k = 0; k < jobs[i].cache.capacity; k++)
+        {
+            if (jobs[i].cache.keys[k]) keys[n++] = jobs[i].cache.keys[k];
+        }
+        DecodeCacheFree(&jobs[i].cache);
+        OutBufFree(&jobs[i].text);
+    }
+    qsort(keys, n, sizeof(u64), CompareDecodeKeys);
+    u64 distinct = 0;
+    for (u64 k = 0; k < n; k++) distinct += (k == 0 || keys[k] != keys[k - 1]);
+    free(keys);
+    OutBufPrintf(&ob, "\n%llu loops folded, %llu distinct codes, %llu decoded (per worker, summed).", loops, distinct, decoded); //grows with the core count
+    OutBufPrintf(&ob, "\n%llu unknown instructions.", na_count);
+    OutBufFree(&ob);
+    free(jobs);
+    UnmapFile(&mf);
+    return 1; //success
+}
+
+static int ResolveFileRange(DARGS* dargs, u64 size, u64* start, u64* end) {
+    /* Same rules as DisassembleFile: fail if out of range, end of file if no end */
+    if (dargs->frange.start > size || dargs->frange.end > size) return 0; //out of range
+    *start = dargs->frange.start;
+    *end = dargs->frange.end ? dargs->frange.end : size;
+    return 1;
+}
+
+static int CheckRange32(u64 base, u64 end, const u8* option) {
+    /* Tools that store 32-bit addresses refuse ranges ending past 4 GiB rather than truncate them */
+    if (base <= 0xFFFFFFFFULL && end <= 0xFFFFFFFFULL - base) return 1;
+    printf("ERROR: %s stores 32-bit addresses, the range must end below 4 GiB.\n", option);
+    return 0;
+}
+
+static u32 ReadCode(const u8* data, u64 size, u64 i) {
+    /* Read 32 bits at data[i], zero past the end of the data like a short fread */
+    u32 code = 0;
+    if (size - i >= 4) memcpy(&code, &data[i], 4); //fast path, a single load
+    else memcpy(&code, &data[i], (size_t)(size - i));
+    return code;
+}
+
+static int IsThumbSuffix(const u8* data, u64 size, u64 start, u64 i, ARMARCH arch) {
+    /* Check if the halfword at i is the second half of a BL/BLX that begins at i - 2 */
+    /* A BL/BLX prefix can't be the second half of another pair, so there is no need to look further back */
+    DINST di;
+    if (i < start + 2) return 0;
+    return Decode_thumb(ReadCode(data, size, i - 2), &di, arch) == SIZE_32;
+}
+
+static u32 SplitRange(u64 start, u64 end, u32 align, u32 parts, u64* bounds) {
+    /* Split [start, end) into at most parts aligned chunks, bounds gets parts + 1 values, return the number of chunks */
+    u64 len = end - start;
+    u64 chunk = (len + parts - 1) / parts;
+    chunk = (chunk + align - 1) / align * align;
+    if (chunk < align) chunk = align;
+    u32 n = 0;
+    bounds[0] = start;
+    while (bounds[n] < end && n < parts)
+    {
+        bounds[n + 1] = (end - bounds[n] > chunk) ? bounds[n] + chunk : end;
+        n++;
+    }
+    return n;
+}
+
+static void CountInstructions(MIXCOUNTS* mc, const DINST* di, u64 n) {
+    /* Add n times the same instruction to the statistics */
+    mc->total += n;
+    mc->mnemonics[di->mnemonic] += n;
+    mc->classes[di->iclass] += n;
+    mc->conditions[di->cond] += n;
+    mc->forms[di->form] += n;
+    if (di->iclass == IC_MULTIPLE) mc->reglists[CountRegisters(di->reglist)] += n;
+}
+
+static u32 MixFieldState(u32 r) {
+    /* 0 for register field 0, 1 for 15, 2 for any other */
+    return (r == 0) ? 0 : (r == 15) ? 1 : 2;
+}
+
+static u32 MixKeyArm(u32 c) {
+    /* The bits of an ARM code that Decode_arm looks at for its mnemonic and form: NV, bits 27-20 and 7-4, */
+    /* and for data processing, miscellaneous and PLD codes, whether the other register fields are 0 or 15 (and bit 12 for LDRD) */
+    u32 nv = (c >> 28) == NV;
+    u32 key = nv << 12 | BITS(c, 20, 8) << 4 | BITS(c, 4, 4);
+    if (BITS(c, 26, 2) && !nv) return key; //load/store, LDM/STM, branches, coprocessor: the other fields don't matter
+    u32 r12 = BITS(c, 12, 4);
+    u32 s12 = (r12 == 0 || r12 == 15) ? MixFieldState(r12) : 2 + (r12 & 1);
+    u32 fields = MixFieldState(BITS(c, 8, 4)) | s12 << 2 | MixFieldState(BITS(c, 16, 4)) << 4 | !BITS(c, 0, 4) << 6;
+    return key | fields << 13;
+}
+
+static u32 MixCodeArm(u32 key) {
+    /* A code with that MixKeyArm key: AL or NV, and register fields of 0, 15 or another value as the key says */
+    static const u8 values[4] = { 0, 15, 2, 1 }; //by state, 2 and 1 for the even and odd bit 12
+    u32 cond = (key >> 12 & 1) ? NV : AL;
+    u32 r8 = values[key >> 13 & 3];
+    u32 r12 = values[key >> 15 & 3];
+    u32 r16 = values[key >> 17 & 3];
+    u32 r0 = !(key >> 19 & 1);
+    return cond << 28 | (key >> 4 & 0xff) << 20 | r16 << 16 | r12 << 12 | r8 << 8 | (key & 0xf) << 4 | r0;
+}
+
+static void MixWorker(void* arg) {
+    /* Decode a chunk without formatting anything, count into the job's own counters */
+    MIXJOB* job = arg;
+    DINST di;
+    DECODERS dec;
+    SelectDecoders(&dec, job->arch);
+    if (job->dmode == DARM)
+    {
+        /* Count each MixKeyArm key, then decode one code of each key seen, like the THUMB histogram */
+        /* The condition and the LDM/STM register list don't depend on the key, they are counted on the spot */
+        u32* histogram = CheckedRealloc(NULL, MIX_ARM_KEYS * sizeof(u32));
+        memset(histogram, 0, MIX_ARM_KEYS * sizeof(u32));
+        u64 i = job->begin;
+        while (i + 4 <= job->end)
+        {
+            u64 stop = (job->end - i > MIX_ARM_BLOCK) ? i + MIX_ARM_BLOCK : job->end; //no key can reach 2^32 within a block
+            for (; i + 4 <= stop; i += 4)
+            {
+                u32 code = ReadCode(job->data, job->size, i);
+                histogram[MixKeyArm(code)]++;
+                job->counts.conditions[code >> 28]++;
+                if (BITS(code, 25, 3) == 4 && (code >> 28) != NV) job->counts.reglists[CountRegisters(code & 0xffff)]++; //LDM, STM
+            }
+            for (u32 k = 0; k < MIX_ARM_KEYS; k++)
+            {
+                if (!histogram[k]) continue;
+                dec.decode_arm(MixCodeArm(k), &di);
+                job->counts.total += histogram[k];
+                job->counts.mnemonics[di.mnemonic] += histogram[k];
+                job->counts.classes[di.iclass] += histogram[k];
+                job->counts.forms[di.form] += histogram[k];
+                histogram[k] = 0;
+            }
+        }
+        free(histogram);
+    }
+    else //DTHUMB
+    {
+        /* Count each halfword, then decode each distinct one once, only BL/BLX pairs are decoded on the spot */
+        u64* histogram = CheckedRealloc(NULL, 0x10000 * sizeof(u64));
+        memset(histogram, 0, 0x10000 * sizeof(u64));
+        u64 i = job->begin;
+        if (IsThumbSuffix(job->data, job->size, job->start, i, job->arch)) i += 2; //already counted by the previous chunk
+        while (i + 2 <= job->end)
+        {
+            u16 c = 0;
+            memcpy(&c, &job->data[i], 2);
+            if ((c & 0xf800) == 0xf000) //BL/BLX prefix, the next halfword matters
+            {
+                dec.decode_thumb(ReadCode(job->data, job->size, i), &di);
+                CountInstructions(&job->counts, &di, 1);
+                i += di.size;
+                continue;
+            }
+            histogram[c]++;
+            i += 2;
+        }
+        for (u32 c = 0; c < 0x10000; c++)
+        {
+            if (!histogram[c]) continue;
+            dec.decode_thumb(c, &di);
+            CountInstructions(&job->counts, &di, histogram[c]);
+        }
+        free(histogram);
+    }
+}
+
+static void MergeMixCounts(MIXCOUNTS* dst, const MIXCOUNTS* src) {
+    /* dst += src, all counters are u64 */
+    u64* d = (u64*)dst;
+    const u64* s = (const u64*)src;
+    for (size_t i = 0; i < sizeof(MIXCOUNTS) / sizeof(u64); i++) d[i] += s[i];
+}
+
+static int CompareSortEntries(const void* a, const void* b) {
+    /* Descending count, then ascending index */
+    const SORTENTRY* x = a;
+    const SORTENTRY* y = b;
+    if (x->count != y->count) return (x->count < y->count) ? 1 : -1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static void PrintMixSection(OUTBUF* ob, const u8* section, const u8** names, const u64* counts, u32 n, u64 total, int csv, int sort) {
+    /* One table (or CSV lines) of counters, empty rows are skipped */
+    SORTENTRY entries[MN_MAX];
+    for (u32 i = 0; i < n; i++)
+    {
+        entries[i].count = counts[i];
+        entries[i].index = i;
+    }
+    if (sort) qsort(entries, n, sizeof(SORTENTRY), CompareSortEntries);
+    if (!csv) OutBufPrintf(ob, "\n%-16s %16s %8s\n", section, "count", "percent");
+    for (u32 i = 0; i < n; i++)
+    {
+        if (!entries[i].count) continue;
+        double percent = total ? 100.0 * (double)entries[i].count / (double)total : 0.0;
+        if (csv) OutBufPrintf(ob, "%s,%s,%llu,%.4f\n", section, names[entries[i].index], entries[i].count, percent);
+        else OutBufPrintf(ob, "%-16s %16llu %7.3f%%\n", names[entries[i].index], entries[i].count, percent);
+    }
+}
+
+static int InstructionMix(DARGS* dargs, FILE* out) {
+    /* Count instructions by mnemonic, class, condition, form and register list size, print a table or CSV */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    u64 start = 0;
+    u64 end = 0;
+    if (!ResolveFileRange(dargs, mf.size, &start, &end))
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+
+    u64 bounds[WORKERS_MAX + 1];
+    u32 workers = SplitRange(start, end, (dargs->dmode == DARM) ? 4 : 2, GetCoreCount(), bounds);
+    MIXJOB* jobs = CheckedRealloc(NULL, (workers ? workers : 1) * sizeof(MIXJOB));
+    memset(jobs, 0, (workers ? workers : 1) * sizeof(MIXJOB));
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = mf.data;
+        jobs[i].size = mf.size;
+        jobs[i].start = start;
+        jobs[i].begin = bounds[i];
+        jobs[i].end = bounds[i + 1];
+        jobs[i].dmode = dargs->dmode;
+        jobs[i].arch = dargs->arch;
+    }
+    double t0 = GetTime();
+    RunWorkers(MixWorker, jobs, sizeof(MIXJOB), workers);
+    double seconds = GetTime() - t0;
+
+    MIXCOUNTS mc = { 0 };
+    for (u32 i = 0; i < workers; i++) MergeMixCounts(&mc, &jobs[i].counts);
+    free(jobs);
+    UnmapFile(&mf);
+
+    /* Row names */
+    const u8* mnemonics[MN_MAX];
+    const u8* classes[IC_MAX];
+    const u8* forms[FORM_MAX];
+    const u8* reglists[17];
+    u8 reglist_names[17][4];
+    for (u32 i = 0; i < MN_MAX; i++) mnemonics[i] = Mnemonics[i];
+    for (u32 i = 0; i < IC_MAX; i++) classes[i] = InstructionClasses[i];
+    for (u32 i = 0; i < FORM_MAX; i++) forms[i] = Forms[i];
+    for (u32 i = 0; i < 17; i++)
+    {
+        sprintf(reglist_names[i], "%u", i);
+        reglists[i] = reglist_names[i];
+    }
+
+    int csv = dargs->tool_value && !strcmp(dargs->tool_value, "csv");
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    if (csv)
+    {
+        OutBufPrintf(&ob, "section,name,count,percent\n");
+    }
+    else
+    {
+        double rate = seconds > 0.0 ? (double)mc.total / seconds : 0.0;
+        OutBufPrintf(&ob, "Instruction mix of %llu instructions (%llu bytes), decoded in %.3f s (%.1f M instructions/s).\n", mc.total, end - start, seconds, rate * 1e-6);
+    }
+    PrintMixSection(&ob, "class", classes, mc.classes, IC_MAX, mc.total, csv, 1);
+    PrintMixSection(&ob, "mnemonic", mnemonics, mc.mnemonics, MN_MAX, mc.total, csv, 1);
+    PrintMixSection(&ob, "condition", ConditionNames, mc.conditions, CONDITIONS_MAX, mc.total, csv, 0);
+    PrintMixSection(&ob, "form", forms, mc.forms, FORM_MAX, mc.total, csv, 1);
+    PrintMixSection(&ob, "reglist", reglists, mc.reglists, 17, mc.classes[IC_MULTIPLE], csv, 0);
+    if (!csv) OutBufPrintf(&ob, "\n%llu unknown instructions.", mc.mnemonics[MN_NA]);
+    OutBufFree(&ob);
+    return 1; //success
+}
+
+static u32 NormalizeTemplate(u8* dst, const u8* src, u32 size) {
+    /* Lower case, one space between the mnemonic and the operands and no other space, return the length */
+    u32 len = 0;
+    u32 spaces = 0; //0: in mnemonic, 1: space pending, 2: in operands
+    while (*src == ' ' || *src == '\t') src++;
+    for (; *src && len < size - 1; src++)
+    {
+        u8 ch = *src;
+        if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+        {
+            if (!spaces) spaces = 1;
+            continue;
+        }
+        if (spaces == 1)
+        {
+            dst[len++] = ' ';
+            spaces = 2;
+            if (len >= size - 1) break;
+        }
+        dst[len++] = (ch >= 'A' && ch <= 'Z') ? ch + 'a' - 'A' : ch;
+    }
+    dst[len] = 0;
+    return len;
+}
+
+static int IsWordChar(u8 ch) {
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+static int MatchTemplate(const u8* t, const u8* s) {
+    /* Match normalized text s against template t: ? is one or more letters or digits, * is anything */
+    while (*t)
+    {
+        if (*t == '*')
+        {
+            t++;
+            for (;; s++)
+            {
+                if (MatchTemplate(t, s)) return 1;
+                if (!*s) return 0;
+            }
+        }
+        if (*t == '?')
+        {
+            t++;
+            if (!IsWordChar(*s)) return 0;
+            for (s++;; s++)
+            {
+                if (MatchTemplate(t, s)) return 1;
+                if (!IsWordChar(*s)) return 0;
+            }
+        }
+        if (*t != *s) return 0;
+        t++;
+        s++;
+    }
+    return !*s;
+}
+
+static u32 MnemonicPrefixLength(u32 mnemonic) {
+    /* Characters of Mnemonics[mnemonic] that are always at the start of the text, "smlaxy" prints as "smlabb" */
+    const u8* name = Mnemonics[mnemonic];
+    u32 len = (u32)strlen(name);
+    if (len > 2 && name[len - 2] == 'x' && name[len - 1] == 'y') return len - 2;
+    if (len > 1 && name[len - 1] == 'y') return len - 1;
+    return len;
+}
+
+static int ParseMaskedCode(PREDICATE* p, const u8* e, DMODE dmode) {
+    /* Hexadecimal code with ? for any nibble: 4 digits for a THUMB halfword, 8 digits for an ARM code or a THUMB pair */
+    u32 len = (u32)strlen(e);
+    if (len != 8 && !(len == 4 && dmode == DTHUMB)) return 0;
+    p->mask = 0;
+    p->value = 0;
+    for (u32 i = 0; i < len; i++)
+    {
+        u8 ch = e[i];
+        u32 nibble = 0;
+        u32 known = 0xf;
+        if (ch >= '0' && ch <= '9') nibble = ch - '0';
+        else if (ch >= 'a' && ch <= 'f') nibble = ch - 'a' + 10;
+        else if (ch >= 'A' && ch <= 'F') nibble = ch - 'A' + 10;
+        else if (ch == '?') known = 0;
+        else return 0;
+        p->mask = (p->mask << 4) | known;
+        p->value = (p->value << 4) | nibble;
+    }
+    if (len == 4) p->mask |= 0xffff0000; //a halfword never matches a BL/BLX pair
+    p->kind = PREDICATE_CODE;
+    return 1;
+}
+
+static u32 AddPredicate(SCANNER* sc, PREDICATE* p) {
+    /* Return the index of an identical predicate, or add it */
+    for (u32 i = 0; i < sc->predicate_count; i++)
+    {
+        PREDICATE* q = &sc->predicates[i];
+        if (q->kind != p->kind) continue;
+        if (p->kind == PREDICATE_ANY) return i;
+        if (p->kind == PREDICATE_CODE && q->mask == p->mask && q->value == p->value) return i;
+        if (p->kind == PREDICATE_TEXT && !strcmp(q->text, p->text)) return i;
+    }
+    sc->predicates = CheckedRealloc(sc->predicates, (sc->predicate_count + 1) * sizeof(PREDICATE));
+    sc->predicates[sc->predicate_count] = *p;
+    return sc->predicate_count++;
+}
+
+static int LoadScanner(SCANNER* sc, const u8* fname, DMODE dmode, ARMARCH arch) {
+    /* Read a signature file and compile it into a single automaton, return 0 on failure */
+    //Line format: <name>: <element>; <element>; ...
+    //Element: masked code (E92D4???), template (ldr r?, [pc, #?]) or * for any instruction
+    //Empty lines and lines starting with # are ignored
+    memset(sc, 0, sizeof(SCANNER));
+    sc->dmode = dmode;
+    sc->arch = arch;
+    FILE* fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("ERROR: The signature file \"%s\" doesn't exist.\n", fname);
+        return 0;
+    }
+
+    /* First pass: predicates and signatures, positions are numbered in file order */
+    u32* element_predicates = NULL;
+    u8 line[SCAN_LINE_LENGTH];
+    while (fgets(line, sizeof(line), fp))
+    {
+        u8* name = line;
+        while (*name == ' ' || *name == '\t') name++;
+        if (!*name || *name == '#' || *name == '\r' || *name == '\n') continue;
+        u8* body = strchr(name, ':');
+        if (body == NULL) continue;
+        *body++ = 0;
+
+        SIGNATURE sig = { 0 };
+        NormalizeTemplate(sig.name, name, sizeof(sig.name));
+        sig.first = sc->length;
+        for (u8* e = strtok(body, ";"); e; e = strtok(NULL, ";"))
+        {
+            PREDICATE p = { 0 };
+            if (!NormalizeTemplate(p.text, e, STRING_LENGTH)) continue;
+            if (!strcmp(p.text, "*")) p.kind = PREDICATE_ANY;
+            else if (!ParseMaskedCode(&p, p.text, dmode)) p.kind = PREDICATE_TEXT;
+            element_predicates = CheckedRealloc(element_predicates, (sc->length + 1) * sizeof(u32));
+            element_predicates[sc->length++] = AddPredicate(sc, &p);
+            sig.length++;
+        }
+        if (!sig.length) continue;
+        if (sig.length > sc->longest) sc->longest = sig.length;
+        sc->signatures = CheckedRealloc(sc->signatures, (sc->signature_count + 1) * sizeof(SIGNATURE));
+        sc->signatures[sc->signature_count++] = sig;
+    }
+    fclose(fp);
+    if (!sc->length)
+    {
+        printf("ERROR: No signature in \"%s\".\n", fname);
+        free(element_predicates);
+        return 0;
+    }
+
+    /* Second pass: bit vectors over all positions */
+    sc->words = (sc->length + 63) / 64;
+    sc->start = calloc(sc->words, sizeof(u64));
+    sc->final = calloc(sc->words, sizeof(u64));
+    sc->owners = CheckedRealloc(NULL, sc->length * sizeof(u32));
+    sc->positions = calloc((size_t)sc->predicate_count * sc->words, sizeof(u64));
+    for (u32 i = 0; i < sc->signature_count; i++)
+    {
+        SIGNATURE* sig = &sc->signatures[i];
+        for (u32 j = sig->first; j < sig->first + sig->length; j++) sc->owners[j] = i;
+        sc->start[sig->first / 64] |= 1ULL << (sig->first % 64);
+        u32 last = sig->first + sig->length - 1;
+        sc->final[last / 64] |= 1ULL << (last % 64);
+    }
+    for (u32 i = 0; i < sc->length; i++)
+    {
+        sc->positions[(size_t)element_predicates[i] * sc->words + i / 64] |= 1ULL << (i % 64);
+    }
+    free(element_predicates);
+    return 1;
+}
+
+static void FreeScanner(SCANNER* sc) {
+    free(sc->predicates);
+    free(sc->signatures);
+    free(sc->start);
+    free(sc->final);
+    free(sc->owners);
+    free(sc->positions);
+    free(sc->table);
+    memset(sc, 0, sizeof(SCANNER));
+}
+
+static void ScanPredicates(const SCANNER* sc, u32 code, u64* b) {
+    /* b = positions of every element matching this code, the text is only formatted if a template might match */
+    DINST di;
+    u8 str[STRING_LENGTH] = { 0 };
+    u8 text[STRING_LENGTH] = { 0 };
+    u32 prefix = 0;
+    int decoded = 0;
+    memset(b, 0, sc->words * sizeof(u64));
+    if (sc->dmode == DTHUMB && Decode_thumb(code, &di, sc->arch) == SIZE_16) code &= 0xffff; //the next halfword isn't part of it
+    for (u32 i = 0; i < sc->predicate_count; i++)
+    {
+        const PREDICATE* p = &sc->predicates[i];
+        switch (p->kind)
+        {
+        case PREDICATE_ANY: break;
+        case PREDICATE_CODE:
+        {
+            if ((code & p->mask) != p->value) continue;
+            break;
+        }
+        case PREDICATE_TEXT:
+        {
+            if (!decoded)
+            {
+                if (sc->dmode == DARM) Decode_arm(code, &di, sc->arch);
+                else Decode_thumb(code, &di, sc->arch);
+                prefix = MnemonicPrefixLength(di.mnemonic);
+                decoded = 1;
+            }
+            u32 k = 0; //cheap reject on the start of the mnemonic before formatting anything
+            while (k < prefix && p->text[k] == Mnemonics[di.mnemonic][k]) k++;
+            if (k < prefix && p->text[k] != '?' && p->text[k] != '*') continue;
+            if (!text[0])
+            {
+                if (sc->dmode == DARM) Disassemble_arm(code, str, sc->arch);
+                else Disassemble_thumb(code, str, sc->arch);
+                NormalizeTemplate(text, str, STRING_LENGTH);
+            }
+            if (!MatchTemplate(p->text, text)) continue;
+            break;
+        }
+        }
+        const u64* positions = &sc->positions[(size_t)i * sc->words];
+        for (u32 w = 0; w < sc->words; w++) b[w] |= positions[w];
+    }
+}
+
+static void ScanTableWorker(void* arg) {
+    /* Fill a slice of the THUMB halfword table */
+    SCANJOB* job = arg;
+    for (u64 c = job->begin; c < job->end; c++)
+    {
+        if ((c & 0xf800) == 0xf000) continue; //BL/BLX prefixes depend on the next halfword
+        ScanPredicates(job->scanner, (u32)c, &job->scanner->table[c * job->scanner->words]);
+    }
+}
+
+static const u64* ScanLookup(SCANJOB* job, u32 code, u64* tmp) {
+    /* Element bit vector of a code: THUMB table, or ARM cache */
+    const SCANNER* sc = job->scanner;
+    if (sc->dmode == DTHUMB)
+    {
+        if ((code & 0xf800) != 0xf000) return &sc->table[(size_t)(code & 0xffff) * sc->words];
+        ScanPredicates(sc, code, tmp);
+        return tmp;
+    }
+    u32 slot = (code * 0x9E3779B1u) >> (32 - SCAN_CACHE_BITS);
+    u64* entry = &job->cache[(size_t)slot * (sc->words + 1)];
+    if (entry[0] != ((u64)code | (1ULL << 32)))
+    {
+        entry[0] = (u64)code | (1ULL << 32);
+        ScanPredicates(sc, code, &entry[1]);
+    }
+    return &entry[1];
+}
+
+static void ScanWorker(void* arg) {
+    /* Run the automaton from the start of the chunk until no match can start inside it anymore */
+    SCANJOB* job = arg;
+    const SCANNER* sc = job->scanner;
+    u32 words = sc->words;
+    u64* d = calloc(words * 2, sizeof(u64));
+    u64* tmp = &d[words];
+    u64* addresses = calloc(sc->longest, sizeof(u64)); //ring of the last instruction addresses
+    if (sc->dmode == DARM) job->cache = calloc((size_t)(1 << SCAN_CACHE_BITS) * (words + 1), sizeof(u64));
+    u64 count = 0;
+    u64 i = job->begin;
+    if (sc->dmode == DTHUMB && IsThumbSuffix(job->data, job->size, job->start, i, sc->arch)) i += 2; //belongs to the previous chunk
+    u64 step = (sc->dmode == DARM) ? 4 : 2;
+    while (i + step <= job->limit)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        u32 size = 4;
+        if (sc->dmode == DTHUMB)
+        {
+            DINST di;
+            size = ((code & 0xf800) == 0xf000) ? ((Decode_thumb(code, &di, sc->arch) == SIZE_32) ? 4 : 2) : 2;
+            if (size == 2) code &= 0xffff;
+        }
+        const u64* b = ScanLookup(job, code, tmp);
+        addresses[count % sc->longest] = i;
+
+        /* Shift-And step: d = ((d << 1) | start) & b */
+        u64 carry = 0;
+        u64 any = 0;
+        for (u32 w = 0; w < words; w++)
+        {
+            u64 next = d[w] >> 63;
+            d[w] = ((d[w] << 1) | carry | sc->start[w]) & b[w];
+            carry = next;
+            any |= d[w] & sc->final[w];
+        }
+        if (any)
+        {
+            for (u32 w = 0; w < words; w++)
+            {
+                u64 hits = d[w] & sc->final[w];
+                while (hits)
+                {
+                    u32 bit = 0;
+                    while (!((hits >> bit) & 1)) bit++;
+                    hits &= hits - 1;
+                    const SIGNATURE* sig = &sc->signatures[sc->owners[w * 64 + bit]];
+                    u64 first = addresses[(count + 1 + sc->longest - sig->length) % sc->longest];
+                    if (first < job->begin || first >= job->end) continue; //reported by the worker that owns it
+                    job->matches = CheckedRealloc(job->matches, (job->match_count + 1) * sizeof(SCANMATCH));
+                    job->matches[job->match_count].address = first;
+                    job->matches[job->match_count].signature = sc->owners[w * 64 + bit];
+                    job->match_count++;
+                }
+            }
+        }
+        count++;
+        i += size;
+        if (i >= job->end && i - job->end >= (u64)sc->longest * 4) break; //no match can start inside the chunk anymore
+    }
+    free(d);
+    free(addresses);
+    free(job->cache);
+    job->cache = NULL;
+}
+
+static int CompareScanMatches(const void* a, const void* b) {
+    /* Ascending address, then signature */
+    const SCANMATCH* x = a;
+    const SCANMATCH* y = b;
+    if (x->address != y->address) return (x->address > y->address) ? 1 : -1;
+    return (x->signature > y->signature) - (x->signature < y->signature);
+}
+
+static int ScanSignatures(DARGS* dargs, FILE* out) {
+    /* Report every match of every signature of the file given with /scan:<file> */
+    if (!dargs->tool_value) return 0;
+    SCANNER sc;
+    if (!LoadScanner(&sc, dargs->tool_value, dargs->dmode, dargs->arch)) return 0;
+    MAPPEDFILE mf;
+    u64 start = 0;
+    u64 end = 0;
+    if (!MapFile(&mf, dargs->fname_in))
+    {
+        FreeScanner(&sc);
+        return 0;
+    }
+    if (!ResolveFileRange(dargs, mf.size, &start, &end))
+    {
+        UnmapFile(&mf);
+        FreeScanner(&sc);
+        return 0;
+    }
+
+    u32 cores = GetCoreCount();
+    SCANJOB jobs[WORKERS_MAX];
+    memset(jobs, 0, sizeof(jobs));
+    if (sc.dmode == DTHUMB) //element vectors of every halfword, once
+    {
+        u64 bounds[WORKERS_MAX + 1];
+        sc.table = calloc((size_t)0x10000 * sc.words, sizeof(u64));
+        u32 n = SplitRange(0, 0x10000, 1, cores, bounds);
+        for (u32 i = 0; i < n; i++)
+        {
+            jobs[i].scanner = &sc;
+            jobs[i].begin = bounds[i];
+            jobs[i].end = bounds[i + 1];
+        }
+        RunWorkers(ScanTableWorker, jobs, sizeof(SCANJOB), n);
+        memset(jobs, 0, sizeof(jobs));
+    }
+
+    u64 bounds[WORKERS_MAX + 1];
+    u32 workers = SplitRange(start, end, (sc.dmode == DARM) ? 4 : 2, cores, bounds);
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].scanner = &sc;
+        jobs[i].data = mf.data;
+        jobs[i].size = mf.size;
+        jobs[i].start = start;
+        jobs[i].begin = bounds[i];
+        jobs[i].end = bounds[i + 1];
+        jobs[i].limit = end;
+    }
+    RunWorkers(ScanWorker, jobs, sizeof(SCANJOB), workers);
+
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    OutBufPrintf(&ob, "Scan of %llu (0x%llX) bytes for %u signatures:\n\n", end - start, end - start, sc.signature_count);
+    u64* totals = calloc(sc.signature_count, sizeof(u64));
+    u64 total = 0;
+    for (u32 i = 0; i < workers; i++)
+    {
+        qsort(jobs[i].matches, jobs[i].match_count, sizeof(SCANMATCH), CompareScanMatches);
+        for (u64 j = 0; j < jobs[i].match_count; j++)
+        {
+            const SCANMATCH* m = &jobs[i].matches[j];
+            OutBufPrintf(&ob, "%08llX: %s\n", m->address, sc.signatures[m->signature].name);
+            totals[m->signature]++;
+            total++;
+        }
+        free(jobs[i].matches);
+    }
+    OutBufPrintf(&ob, "\n");
+    for (u32 i = 0; i < sc.signature_count; i++) OutBufPrintf(&ob, "%8llu %s\n", totals[i], sc.signatures[i].name);
+    OutBufPrintf(&ob, "\n%llu matches.", total);
+    OutBufFree(&ob);
+    free(totals);
+    UnmapFile(&mf);
+    FreeScanner(&sc);
+    return 1; //success
+}
+
+static void PushAddress(ADDRESSLIST* al, u64 address) {
+    /* Append to a growable list */
+    if (al->count == al->capacity)
+    {
+        al->capacity = al->capacity ? al->capacity * 2 : 1024;
+        al->data = CheckedRealloc(al->data, al->capacity * sizeof(u64));
+    }
+    al->data[al->count++] = address;
+}
+
+static int CompareAddresses(const void* a, const void* b) {
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    return (x > y) - (x < y);
+}
+
+static void SortAddresses(ADDRESSLIST* al) {
+    /* Sort and remove duplicates */
+    if (!al->count) return;
+    qsort(al->data, al->count, sizeof(u64), CompareAddresses);
+    u64 n = 1;
+    for (u64 i = 1; i < al->count; i++)
+    {
+        if (al->data[i] != al->data[n - 1]) al->data[n++] = al->data[i];
+    }
+    al->count = n;
+}
+
+static void MergeAddresses(ADDRESSLIST* dst, ADDRESSLIST* src) {
+    /* Move everything from src to dst */
+    for (u64 i = 0; i < src->count; i++) PushAddress(dst, src->data[i]);
+    free(src->data);
+    memset(src, 0, sizeof(ADDRESSLIST));
+}
+
+static int IsPrologue(const DINST* di) {
+    /* THUMB push {..., lr} or ARM stmdb sp!, {..., lr} */
+    if (di->mnemonic == MN_PUSH) return BITS(di->reglist, 14, 1);
+    return di->mnemonic == MN_STM && di->form == FORM_LIST_DB && di->rn == 13 && (di->flags & DF_WRITEBACK) && BITS(di->reglist, 14, 1);
+}
+
+static int IsEpilogue(const DINST* di) {
+    /* pop {..., pc}, bx lr or ldm ..., {..., pc} */
+    if (di->mnemonic == MN_POP || di->mnemonic == MN_LDM) return BITS(di->reglist, 15, 1);
+    return di->mnemonic == MN_BX && di->rm == 14;
+}
+
+static void FunctionWorker(void* arg) {
+    /* Collect call targets, prologues and epilogues of a chunk */
+    FUNCTIONJOB* job = arg;
+    DINST di;
+    DECODERS dec;
+    SelectDecoders(&dec, job->arch);
+    u64 i = job->begin;
+    if (job->dmode == DTHUMB && IsThumbSuffix(job->data, job->size, job->start, i, job->arch)) i += 2; //belongs to the previous chunk
+    while (i + ((job->dmode == DARM) ? 4 : 2) <= job->end)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        if (job->dmode == DARM) dec.decode_arm(code, &di);
+        else dec.decode_thumb(code, &di);
+
+        if (di.mnemonic == MN_BL || (di.mnemonic == MN_BLX && di.form == FORM_BRANCH_IMM))
+        {
+            u64 target = i + (s64)di.imm;
+            DMODE mode = job->dmode;
+            if (di.mnemonic == MN_BLX) //switches to the other instruction set
+            {
+                mode = (job->dmode == DARM) ? DTHUMB : DARM;
+                if (mode == DARM) target &= ~3ULL;
+            }
+            if (mode != job->dmode) job->other_mode++;
+            else if (target >= job->start && target < job->limit) PushAddress(&job->starts, target);
+        }
+        if (IsPrologue(&di)) PushAddress(&job->starts, i);
+        if (IsEpilogue(&di)) PushAddress(&job->ends, i + di.size);
+        i += di.size;
+    }
+}
+
+static int FindFunctions(DARGS* dargs, const u8* data, u64 size, FUNCTIONTABLE* ft) {
+    /* Detect function boundaries in the range, in parallel */
+    u64 start = 0;
+    u64 end = 0;
+    memset(ft, 0, sizeof(FUNCTIONTABLE));
+    if (!ResolveFileRange(dargs, size, &start, &end)) return 0;
+
+    FUNCTIONJOB jobs[WORKERS_MAX];
+    u64 bounds[WORKERS_MAX + 1];
+    memset(jobs, 0, sizeof(jobs));
+    u32 workers = SplitRange(start, end, (dargs->dmode == DARM) ? 4 : 2, GetCoreCount(), bounds);
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = data;
+        jobs[i].size = size;
+        jobs[i].start = start;
+        jobs[i].begin = bounds[i];
+        jobs[i].end = bounds[i + 1];
+        jobs[i].limit = end;
+        jobs[i].dmode = dargs->dmode;
+        jobs[i].arch = dargs->arch;
+    }
+    RunWorkers(FunctionWorker, jobs, sizeof(FUNCTIONJOB), workers);
+
+    ADDRESSLIST starts = { 0 };
+    ADDRESSLIST ends = { 0 };
+    for (u32 i = 0; i < workers; i++)
+    {
+        MergeAddresses(&starts, &jobs[i].starts);
+        MergeAddresses(&ends, &jobs[i].ends);
+        ft->other_mode += jobs[i].other_mode;
+    }
+    SortAddresses(&starts);
+    SortAddresses(&ends);
+
+    /* A function ends after its last epilogue before the next function, or at the next function if it has none */
+    ft->functions = CheckedRealloc(NULL, starts.count * sizeof(FUNCTION));
+    u64 e = 0;
+    for (u64 i = 0; i < starts.count; i++)
+    {
+        u64 next = (i + 1 < starts.count) ? starts.data[i + 1] : end;
+        FUNCTION* f = &ft->functions[ft->count++];
+        f->start = starts.data[i];
+        f->end = next;
+        f->mode = dargs->dmode;
+        while (e < ends.count && ends.data[e] <= f->start) e++;
+        while (e < ends.count && ends.data[e] <= next)
+        {
+            f->end = ends.data[e];
+            e++;
+        }
+    }
+    free(starts.data);
+    free(ends.data);
+    return 1;
+}
+
+static void FreeFunctionTable(FUNCTIONTABLE* ft) {
+    free(ft->functions);
+    memset(ft, 0, sizeof(FUNCTIONTABLE));
+}
+
+static int LoadFunctionTable(const u8* fname, FUNCTIONTABLE* ft) {
+    /* Read a function table written by /functions, CSV or binary */
+    memset(ft, 0, sizeof(FUNCTIONTABLE));
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, fname))
+    {
+        printf("ERROR: The function table \"%s\" doesn't exist.\n", fname);
+        return 0;
+    }
+    if (mf.size >= 12 && !memcmp(mf.data, FUNCTIONTABLE_MAGIC, 4)) //binary
+    {
+        u32 count = 0;
+        memcpy(&count, &mf.data[8], 4);
+        if ((u64)count * 16 > mf.size - 12) count = (u32)((mf.size - 12) / 16);
+        ft->functions = CheckedRealloc(NULL, (size_t)count * sizeof(FUNCTION));
+        for (u32 i = 0; i < count; i++)
+        {
+            u32 rec[4]; //start, end, size, mode
+            memcpy(rec, &mf.data[12 + i * 16], 16);
+            ft->functions[i].start = rec[0];
+            ft->functions[i].end = rec[1];
+            ft->functions[i].mode = rec[3] ? DTHUMB : DARM;
+        }
+        ft->count = count;
+    }
+    else //CSV: start,end,mode,size
+    {
+        u64 capacity = 0;
+        const u8* p = mf.data;
+        const u8* last = mf.data + mf.size;
+        while (p < last)
+        {
+            u8 line[PATH_LENGTH] = { 0 };
+            u32 len = 0;
+            while (p < last && *p != '\n')
+            {
+                if (len < PATH_LENGTH - 1) line[len++] = *p;
+                p++;
+            }
+            p++;
+            u8* field = line;
+            if (!IsWordChar(field[0])) continue;
+            u8* next = NULL;
+            u64 fstart = strtoull(field, (char**)&next, 16);
+            if (next == field || *next != ',') continue; //header or garbage
+            field = next + 1;
+            u64 fend = strtoull(field, (char**)&next, 16);
+            if (next == field || *next != ',') continue;
+            if (ft->count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 1024;
+                ft->functions = CheckedRealloc(ft->functions, capacity * sizeof(FUNCTION));
+            }
+            FUNCTION* f = &ft->functions[ft->count++];
+            f->start = fstart;
+            f->end = fend;
+            f->mode = (next[1] == 't' || next[1] == 'T') ? DTHUMB : DARM;
+        }
+    }
+    UnmapFile(&mf);
+    return 1;
+}
+
+static int ExportFunctions(DARGS* dargs, FILE* out) {
+    /* Write the function table: CSV by default, binary with /functions:bin */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    int bin = dargs->tool_value && !strcmp(dargs->tool_value, "bin");
+    u64 start = 0;
+    u64 end = 0;
+    if (bin && ResolveFileRange(dargs, mf.size, &start, &end) && !CheckRange32(0, end, "/functions:bin"))
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+    FUNCTIONTABLE ft;
+    if (!FindFunctions(dargs, mf.data, mf.size, &ft))
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+    UnmapFile(&mf);
+
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    if (bin)
+    {
+        //Binary: "DTFN", u32 version, u32 count, then count * (u32 start, u32 end, u32 size, u32 mode), little-endian
+        u32 header[2] = { FUNCTIONTABLE_VERSION, (u32)ft.count };
+        SetBinaryMode(out);
+        OutBufWrite(&ob, FUNCTIONTABLE_MAGIC, 4);
+        OutBufWrite(&ob, header, sizeof(header));
+        for (u64 i = 0; i < ft.count; i++)
+        {
+            const FUNCTION* f = &ft.functions[i];
+            u32 rec[4] = { (u32)f->start, (u32)f->end, (u32)(f->end - f->start), f->mode };
+            OutBufWrite(&ob, rec, sizeof(rec));
+        }
+    }
+    else
+    {
+        OutBufPrintf(&ob, "start,end,mode,size\n");
+        for (u64 i = 0; i < ft.count; i++)
+        {
+            const FUNCTION* f = &ft.functions[i];
+            OutBufPrintf(&ob, "%08llX,%08llX,%s,%llu\n", f->start, f->end, (f->mode == DARM) ? "arm" : "thumb", f->end - f->start);
+        }
+    }
+    OutBufFree(&ob);
+    printf("%llu functions found, %llu calls to the other instruction set ignored.\n", ft.count, ft.other_mode);
+    FreeFunctionTable(&ft);
+    return 1; //success
+}
+
+static int CompareFunctions(const void* a, const void* b) {
+    const FUNCTION* x = a;
+    const FUNCTION* y = b;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+static void LabelFunction(OUTBUF* out, const FUNCTIONTABLE* ft, u64* next, u64 address) {
+    /* Print a label before the first instruction of each function, addresses only go up */
+    while (*next < ft->count && ft->functions[*next].start < address) (*next)++;
+    if (*next < ft->count && ft->functions[*next].start == address) OutBufPrintf(out, "\nsub_%08llX:\n", address);
+}
+
+static void PrintListingPhase(const u8* name, double seconds, const LISTINGSTATS* st) {
+    /* One line of the /stats report */
+    double ms = seconds * 1000.0;
+    double mbs = seconds > 0 ? st->bytes_in / seconds / 1e6 : 0.0;
+    double mis = seconds > 0 ? st->instructions / seconds / 1e6 : 0.0;
+    printf("%-8s %10.3f ms %10.1f MB/s %10.1f M instructions/s\n", name, ms, mbs, mis);
+}
+
+static void PrintListingStats(const LISTINGSTATS* st) {
+    /* /stats: time and throughput of each phase of a listing, from a monotonic clock */
+    double total = st->read + st->decode + st->format + st->write;
+    printf("\n%-8s %13s %15s %27s\n", "Phase", "time", "input", "instructions");
+    PrintListingPhase("read", st->read, st);
+    PrintListingPhase("decode", st->decode, st);
+    PrintListingPhase("format", st->format, st);
+    PrintListingPhase("write", st->write, st);
+    PrintListingPhase("total", total, st);
+    if (st->wall > 0) PrintListingPhase("wall", st->wall, st); //less than the total when the phases overlapped
+    printf("%llu bytes in, %llu bytes out, %llu instructions, %llu n/a (%.2f%%).\n\n", st->bytes_in, st->bytes_out, st->instructions, st->na,
+        st->instructions ? 100.0 * st->na / st->instructions : 0.0);
+}
+
+static int IsTextByte(u8 b) {
+    /* Printable ASCII, tab or line break */
+    return (b >= 0x20 && b < 0x7f) || b == '\t' || b == '\n' || b == '\r';
+}
+
+static int ClassifyWindow(const CLASSIFYJOB* job, u64 begin, u64 end) {
+    /* Score [begin, end) on each signal, return 1 if one of them reaches its threshold */
+    const CLASSIFYTHRESHOLDS* th = job->thresholds;
+    u32 len = (u32)(end - begin);
+    if (len < 16) return 0; //too short to tell, decode it
+
+    /* Decoders: n/a density, and for ARM how many codes aren't AL */
+    u32 count = 0;
+    u32 na = 0;
+    u32 conditional = 0;
+    DINST di;
+    for (u64 i = begin; i + ((job->dmode == DARM) ? 4 : 2) <= end; i += di.size)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        if (job->dmode == DARM)
+        {
+            job->dec.decode_arm(code, &di);
+            di.size = 4;
+            if ((code >> 28) != AL) conditional++;
+        }
+        else
+        {
+            job->dec.decode_thumb(code, &di);
+        }
+        if (di.mnemonic == MN_NA) na++;
+        count++;
+    }
+    if (count && na * 100 >= th->na * count) return 1;
+    if (job->dmode == DARM && count && conditional * 100 >= th->cond * count) return 1;
+
+    /* Text: bytes in printable runs of at least 4, with their terminator */
+    u32 text = 0;
+    u32 run = 0;
+    for (u64 i = begin; i < end; i++)
+    {
+        u8 b = job->data[i];
+        if (IsTextByte(b))
+        {
+            run++;
+            continue;
+        }
+        if (run >= 4) text += run + (b == 0);
+        run = 0;
+    }
+    if (run >= 4) text += run;
+    if (text * 100 >= th->ascii * len) return 1;
+
+    /* Tables and fills: words equal to the previous one */
+    u32 words = len / 4;
+    u32 repeated = 0;
+    u32 previous = 0;
+    for (u32 k = 0; k < words; k++)
+    {
+        u32 w = 0;
+        memcpy(&w, &job->data[begin + k * 4], 4);
+        if (k && w == previous) repeated++;
+        previous = w;
+    }
+    if (words > 1 && repeated * 100 >= th->repeat * (words - 1)) return 1;
+    return 0;
+}
+
+static void ClassifyWorker(void* arg) {
+    /* Classify the windows of a job */
+    CLASSIFYJOB* job = arg;
+    for (u32 w = job->first; w < job->last; w++)
+    {
+        u64 begin = job->start + (u64)w * CLASSIFY_WINDOW;
+        u64 end = (job->end - begin < CLASSIFY_WINDOW) ? job->end : begin + CLASSIFY_WINDOW;
+        job->windows[w] = (u8)ClassifyWindow(job, begin, end);
+        job->data_windows += job->windows[w];
+    }
+}
+
+static u8* ClassifyRange(DARGS* dargs, u64 start, u64 end, u32* data_windows) {
+    /* Pre-pass: one byte per window of the range, 1 if it looks like data, NULL on failure */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return NULL;
+    u32 count = (u32)((end - start + CLASSIFY_WINDOW - 1) / CLASSIFY_WINDOW);
+    u8* windows = calloc(count ? count : 1, 1);
+    CLASSIFYJOB jobs[WORKERS_MAX];
+    u32 workers = GetCoreCount();
+    if (workers > count) workers = count ? count : 1;
+    u32 per_job = (count + workers - 1) / workers;
+    memset(jobs, 0, sizeof(jobs));
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = mf.data;
+        jobs[i].size = mf.size;
+        jobs[i].start = start;
+        jobs[i].end = end;
+        jobs[i].dmode = dargs->dmode;
+        SelectDecoders(&jobs[i].dec, dargs->arch);
+        jobs[i].thresholds = &dargs->thresholds;
+        jobs[i].windows = windows;
+        jobs[i].first = (i * per_job < count) ? i * per_job : count;
+        jobs[i].last = ((i + 1) * per_job < count) ? (i + 1) * per_job : count;
+    }
+    if (windows) RunWorkers(ClassifyWorker, jobs, sizeof(CLASSIFYJOB), workers);
+    *data_windows = 0;
+    for (u32 i = 0; i < workers; i++) *data_windows += jobs[i].data_windows;
+    UnmapFile(&mf);
+    return windows;
+}
+
+static u64 FindFunctionIndex(const FUNCTIONTABLE* ft, u64 address) {
+    /* Index of the first function starting at or after address, binary search */
+    u64 lo = 0;
+    u64 hi = ft->count;
+    while (lo < hi)
+    {
+        u64 mid = (lo + hi) / 2;
+        if (ft->functions[mid].start < address) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int IsDataWindow(const LISTING* l, u64 address) {
+    /* Was the window holding address classified as data */
+    return l->windows && l->windows[(address - l->start) / CLASSIFY_WINDOW];
+}
+
+static void ListDataBytes(OUTBUF* out, const FUNCTIONTABLE* ft, u64* next_function, u64 address, const u8* bytes, u32 size) {
+    /* Up to 4 words per .word line, then the bytes left as .byte */
+    u32 i = 0;
+    while (size - i >= 4)
+    {
+        LabelFunction(out, ft, next_function, address + i);
+        OutBufPrintf(out, "%08llX: .word ", address + i);
+        for (u32 k = 0; k < 4 && size - i >= 4; k++, i += 4)
+        {
+            u32 w = 0;
+            memcpy(&w, &bytes[i], 4);
+            OutBufPrintf(out, k ? ", 0x%08X" : "0x%08X", w);
+        }
+        OutBufWrite(out, "\n", 1);
+    }
+    if (i == size) return;
+    LabelFunction(out, ft, next_function, address + i);
+    OutBufPrintf(out, "%08llX: .byte ", address + i);
+    for (u32 k = 0; i < size; k++, i++) OutBufPrintf(out, k ? ", 0x%02X" : "0x%02X", bytes[i]);
+    OutBufWrite(out, "\n", 1);
+}
+
+static void ReadListingBlock(LISTING* l, LISTINGSLOT* slot, u32 index, LISTINGSTATS* st) {
+    /* Read block index into slot, with the halfword before it and 4 bytes after it (past the range, like a single read would) */
+    double t = GetTime();
+    slot->address = l->start + (u64)index * LISTING_BLOCK;
+    slot->size = (l->end - slot->address < LISTING_BLOCK) ? (u32)(l->end - slot->address) : LISTING_BLOCK;
+    size_t n = slot->size + 6;
+    size_t got = 0;
+    if (index) //the halfword before is only looked at inside the range
+    {
+        SeekFile(l->in, slot->address - 2);
+        got = fread(slot->data, 1, n, l->in);
+    }
+    else
+    {
+        memset(slot->data, 0, 2);
+        SeekFile(l->in, slot->address);
+        got = 2 + fread(&slot->data[2], 1, n - 2, l->in);
+    }
+    memset(&slot->data[got], 0, n - got);
+    st->read += GetTime() - t;
+    st->bytes_in += slot->size;
+}
+
+static void AddModeRange(MODERANGE* ranges, u32* count, u64 start, u64 end, DMODE dmode, ARMARCH arch) {
+    /* Append a range, or grow the last one when it has the same mode */
+    MODERANGE* last = *count ? &ranges[*count - 1] : NULL;
+    if (last && last->end == start && last->dmode == dmode && last->arch == arch)
+    {
+        last->end = end;
+        return;
+    }
+    MODERANGE* r = &ranges[(*count)++];
+    r->start = start;
+    r->end = end;
+    r->dmode = dmode;
+    r->arch = arch;
+    SelectDecoders(&r->dec, arch);
+}
+
+static MODERANGE* BuildModeRanges(const MODEMAP* map, u64 start, u64 end, DMODE dmode, ARMARCH arch, u32* count) {
+    /* Ranges that follow each other from start to end: the ones of the map, clipped, with dmode and arch in the gaps */
+    MODERANGE* ranges = CheckedRealloc(NULL, ((size_t)map->count * 2 + 1) * sizeof(MODERANGE));
+    *count = 0;
+    u64 a = start;
+    for (u32 i = 0; i < map->count && a < end; i++)
+    {
+        const MODERANGE* m = &map->ranges[i];
+        if (m->end <= a) continue;
+        if (m->start >= end) break;
+        if (m->start > a) //gap
+        {
+            AddModeRange(ranges, count, a, m->start, dmode, arch);
+            a = m->start;
+        }
+        u64 stop = (m->end < end) ? m->end : end;
+        AddModeRange(ranges, count, a, stop, m->dmode, m->arch);
+        a = stop;
+    }
+    if (a < end) AddModeRange(ranges, count, a, end, dmode, arch);
+    return ranges;
+}
+
+static u32 Log2Fixed(u32 x) {
+    /* log2(x) in 1/256, linear between powers of 2, 0 for x <= 1 */
+    if (x <= 1) return 0;
+    u32 e = 31;
+    while (!(x >> e)) e--;
+    u32 frac = (e >= 8) ? (x >> (e - 8)) & 0xff : (x << (8 - e)) & 0xff;
+    return (e << 8) | frac;
+}
+
+static void ScoreModeWindow(const DETECTJOB* job, u64 begin, u64 end, DETECTWINDOW* w) {
+    /* Score [begin, end) as ARM and as THUMB, each from 100 (certainly) down */
+    /* ARM: n/a rate, and the entropy of the condition field, nearly always AL in real code */
+    /* THUMB: n/a rate, push {lr}/pop {pc}/bx lr, and bl/blx halves that come in pairs */
+    DINST di;
+    u32 count = 0;
+    u32 na = 0;
+    u32 conditions[CONDITIONS_MAX] = { 0 };
+    for (u64 i = begin; i + 4 <= end; i += 4)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        job->dec.decode_arm(code, &di);
+        conditions[code >> 28]++;
+        na += (di.mnemonic == MN_NA);
+        count++;
+    }
+    if (count == 0)
+    {
+        w->arm = w->thumb = 0;
+        return;
+    }
+    u32 entropy = Log2Fixed(count) * count; //count * H in 1/256 bit
+    for (u32 c = 0; c < CONDITIONS_MAX; c++) entropy -= Log2Fixed(conditions[c]) * conditions[c];
+    w->arm = 100 - (int)(na * 100 / count) - (int)(entropy * 25 / (count * 256)); //4 bits of entropy cost 100
+
+    u32 halves = 0;
+    u32 frames = 0; //prologues and epilogues
+    u32 pairs = 0;
+    u32 orphans = 0; //bl/blx halves without the other one
+    na = 0;
+    for (u64 i = begin; i + 2 <= end; i += 2)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        u16 h = (u16)code;
+        if (i + 4 > end) code &= 0xffff;
+        if ((h & 0xff00) == 0xb500 || (h & 0xff00) == 0xbd00 || h == 0x4770) frames++;
+        if ((h & 0xf800) == 0xf000) //prefix
+        {
+            if (((code >> 16) & 0xe800) == 0xe800 && i + 4 <= end) //suffix
+            {
+                pairs++;
+                halves += 2;
+                i += 2;
+                continue;
+            }
+            orphans++;
+        }
+        else if ((h & 0xe800) == 0xe800) orphans++; //suffix without a prefix
+        job->dec.decode_thumb(h, &di);
+        na += (di.mnemonic == MN_NA);
+        halves++;
+    }
+    int structure = (int)((frames * 5 < 20) ? frames * 5 : 20) + (int)((pairs * 4 < 20) ? pairs * 4 : 20) - (int)((orphans * 10 < 40) ? orphans * 10 : 40);
+    w->thumb = 100 - (int)(na * 100 / halves) - 20 + structure; //20 points short without any structure
+}
+
+static void DetectWorker(void* arg) {
+    /* Score the windows of a job */
+    DETECTJOB* job = arg;
+    for (u32 w = job->first; w < job->last; w++)
+    {
+        u64 begin = job->start + (u64)w * DETECT_WINDOW;
+        u64 end = (job->end - begin < DETECT_WINDOW) ? job->end : begin + DETECT_WINDOW;
+        ScoreModeWindow(job, begin, end, &job->windows[w]);
+    }
+}
+
+static DETECTWINDOW* DetectModeWindows(DARGS* dargs, const u8* data, u64 size, u64 start, u64 end, u32* count) {
+    /* Score every window of the range on all cores, then pick a mode for each one */
+    *count = (u32)((end - start + DETECT_WINDOW - 1) / DETECT_WINDOW);
+    DETECTWINDOW* windows = calloc(*count ? *count : 1, sizeof(DETECTWINDOW));
+    DETECTJOB jobs[WORKERS_MAX];
+    u64 bounds[WORKERS_MAX + 1];
+    u32 workers = SplitRange(0, *count, 1, GetCoreCount(), bounds);
+    if (windows == NULL) return NULL;
+    memset(jobs, 0, sizeof(jobs));
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = data;
+        jobs[i].size = size;
+        jobs[i].start = start;
+        jobs[i].end = end;
+        SelectDecoders(&jobs[i].dec, dargs->arch);
+        jobs[i].windows = windows;
+        jobs[i].first = (u32)bounds[i];
+        jobs[i].last = (u32)bounds[i + 1];
+    }
+    if (workers) RunWorkers(DetectWorker, jobs, sizeof(DETECTJOB), workers);
+
+    /* Each window leans on its neighbours when its own scores are close, a lone window rarely flips the mode */
+    DMODE previous = dargs->dmode;
+    for (u32 w = 0; w < *count; w++)
+    {
+        int lead = windows[w].arm - windows[w].thumb;
+        if (lead < DETECT_MARGIN && lead > -DETECT_MARGIN)
+        {
+            lead *= 2;
+            if (w > 0) lead += windows[w - 1].arm - windows[w - 1].thumb;
+            if (w + 1 < *count) lead += windows[w + 1].arm - windows[w + 1].thumb;
+        }
+        if (windows[w].arm < DETECT_MIN && windows[w].thumb < DETECT_MIN) windows[w].dmode = previous; //neither, likely data
+        else windows[w].dmode = (lead > 0) ? DARM : (lead < 0) ? DTHUMB : previous;
+        previous = windows[w].dmode;
+    }
+    return windows;
+}
+
+static int DetectModeMap(DARGS* dargs) {
+    /* /modes:auto: fill the mode map of the range of the input file from DetectModeWindows */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    u64 start = dargs->frange.start;
+    u64 end = dargs->frange.end ? dargs->frange.end : mf.size;
+    if (start > mf.size || end > mf.size || start > end)
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+    u32 count = 0;
+    DETECTWINDOW* windows = DetectModeWindows(dargs, mf.data, mf.size, start, end, &count);
+    UnmapFile(&mf);
+    if (windows == NULL) return 0;
+    free(dargs->modemap.ranges);
+    dargs->modemap.ranges = CheckedRealloc(NULL, ((size_t)count + 1) * sizeof(MODERANGE));
+    dargs->modemap.count = 0;
+    for (u32 w = 0; w < count; w++)
+    {
+        u64 begin = start + (u64)w * DETECT_WINDOW;
+        AddModeRange(dargs->modemap.ranges, &dargs->modemap.count, begin, (end - begin < DETECT_WINDOW) ? end : begin + DETECT_WINDOW, windows[w].dmode, dargs->arch);
+    }
+    free(windows);
+    return 1;
+}
+
+static int DetectModes(DARGS* dargs, FILE* out) {
+    /* /detect: print the mode map guessed for the range, in the format of /modes, with the average scores of each range */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    u64 start = dargs->frange.start;
+    u64 end = dargs->frange.end ? dargs->frange.end : mf.size;
+    if (start > mf.size || end > mf.size || start > end)
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+    u32 count = 0;
+    DETECTWINDOW* windows = DetectModeWindows(dargs, mf.data, mf.size, start, end, &count);
+    UnmapFile(&mf);
+    if (windows == NULL) return 0;
+    const u8* version = (dargs->arch >= ARMv5TE) ? "5" : "4";
+    fprintf(out, "# modes of %llX-%llX, %u windows of %u bytes scored as ARM and as THUMB\n", start, end, count, DETECT_WINDOW);
+    u32 first = 0;
+    for (u32 w = 1; w <= count; w++)
+    {
+        if (w < count && windows[w].dmode == windows[first].dmode) continue;
+        s64 arm = 0;
+        s64 thumb = 0;
+        for (u32 k = first; k < w; k++)
+        {
+            arm += windows[k].arm;
+            thumb += windows[k].thumb;
+        }
+        u64 begin = start + (u64)first * DETECT_WINDOW;
+        u64 stop = (w == count) ? end : start + (u64)w * DETECT_WINDOW;
+        fprintf(out, "%llX-%llX %s%s # arm %lld, thumb %lld\n", begin, stop, (windows[first].dmode == DARM) ? "a" : "t", version, arm / (w - first), thumb / (w - first));
+        first = w;
+    }
+    free(windows);
+    return 1; //success
+}
+
+static u32 FindModeRange(const LISTING* l, u64 address) {
+    /* Index of the mode range holding address, binary search */
+    u32 lo = 0;
+    u32 hi = l->range_count - 1;
+    while (lo < hi)
+    {
+        u32 mid = (lo + hi + 1) / 2;
+        if (l->ranges[mid].start <= address) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+static u64 AlignInModeRange(const MODERANGE* r, u64 address) {
+    /* First instruction boundary of the range at or after address, counted from the start of the range */
+    u64 align = (r->dmode == DARM) ? 4 : 2;
+    return r->start + (address - r->start + align - 1) / align * align;
+}
+
+static void FormatCycles(u8* dst, size_t size, const CYCLES* c, ARMARCH arch) {
+    /* "3 cycles" on the ARM946E-S, "3-6 cycles (1S+1N+1-4I)" on the ARM7TDMI, leaving out the zero counts */
+    int len = (c->min == c->max) ? snprintf(dst, size, "%u cycle%s", c->min, (c->min == 1) ? "" : "s") : snprintf(dst, size, "%u-%u cycles", c->min, c->max);
+    if (arch >= ARMv5TE || len < 0 || (size_t)len >= size) return;
+    const u8* sep = " (";
+    const u8 kinds[3] = { 'S', 'N', 'I' };
+    const u8 counts[3] = { c->s, c->n, c->i };
+    for (u32 k = 0; k < 3; k++)
+    {
+        if (counts[k] == 0) continue;
+        u32 low = (k == 2) ? counts[k] - (c->max - c->min) : counts[k]; //early termination only shortens the internal cycles
+        int w = (low == counts[k]) ? snprintf(&dst[len], size - len, "%s%u%c", sep, counts[k], kinds[k]) : snprintf(&dst[len], size - len, "%s%u-%u%c", sep, low, counts[k], kinds[k]);
+        if (w < 0 || (size_t)(len + w) >= size) return;
+        len += w;
+        sep = "+";
+    }
+    if (sep[0] == '+') snprintf(&dst[len], size - len, ")");
+}
+
+static void DecodeListingBlock(LISTING* l, LISTINGSLOT* slot, LISTINGLINE* lines, LISTINGSTATS* st) {
+    /* Decode a block, then format its lines into the slot */
+    /* Each mode range is decoded on its own, no instruction reaches into the next one */
+    double t = GetTime();
+    const u8* data = &slot->data[2];
+    u32 na_before = debug_na_count;
+    u32 count = 0;
+    u32 r = FindModeRange(l, slot->address);
+    const MODERANGE* range = &l->ranges[r];
+    u64 a = slot->address;
+    if (a > range->start) //the last line of the previous block can end in this one
+    {
+        a = AlignInModeRange(range, a);
+        if (a > range->end) a = range->end; //bytes too short for an instruction, listed as data
+        if (range->dmode == DTHUMB && a - 2 >= range->start && (a < range->end || range->end == l->end) && !IsDataWindow(l, a - 2)) //second half of a pair
+        {
+            DINST di;
+            u32 pair = 0;
+            memcpy(&pair, &data[a - 2 - slot->address], 4);
+            if ((pair & 0xf800) == 0xf000 && range->dec.decode_thumb(pair, &di) == SIZE_32) a += 2;
+        }
+    }
+    u64 first = a;
+    u64 block_end = slot->address + slot->size;
+    while (a < block_end)
+    {
+        if (a >= range->end) //the ranges follow each other
+        {
+            range = &l->ranges[++r];
+            continue;
+        }
+        u32 align = (range->dmode == DARM) ? 4 : 2;
+        if (a + align > l->end) break;
+        if (IsDataWindow(l, a)) //up to the end of the window, not decoded, then up to the next instruction boundary of the range
+        {
+            u64 stop = l->start + ((a - l->start) / CLASSIFY_WINDOW + 1) * CLASSIFY_WINDOW;
+            if (stop > range->end) stop = range->end;
+            if (stop > l->end) stop = l->end;
+            stop = AlignInModeRange(range, stop);
+            if (stop > range->end) stop = range->end;
+            LISTINGLINE* line = &lines[count++];
+            line->data = 1;
+            line->size = (u32)(stop - a);
+            a = stop;
+            continue;
+        }
+        LISTINGLINE* line = &lines[count++];
+        if (a + align > range->end) //too short for an instruction
+        {
+            line->data = 1;
+            line->size = (u32)(range->end - a);
+            a = range->end;
+            continue;
+        }
+        line->data = 0;
+        memcpy(&line->code, &data[a - slot->address], 4);
+        memset(line->text, 0, STRING_LENGTH); //the decoders only write "n/a" over an empty string
+        if (range->dmode == DARM)
+        {
+            range->dec.disassemble_arm(line->code, line->text);
+            line->size = 4;
+        }
+        else
+        {
+            if (a + 4 > range->end && range->end != l->end) line->code &= 0xffff; //a pair can't take its second half from the next range
+            line->size = (range->dec.disassemble_thumb(line->code, line->text) == SIZE_32) ? 4 : 2;
+        }
+        if (l->cycles)
+        {
+            DINST di;
+            if (range->dmode == DARM) range->dec.decode_arm(line->code, &di);
+            else range->dec.decode_thumb(line->code, &di);
+            EstimateCycles(&di, range->arch, &line->cycles);
+            line->arch = range->arch;
+        }
+        a += line->size;
+    }
+    slot->na = debug_na_count - na_before;
+    slot->instructions = count;
+    double t_decode = GetTime();
+    st->decode += t_decode - t;
+
+    slot->text.size = 0;
+    u64 next_function = FindFunctionIndex(l->ft, first);
+    a = first;
+    for (u32 k = 0; k < count; k++)
+    {
+        LISTINGLINE* line = &lines[k];
+        if (line->data)
+        {
+            ListDataBytes(&slot->text, l->ft, &next_function, a, &data[a - slot->address], line->size);
+            a += line->size;
+            continue;
+        }
+        LabelFunction(&slot->text, l->ft, &next_function, a);
+        if (l->cycles)
+        {
+            u8 text[STRING_LENGTH + 48];
+            size_t len = strlen(line->text);
+            memcpy(text, line->text, len);
+            memcpy(&text[len], " ; ", 3);
+            FormatCycles(&text[len + 3], sizeof(text) - len - 3, &line->cycles, line->arch);
+            WriteListingLine(&slot->text, a, line->code, line->size, text);
+        }
+        else WriteListingLine(&slot->text, a, line->code, line->size, line->text);
+        a += line->size;
+    }
+    st->format += GetTime() - t_decode;
+    st->instructions += count;
+    st->na += slot->na;
+}
+
+static void ListingWorker(void* arg) {
+    /* Take whichever stage can move: write finished blocks in order, decode a block, or read the next one */
+    /* Any thread can do any stage, so the listing completes even with a single thread */
+    LISTINGJOB* job = arg;
+    LISTING* l = job->listing;
+    u32 spins = 0;
+    while (AtomicLoad(&l->write_count) < l->blocks)
+    {
+        int progress = 0;
+        if (AtomicCompareExchange(&l->writing, 0, 1)) //writer, frees the slots
+        {
+            u32 w = l->write_count;
+            while (w < l->blocks && AtomicLoad(&l->slots[w % l->slot_count].state) == SLOT_DONE)
+            {
+                LISTINGSLOT* slot = &l->slots[w % l->slot_count];
+                double t = GetTime();
+                fwrite(slot->text.data, 1, slot->text.size, l->out);
+                job->stats.write += GetTime() - t;
+                job->stats.bytes_out += slot->text.size;
+                AtomicStore(&slot->state, SLOT_FREE);
+                AtomicStore(&l->write_count, ++w);
+                progress = 1;
+            }
+            AtomicStore(&l->writing, 0);
+        }
+        u32 d = AtomicLoad(&l->decode_next);
+        if (d < AtomicLoad(&l->read_count) && AtomicCompareExchange(&l->decode_next, d, d + 1)) //decoder
+        {
+            LISTINGSLOT* slot = &l->slots[d % l->slot_count];
+            DecodeListingBlock(l, slot, job->lines, &job->stats);
+            AtomicStore(&slot->state, SLOT_DONE);
+            progress = 1;
+        }
+        else if (AtomicCompareExchange(&l->reading, 0, 1)) //reader, waits for the writer to free a slot (backpressure)
+        {
+            u32 r = l->read_count;
+            if (r < l->blocks && AtomicLoad(&l->slots[r % l->slot_count].state) == SLOT_FREE)
+            {
+                LISTINGSLOT* slot = &l->slots[r % l->slot_count];
+                ReadListingBlock(l, slot, r, &job->stats);
+                AtomicStore(&slot->state, SLOT_READ);
+                AtomicStore(&l->read_count, r + 1);
+                progress = 1;
+            }
+            AtomicStore(&l->reading, 0);
+        }
+        if (progress) spins = 0;
+        else Backoff(&spins);
+    }
+}
+
+static void SumCycles(const u8* data, u64 size, ARMARCH arch, CYCLETOTAL* t) {
+    /* Add up the estimate of every instruction of [t->start, t->end), each one counted once, as if run straight through */
+    DECODERS dec;
+    SelectDecoders(&dec, arch);
+    u32 align = (t->dmode == DARM) ? 4 : 2;
+    u64 i = t->start;
+    while (i + align <= t->end)
+    {
+        DINST di;
+        CYCLES c;
+        u32 code = ReadCode(data, size, i);
+        if (t->dmode == DARM) dec.decode_arm(code, &di);
+        else dec.decode_thumb((i + 4 > t->end) ? code & 0xffff : code, &di); //a pair doesn't reach past the end
+        EstimateCycles(&di, arch, &c);
+        t->instructions++;
+        t->min += c.min;
+        t->max += c.max;
+        t->n += c.n;
+        t->s += c.s;
+        t->i += c.i;
+        i += di.size;
+    }
+}
+
+static int CompareCycleTotals(const void* a, const void* b) {
+    /* Most expensive first, then by address */
+    const CYCLETOTAL* x = a;
+    const CYCLETOTAL* y = b;
+    if (x->max != y->max) return (x->max < y->max) - (x->max > y->max);
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+static void PrintCycleTotal(FILE* out, const u8* label, const CYCLETOTAL* t, ARMARCH arch) {
+    /* One line of the /cycles summary */
+    fprintf(out, "%s%llu instructions, ", label, t->instructions);
+    if (t->min == t->max) fprintf(out, "%llu cycles", t->max);
+    else fprintf(out, "%llu-%llu cycles", t->min, t->max);
+    if (arch < ARMv5TE) fprintf(out, " (%lluS+%lluN+%lluI)", t->s, t->n, t->i);
+    fprintf(out, "\n");
+}
+
+static int PrintCycleSummary(DARGS* dargs, const FUNCTIONTABLE* ft, const MODERANGE* ranges, u32 range_count, FILE* out) {
+    /* /cycles: static cost of each function of the range, most expensive first, or of the whole range without a function table */
+    /* Functions are decoded in their own mode, the range follows the mode map like the listing */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    const u8* model = (dargs->arch >= ARMv5TE) ? "ARM946E-S" : "ARM7TDMI";
+    fprintf(out, "\n\nCycle estimates (%s, no wait states, every instruction once):\n", model);
+    if (ft->count)
+    {
+        CYCLETOTAL* totals = CheckedRealloc(NULL, ft->count * sizeof(CYCLETOTAL));
+        u64 count = 0;
+        for (u64 f = 0; f < ft->count; f++)
+        {
+            const FUNCTION* fn = &ft->functions[f];
+            if (fn->start < dargs->frange.start || fn->end > dargs->frange.end) continue; //only the functions listed
+            CYCLETOTAL* t = &totals[count++];
+            memset(t, 0, sizeof(CYCLETOTAL));
+            t->start = fn->start;
+            t->end = fn->end;
+            t->dmode = fn->mode;
+            SumCycles(mf.data, mf.size, dargs->arch, t);
+        }
+        qsort(totals, (size_t)count, sizeof(CYCLETOTAL), CompareCycleTotals);
+        for (u64 f = 0; f < count; f++)
+        {
+            u8 label[48];
+            snprintf(label, sizeof(label), "sub_%08llX %-5s ", totals[f].start, (totals[f].dmode == DARM) ? "arm" : "thumb");
+            PrintCycleTotal(out, label, &totals[f], dargs->arch);
+        }
+        free(totals);
+    }
+    else
+    {
+        CYCLETOTAL sum = { 0 };
+        for (u32 r = 0; r < range_count; r++) //each range in its own mode, the arch of the summary for all of them
+        {
+            CYCLETOTAL t;
+            memset(&t, 0, sizeof(CYCLETOTAL));
+            t.start = ranges[r].start;
+            t.end = ranges[r].end;
+            t.dmode = ranges[r].dmode;
+            SumCycles(mf.data, mf.size, dargs->arch, &t);
+            sum.instructions += t.instructions;
+            sum.min += t.min;
+            sum.max += t.max;
+            sum.n += t.n;
+            sum.s += t.s;
+            sum.i += t.i;
+        }
+        PrintCycleTotal(out, "range ", &sum, dargs->arch);
+    }
+    UnmapFile(&mf);
+    return 1;
+}
+
+static int DisassembleFile(FILE* in, FILE* out, DARGS* dargs) {
+    /* Disassemble from a binary file, print to another file */
+    u64 size = GetFileSize_mine(in);
+    if (dargs->frange.start > size || dargs->frange.end > size) return 0; //out of range
+    if (dargs->frange.end == 0) dargs->frange.end = size;
+    size = dargs->frange.end - dargs->frange.start;
+    if (dargs->fname_modes && dargs->modemap.ranges == NULL) return 0; //the mode map couldn't be read
+
+    FUNCTIONTABLE ft = { 0 }; //optional, to label the start of each function
+    if (dargs->fname_functions)
+    {
+        if (!LoadFunctionTable(dargs->fname_functions, &ft)) return 0;
+        qsort(ft.functions, ft.count, sizeof(FUNCTION), CompareFunctions);
+    }
+    fprintf(out, "Disassembly of %llu (0x%llX) bytes:\n\n", size, size);
+
+    /* Pipeline: blocks are read, decoded by all threads at once and written in order, through a ring of slots */
+    LISTING l;
+    memset(&l, 0, sizeof(LISTING));
+    l.in = in;
+    l.out = out;
+    l.ft = &ft;
+    u8* windows = NULL;
+    u32 data_windows = 0;
+    if (dargs->classify)
+    {
+        windows = ClassifyRange(dargs, dargs->frange.start, dargs->frange.end, &data_windows);
+        if (windows == NULL) return 0;
+    }
+    l.windows = windows;
+    l.cycles = dargs->cycles;
+    MODERANGE* ranges = BuildModeRanges(&dargs->modemap, dargs->frange.start, dargs->frange.end, dargs->dmode, dargs->arch, &l.range_count); //a single range without a mode map
+    l.ranges = ranges;
+    l.start = dargs->frange.start;
+    l.end = dargs->frange.end;
+    l.blocks = (u32)((size + LISTING_BLOCK - 1) / LISTING_BLOCK);
+    u32 workers = GetCoreCount() + 1; //one more, for when a thread waits on I/O
+    if (workers > WORKERS_MAX) workers = WORKERS_MAX;
+    if (workers > l.blocks) workers = l.blocks ? l.blocks : 1;
+    l.slot_count = workers * LISTING_SLOTS_PER_WORKER;
+    l.slots = calloc(l.slot_count, sizeof(LISTINGSLOT));
+    LISTINGJOB* jobs = calloc(workers, sizeof(LISTINGJOB));
+    if (l.slots == NULL || jobs == NULL) exit(1);
+    for (u32 i = 0; i < l.slot_count; i++)
+    {
+        l.slots[i].data = CheckedRealloc(NULL, LISTING_BLOCK + 6);
+        OutBufInit(&l.slots[i].text, NULL, LISTING_BLOCK * 32);
+    }
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].listing = &l;
+        jobs[i].lines = CheckedRealloc(NULL, (LISTING_BLOCK + 1) * sizeof(LISTINGLINE)); //data lines can be a single byte at the end of a mode range
+    }
+    u32 na_before = debug_na_count;
+    double t = GetTime();
+    RunWorkers(ListingWorker, jobs, sizeof(LISTINGJOB), workers);
+
+    LISTINGSTATS st = { 0 };
+    st.wall = GetTime() - t;
+    for (u32 i = 0; i < workers; i++)
+    {
+        st.read += jobs[i].stats.read;
+        st.decode += jobs[i].stats.decode;
+        st.format += jobs[i].stats.format;
+        st.write += jobs[i].stats.write;
+        st.bytes_in += jobs[i].stats.bytes_in;
+        st.bytes_out += jobs[i].stats.bytes_out;
+        st.instructions += jobs[i].stats.instructions;
+        st.na += jobs[i].stats.na;
+        free(jobs[i].lines);
+    }
+    for (u32 i = 0; i < l.slot_count; i++)
+    {
+        free(l.slots[i].data);
+        OutBufFree(&l.slots[i].text);
+    }
+    free(l.slots);
+    free(jobs);
+    debug_na_count = na_before + (u32)st.na; //counted by the workers, some of them on this thread
+
+    fprintf(out, "\n%u unknown instructions.", debug_na_count);
+    int summed = dargs->cycles ? PrintCycleSummary(dargs, &ft, ranges, l.range_count, out) : 1;
+    FreeFunctionTable(&ft);
+    free(windows);
+    free(ranges);
+    if (!summed) return 0;
+    if (dargs->classify) printf("\n%u of %u windows of %u bytes listed as data.\n", data_windows, (u32)((size + CLASSIFY_WINDOW - 1) / CLASSIFY_WINDOW), CLASSIFY_WINDOW);
+    if (dargs->stats) PrintListingStats(&st);
+    return 1; //success
+}
+
+static void XrefWorker(void* arg) {
+    /* Collect the branch and literal references of a chunk */
+    XREFJOB* job = arg;
+    DINST di;
+    DECODERS dec;
+    SelectDecoders(&dec, job->arch);
+    u64 i = job->begin;
+    if (job->dmode == DTHUMB && IsThumbSuffix(job->data, job->size, job->start, i, job->arch)) i += 2; //belongs to the previous chunk
+    while (i + ((job->dmode == DARM) ? 4 : 2) <= job->end)
+    {
+        u32 code = ReadCode(job->data, job->size, i);
+        if (job->dmode == DARM) dec.decode_arm(code, &di);
+        else dec.decode_thumb(code, &di);
+
+        XREF x = { (u32)i, 0, XREF_NONE };
+        if (di.iclass == IC_BRANCH && di.form == FORM_BRANCH_IMM)
+        {
+            x.target = (u32)(i + (s64)di.imm);
+            if (di.mnemonic == MN_BLX && job->dmode == DTHUMB) x.target &= ~3u; //to ARM
+            x.kind = (di.flags & DF_LINK) ? XREF_CALL : XREF_JUMP;
+        }
+        else if ((di.flags & DF_LOAD) && di.rn == 15 && di.form == FORM_MEM_IMM) //literal pool
+        {
+            x.target = (job->dmode == DARM) ? (u32)(i + 8 + (s64)di.imm) : (u32)(((i + 4) & ~3ULL) + di.imm);
+            x.kind = XREF_LITERAL;
+        }
+        if (x.kind != XREF_NONE)
+        {
+            if (job->count == job->capacity)
+            {
+                job->capacity = job->capacity ? job->capacity * 2 : 4096;
+                job->xrefs = CheckedRealloc(job->xrefs, job->capacity * sizeof(XREF));
+            }
+            job->xrefs[job->count++] = x;
+        }
+        i += di.size;
+    }
+}
+
+static u64 XrefKey(const XREF* x, int by_source) {
+    /* Sort key: (target, source) or (source, target) */
+    return by_source ? ((u64)x->source << 32) | x->target : ((u64)x->target << 32) | x->source;
+}
+
+static void RadixCountWorker(void* arg) {
+    /* Histogram of the current digit over a slice */
+    RADIXJOB* job = arg;
+    memset(job->histogram, 0, sizeof(job->histogram));
+    for (u64 i = job->begin; i < job->end; i++) job->histogram[(XrefKey(&job->src[i], job->by_source) >> job->shift) & 0xff]++;
+}
+
+static void RadixScatterWorker(void* arg) {
+    /* Move a slice to its place, histogram now holds the first destination of each digit */
+    RADIXJOB* job = arg;
+    for (u64 i = job->begin; i < job->end; i++)
+    {
+        u32 digit = (XrefKey(&job->src[i], job->by_source) >> job->shift) & 0xff;
+        job->dst[job->histogram[digit]++] = job->src[i];
+    }
+}
+
+static void RadixSortXrefs(XREF* xrefs, u64 count, int by_source) {
+    /* Parallel LSD radix sort on the 64-bit key, 8 bits per pass, passes where every key has the same digit are skipped */
+    XREF* tmp = CheckedRealloc(NULL, count * sizeof(XREF));
+    XREF* src = xrefs;
+    XREF* dst = tmp;
+    RADIXJOB* jobs = calloc(WORKERS_MAX, sizeof(RADIXJOB));
+    u64 bounds[WORKERS_MAX + 1];
+    u32 workers = SplitRange(0, count, 1, GetCoreCount(), bounds);
+    for (u32 shift = 0; shift < 64; shift += 8)
+    {
+        for (u32 w = 0; w < workers; w++)
+        {
+            jobs[w].src = src;
+            jobs[w].dst = dst;
+            jobs[w].begin = bounds[w];
+            jobs[w].end = bounds[w + 1];
+            jobs[w].shift = shift;
+            jobs[w].by_source = by_source;
+        }
+        RunWorkers(RadixCountWorker, jobs, sizeof(RADIXJOB), workers);
+
+        /* Prefix sums, digit by digit then worker by worker, keeps the sort stable */
+        u64 offset = 0;
+        u32 used = 0;
+        for (u32 d = 0; d < 256; d++)
+        {
+            u64 total = 0;
+            for (u32 w = 0; w < workers; w++)
+            {
+                u64 n = jobs[w].histogram[d];
+                jobs[w].histogram[d] = offset;
+                offset += n;
+                total += n;
+            }
+            if (total) used++;
+        }
+        if (used < 2) continue; //already in order for this digit
+        RunWorkers(RadixScatterWorker, jobs, sizeof(RADIXJOB), workers);
+        XREF* t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != xrefs) memcpy(xrefs, src, count * sizeof(XREF));
+    free(jobs);
+    free(tmp);
+}
+
+static int BuildXrefTable(DARGS* dargs, const u8* data, u64 size, XREFTABLE* xt) {
+    /* Collect every reference of the range, then sort a copy by target and a copy by source */
+    u64 start = 0;
+    u64 end = 0;
+    memset(xt, 0, sizeof(XREFTABLE));
+    if (!ResolveFileRange(dargs, size, &start, &end) || !CheckRange32(0, end, "/xref")) return 0;
+
+    XREFJOB jobs[WORKERS_MAX];
+    u64 bounds[WORKERS_MAX + 1];
+    memset(jobs, 0, sizeof(jobs));
+    u32 workers = SplitRange(start, end, (dargs->dmode == DARM) ? 4 : 2, GetCoreCount(), bounds);
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = data;
+        jobs[i].size = size;
+        jobs[i].start = start;
+        jobs[i].begin = bounds[i];
+        jobs[i].end = bounds[i + 1];
+        jobs[i].dmode = dargs->dmode;
+        jobs[i].arch = dargs->arch;
+    }
+    RunWorkers(XrefWorker, jobs, sizeof(XREFJOB), workers);
+
+    for (u32 i = 0; i < workers; i++) xt->count += jobs[i].count;
+    xt->by_target = CheckedRealloc(NULL, xt->count * sizeof(XREF));
+    xt->by_source = CheckedRealloc(NULL, xt->count * sizeof(XREF));
+    u64 n = 0;
+    for (u32 i = 0; i < workers; i++)
+    {
+        memcpy(&xt->by_target[n], jobs[i].xrefs, jobs[i].count * sizeof(XREF));
+        n += jobs[i].count;
+        free(jobs[i].xrefs);
+    }
+    memcpy(xt->by_source, xt->by_target, xt->count * sizeof(XREF)); //chunks are in order, already sorted by source
+    RadixSortXrefs(xt->by_target, xt->count, 0);
+    return 1;
+}
+
+static void FreeXrefTable(XREFTABLE* xt) {
+    free(xt->by_target);
+    free(xt->by_source);
+    memset(xt, 0, sizeof(XREFTABLE));
+}
+
+static int WriteXrefTable(const XREFTABLE* xt, const u8* fname) {
+    /* "DTXR", u32 version, u32 count, count XREF sorted by target, count XREF sorted by source */
+    FILE* fp = fopen(fname, "wb");
+    if (fp == NULL) return 0;
+    u32 header[2] = { XREFTABLE_VERSION, (u32)xt->count };
+    fwrite(XREFTABLE_MAGIC, 1, 4, fp);
+    fwrite(header, sizeof(header), 1, fp);
+    fwrite(xt->by_target, sizeof(XREF), xt->count, fp);
+    fwrite(xt->by_source, sizeof(XREF), xt->count, fp);
+    fclose(fp);
+    return 1;
+}
+
+static int LoadXrefTable(XREFTABLE* xt, const u8* fname) {
+    /* Read a table written by WriteXrefTable, return 0 if missing or invalid */
+    memset(xt, 0, sizeof(XREFTABLE));
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, fname)) return 0;
+    u32 header[2] = { 0 };
+    if (mf.size >= 12) memcpy(header, &mf.data[4], sizeof(header));
+    if (mf.size < 12 || memcmp(mf.data, XREFTABLE_MAGIC, 4) || header[0] != XREFTABLE_VERSION || 12 + 2 * (u64)header[1] * sizeof(XREF) > mf.size)
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+    xt->count = header[1];
+    xt->by_target = CheckedRealloc(NULL, xt->count * sizeof(XREF));
+    xt->by_source = CheckedRealloc(NULL, xt->count * sizeof(XREF));
+    memcpy(xt->by_target, &mf.data[12], xt->count * sizeof(XREF));
+    memcpy(xt->by_source, &mf.data[12 + xt->count * sizeof(XREF)], xt->count * sizeof(XREF));
+    UnmapFile(&mf);
+    return 1;
+}
+
+static u64 FindXrefs(const XREF* xrefs, u64 count, u32 address, int by_source) {
+    /* Index of the first reference to (or from) address in a sorted array, binary search */
+    u64 lo = 0;
+    u64 hi = count;
+    while (lo < hi)
+    {
+        u64 mid = (lo + hi) / 2;
+        u32 key = by_source ? xrefs[mid].source : xrefs[mid].target;
+        if (key < address) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int XrefTablePath(u8 path[PATH_LENGTH], const u8* fname_in) {
+    /* <filein>.xref */
+    if (strlen(fname_in) + sizeof(".xref") > PATH_LENGTH) return 0;
+    sprintf(path, "%s.xref", fname_in);
+    return 1;
+}
+
+static void PrintXrefs(OUTBUF* ob, const XREFTABLE* xt, u32 address) {
+    /* References to and from address */
+    OutBufPrintf(ob, "References to %08X:\n", address);
+    u64 n = 0;
+    for (u64 i = FindXrefs(xt->by_target, xt->count, address, 0); i < xt->count && xt->by_target[i].target == address; i++, n++)
+    {
+        OutBufPrintf(ob, "%08X %s\n", xt->by_target[i].source, XrefKindNames[xt->by_target[i].kind]);
+    }
+    OutBufPrintf(ob, "\nReferences from %08X:\n", address);
+    for (u64 i = FindXrefs(xt->by_source, xt->count, address, 1); i < xt->count && xt->by_source[i].source == address; i++)
+    {
+        OutBufPrintf(ob, "%08X %s\n", xt->by_source[i].target, XrefKindNames[xt->by_source[i].kind]);
+    }
+    OutBufPrintf(ob, "\n%llu references to %08X.", n, address);
+}
+
+static int CrossReference(FILE* in, FILE* out, DARGS* dargs) {
+    /* /xref: listing, plus the table written beside the input file */
+    /* /xref:<address>: references to and from address, from that table (built on the spot if missing) */
+    u8 path[PATH_LENGTH] = { 0 };
+    if (!XrefTablePath(path, dargs->fname_in)) return 0;
+    XREFTABLE xt;
+
+    if (!dargs->tool_value)
+    {
+        MAPPEDFILE mf;
+        if (!MapFile(&mf, dargs->fname_in)) return 0;
+        u64 start = 0;
+        u64 end = 0;
+        if (ResolveFileRange(dargs, mf.size, &start, &end) && !CheckRange32(0, end, "/xref")) //before the listing
+        {
+            UnmapFile(&mf);
+            return 0;
+        }
+        if (!DisassembleFile(in, out, dargs))
+        {
+            UnmapFile(&mf);
+            return 0;
+        }
+        int ok = BuildXrefTable(dargs, mf.data, mf.size, &xt);
+        UnmapFile(&mf);
+        if (!ok) return 0;
+        ok = WriteXrefTable(&xt, path);
+        if (ok) printf("\n%llu references written to \"%s\".\n", xt.count, path);
+        else printf("ERROR: The file \"%s\" could not be created.\n", path);
+        FreeXrefTable(&xt);
+        return ok;
+    }
+
+    u32 address = (u32)strtoull(dargs->tool_value, NULL, 16);
+    if (!LoadXrefTable(&xt, path))
+    {
+        MAPPEDFILE mf;
+        if (!MapFile(&mf, dargs->fname_in)) return 0;
+        int ok = BuildXrefTable(dargs, mf.data, mf.size, &xt);
+        UnmapFile(&mf);
+        if (!ok) return 0;
+    }
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    PrintXrefs(&ob, &xt, address);
+    OutBufFree(&ob);
+    FreeXrefTable(&xt);
+    return 1; //success
+}
+
+static u64 FirstMmioBlock(const MMIOJOB* job, u32 size, u64 i) {
+    /* Offset of the first block starting at i or after it: blocks start after an instruction that writes pc, so each chunk finds the same ones */
+    BLOCK b;
+    if (i == job->start) return i;
+    u32 code = (i - job->start >= 4) ? ReadCode(job->data, job->size, i - 4) : 0;
+    u64 back = (job->dmode == DARM || ((code & 0xf800) == 0xf000 && ((code >> 16) & 0xe800) == 0xe800)) ? 4 : 2; //last instruction, a bl/blx pair or not
+    if (DecodeBlock(&b, job->data, job->base, size, job->base + (u32)(i - back), job->dmode == DTHUMB, job->arch) == 1 && b.end != BLOCK_LIMIT) return i;
+    while (i < job->end)
+    {
+        if (!DecodeBlock(&b, job->data, job->base, size, job->base + (u32)i, job->dmode == DTHUMB, job->arch)) return job->end;
+        i = (u64)(b.start + b.size - job->base);
+        if (b.end != BLOCK_LIMIT) break;
+    }
+    return i;
+}
+
+static void MmioWorker(void* arg) {
+    /* Resolve the memory accesses of the blocks starting in a chunk, keep those to I/O registers */
+    /* A block cut at BLOCK_MAX goes on with the registers known at the cut, past the end of the chunk if needed */
+    MMIOJOB* job = arg;
+    BLOCK b;
+    REGSTATE rs;
+    MEMACCESS accesses[2 * BLOCK_MAX];
+    u32 size = (job->size > 0xffffffffULL) ? 0xffffffff : (u32)job->size;
+    u64 i = job->begin;
+    if (job->dmode == DTHUMB && IsThumbSuffix(job->data, job->size, job->start, i, job->arch)) i += 2; //belongs to the previous chunk
+    i = FirstMmioBlock(job, size, i);
+    int cut = 0; //previous block was cut, its registers carry on
+    while (i < (cut ? job->stop : job->end))
+    {
+        if (!DecodeBlock(&b, job->data, job->base, size, job->base + (u32)i, job->dmode == DTHUMB, job->arch)) break;
+        if (!cut) memset(&rs, 0, sizeof(REGSTATE));
+        u32 n = ResolveBlockAccesses(&b, job->data, job->base, size, &rs, accesses);
+        for (u32 k = 0; k < n; k++)
+        {
+            const MEMACCESS* a = &accesses[k];
+            u32 source = b.insts[a->index].address;
+            if (source - job->base >= job->stop) continue; //past the range
+            u32 width = (b.insts[a->index].di.iclass == IC_MULTIPLE) ? 4 : a->size;
+            for (u32 offset = 0; offset < a->size; offset += width)
+            {
+                u32 address = a->address + offset;
+                if (address < MMIO_START || address >= MMIO_END) continue;
+                if (job->count == job->capacity)
+                {
+                    job->capacity = job->capacity ? job->capacity * 2 : 1024;
+                    job->refs = CheckedRealloc(job->refs, job->capacity * sizeof(MMIOREF));
+                }
+                MMIOREF r = { address, source, a->store, (u8)width };
+                job->refs[job->count++] = r;
+            }
+        }
+        i = (u64)(b.start + b.size - job->base);
+        cut = (b.end == BLOCK_LIMIT);
+    }
+}
+
+static int CompareMmioRefs(const void* a, const void* b) {
+    /* By register, then by instruction, reads first */
+    const MMIOREF* x = a;
+    const MMIOREF* y = b;
+    if (x->address != y->address) return (x->address < y->address) ? -1 : 1;
+    if (x->source != y->source) return (x->source < y->source) ? -1 : 1;
+    return (int)x->store - (int)y->store;
+}
+
+static const u8* MmioName(u32 address) {
+    /* Name of a known I/O register, "" otherwise */
+    for (u32 i = 0; i < sizeof(MmioNames) / sizeof(MmioNames[0]); i++)
+    {
+        if (MmioNames[i].address == address) return MmioNames[i].name;
+    }
+    return "";
+}
+
+static int MmioIndex(DARGS* dargs, FILE* out) {
+    /* /mmio: instructions reading or writing each I/O register, with addresses from literal loads and arithmetic within basic blocks */
+    /* /mmio:<address>: those of a single register */
+    MAPPEDFILE mf;
+    if (!MapFile(&mf, dargs->fname_in)) return 0;
+    u64 start = 0;
+    u64 end = 0;
+    if (!ResolveFileRange(dargs, mf.size, &start, &end) || !CheckRange32(dargs->base, end, "/mmio"))
+    {
+        UnmapFile(&mf);
+        return 0;
+    }
+
+    MMIOJOB jobs[WORKERS_MAX];
+    u64 bounds[WORKERS_MAX + 1];
+    memset(jobs, 0, sizeof(jobs));
+    u32 workers = SplitRange(start, end, (dargs->dmode == DARM) ? 4 : 2, GetCoreCount(), bounds);
+    for (u32 i = 0; i < workers; i++)
+    {
+        jobs[i].data = mf.data;
+        jobs[i].size = mf.size;
+        jobs[i].start = start;
+        jobs[i].begin = bounds[i];
+        jobs[i].end = bounds[i + 1];
+        jobs[i].stop = end;
+        jobs[i].base = (u32)dargs->base;
+        jobs[i].dmode = dargs->dmode;
+        jobs[i].arch = dargs->arch;
+    }
+    RunWorkers(MmioWorker, jobs, sizeof(MMIOJOB), workers);
+
+    u64 count = 0;
+    for (u32 i = 0; i < workers; i++) count += jobs[i].count;
+    MMIOREF* refs = CheckedRealloc(NULL, (count ? count : 1) * sizeof(MMIOREF));
+    count = 0;
+    for (u32 i = 0; i < workers; i++)
+    {
+        memcpy(&refs[count], jobs[i].refs, jobs[i].count * sizeof(MMIOREF));
+        count += jobs[i].count;
+        free(jobs[i].refs);
+    }
+    qsort(refs, count, sizeof(MMIOREF), CompareMmioRefs);
+
+    DECODERS dec;
+    SelectDecoders(&dec, dargs->arch);
+    u32 only = dargs->tool_value ? (u32)strtoull(dargs->tool_value, NULL, 16) : 0;
+    u64 accesses = 0;
+    u64 registers = 0;
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    for (u64 i = 0; i < count;)
+    {
+        u64 next = i;
+        u64 writes = 0;
+        for (; next < count && refs[next].address == refs[i].address; next++) writes += refs[next].store;
+        if (dargs->tool_value && refs[i].address != only)
+        {
+            i = next;
+            continue;
+        }
+        OutBufPrintf(&ob, "%08X %s: %llu reads, %llu writes\n", refs[i].address, MmioName(refs[i].address), next - i - writes, writes);
+        for (; i < next; i++)
+        {
+            u8 str[STRING_LENGTH] = { 0 };
+            u64 offset = refs[i].source - (u32)dargs->base;
+            u32 code = ReadCode(mf.data, mf.size, offset);
+            if (dargs->dmode == DARM) dec.disassemble_arm(code, str);
+            else dec.disassemble_thumb(code & 0xffff, str); //never a bl/blx pair
+            OutBufPrintf(&ob, "    %08X %c%u %s\n", refs[i].source, refs[i].store ? 'w' : 'r', refs[i].size * 8, str);
+            accesses++;
+        }
+        registers++;
+    }
+    OutBufPrintf(&ob, "\n%llu accesses to %llu I/O registers.", accesses, registers);
+    OutBufFree(&ob);
+    free(refs);
+    UnmapFile(&mf);
+    return 1; //success
+}
+
+static u64 HashDiffInstruction(const DINST* di, u32 code, DMODE dmode) {
+    /* Identity of an instruction for the diff: its code, but only the decoded fields of a pc-relative one */
+    /* Branch and literal offsets change whenever code is inserted before their target, the instruction itself doesn't */
+    u64 h = code | ((u64)dmode << 32);
+    if (di->form == FORM_BRANCH_IMM || (di->rn == 15 && di->form == FORM_MEM_IMM))
+    {
+        h = di->mnemonic | ((u64)di->cond << 16) | ((u64)di->rd << 24) | ((u64)di->flags << 32) | ((u64)dmode << 48) | (1ULL << 63);
+    }
+    h ^= h >> 33; //mix, so that the hash table sees all the bits
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static DIFFINST* DecodeDiffStream(DARGS* dargs, const u8* data, u64 size, u64 start, u64 end, u32* count) {
+    /* Decode a file into instructions, with the same mode ranges as a listing, without text */
+    u32 range_count = 0;
+    MODERANGE* ranges = BuildModeRanges(&dargs->modemap, start, end, dargs->dmode, dargs->arch, &range_count);
+    DIFFINST* insts = CheckedRealloc(NULL, (size_t)((end - start) / 2 + 1) * sizeof(DIFFINST));
+    u32 n = 0;
+    for (u32 r = 0; r < range_count; r++)
+    {
+        const MODERANGE* range = &ranges[r];
+        u32 align = (range->dmode == DARM) ? 4 : 2;
+        for (u64 a = range->start; a + align <= range->end; )
+        {
+            DINST di;
+            DIFFINST* inst = &insts[n++];
+            inst->code = ReadCode(data, size, a);
+            inst->address = a;
+            inst->dmode = (u8)range->dmode;
+            inst->arch = (u8)range->arch;
+            if (range->dmode == DARM)
+            {
+                range->dec.decode_arm(inst->code, &di);
+                inst->size = 4;
+            }
+            else
+            {
+                if (a + 4 > range->end && range->end != end) inst->code &= 0xffff; //a pair can't take its second half from the next range
+                inst->size = (range->dec.decode_thumb(inst->code, &di) == SIZE_32) ? 4 : 2;
+                if (inst->size == 2) inst->code &= 0xffff;
+            }
+            inst->hash = HashDiffInstruction(&di, inst->code, range->dmode);
+            a += inst->size;
+        }
+    }
+    free(ranges);
+    *count = n;
+    return insts;
+}
+
+static DIFFSLOT* FindDiffSlot(DIFF* d, u64 hash, int insert) {
+    /* Slot of hash in the current generation, a new one if insert, else NULL when missing */
+    for (u32 i = (u32)hash & d->mask; ; i = (i + 1) & d->mask)
+    {
+        DIFFSLOT* slot = &d->slots[i];
+        if (slot->generation != d->generation)
+        {
+            if (!insert) return NULL;
+            slot->generation = d->generation;
+            slot->hash = hash;
+            slot->count_a = 0;
+            slot->count_b = 0;
+            return slot;
+        }
+        if (slot->hash == hash) return slot;
+    }
+}
+
+static void AddDiffMatch(DIFF* d, u32 a, u32 b) {
+    /* Matches are found in order */
+    d->matches[d->match_count].a = a;
+    d->matches[d->match_count].b = b;
+    d->match_count++;
+}
+
+static u64 HashDiffRun(const DIFFINST* s, u32 i, u32 width) {
+    /* Hash of width instructions from s[i] */
+    u64 h = s[i].hash;
+    for (u32 k = 1; k < width; k++)
+    {
+        h = (h ^ s[i + k].hash) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static void PatienceDiff(DIFF* d, u32 a0, u32 a1, u32 b0, u32 b1) {
+    /* Match a[a0..a1) with b[b0..b1): common ends, then the longest increasing run of instructions found once on each side, */
+    /* then the same between each of them. Where no instruction is found once, runs of 2, 4... DIFF_RUN_MAX instructions are */
+    /* tried instead, a region without any is all changed */
+    while (a0 < a1 && b0 < b1 && d->a[a0].hash == d->b[b0].hash) AddDiffMatch(d, a0++, b0++);
+    u32 suffix = 0;
+    while (a1 - suffix > a0 && b1 - suffix > b0 && d->a[a1 - suffix - 1].hash == d->b[b1 - suffix - 1].hash) suffix++;
+    a1 -= suffix;
+    b1 -= suffix;
+
+    for (u32 width = 1; width <= DIFF_RUN_MAX && width <= a1 - a0 && width <= b1 - b0; width *= 2)
+    {
+        d->generation++;
+        for (u32 i = a0; i + width <= a1; i++) FindDiffSlot(d, HashDiffRun(d->a, i, width), 1)->count_a++;
+        for (u32 j = b0; j + width <= b1; j++)
+        {
+            DIFFSLOT* slot = FindDiffSlot(d, HashDiffRun(d->b, j, width), 0);
+            if (slot == NULL) continue;
+            slot->count_b++;
+            slot->pos_b = j;
+        }
+
+        /* Patience sorting of the unique pairs by their position in b, tops[k] ends the best run of length k + 1 */
+        u32 k = 0;
+        u32 n = 0;
+        DIFFMATCH* anchors = CheckedRealloc(NULL, (size_t)(a1 - a0) * sizeof(DIFFMATCH));
+        u32* previous = CheckedRealloc(NULL, (size_t)(a1 - a0) * sizeof(u32));
+        u32* tops = CheckedRealloc(NULL, (size_t)(a1 - a0) * sizeof(u32));
+        for (u32 i = a0; i + width <= a1; i++)
+        {
+            DIFFSLOT* slot = FindDiffSlot(d, HashDiffRun(d->a, i, width), 0);
+            if (slot->count_a != 1 || slot->count_b != 1) continue;
+            anchors[n].a = i;
+            anchors[n].b = slot->pos_b;
+            u32 lo = 0;
+            u32 hi = k;
+            while (lo < hi)
+            {
+                u32 mid = (lo + hi) / 2;
+                if (anchors[tops[mid]].b < anchors[n].b) lo = mid + 1;
+                else hi = mid;
+            }
+            previous[n] = lo ? tops[lo - 1] : (u32)-1;
+            tops[lo] = n;
+            if (lo == k) k++;
+            n++;
+        }
+        u32* run = CheckedRealloc(NULL, (size_t)k * sizeof(u32));
+        for (u32 i = k, p = k ? tops[k - 1] : 0; i > 0; i--, p = previous[p]) run[i - 1] = p;
+        free(tops);
+        free(previous);
+
+        for (u32 i = 0; i < k; i++) //the generation changes below, the anchors are kept
+        {
+            const DIFFMATCH* m = &anchors[run[i]];
+            if (m->a < a0 || m->b < b0) continue; //overlaps the previous run
+            u32 same = 0;
+            while (same < width && d->a[m->a + same].hash == d->b[m->b + same].hash) same++;
+            if (same < width) continue; //hashes of different runs collided
+            PatienceDiff(d, a0, m->a, b0, m->b);
+            for (u32 w = 0; w < width; w++) AddDiffMatch(d, m->a + w, m->b + w);
+            a0 = m->a + width;
+            b0 = m->b + width;
+        }
+        free(run);
+        free(anchors);
+        if (k)
+        {
+            PatienceDiff(d, a0, a1, b0, b1);
+            break;
+        }
+    }
+    for (u32 i = 0; i < suffix; i++) AddDiffMatch(d, a1 + i, b1 + i);
+}
+
+static void PrintDiffLine(OUTBUF* out, u8 prefix, const DIFFINST* inst, const DECODERS* dec) {
+    /* A line of the listing, after + (new), - (old) or space (unchanged) */
+    u8 text[STRING_LENGTH] = { 0 };
+    const DECODERS* d = &dec[inst->arch >= ARMv5TE];
+    if (inst->dmode == DARM) d->disassemble_arm(inst->code, text);
+    else d->disassemble_thumb(inst->code, text);
+    if (inst->size == 4) OutBufPrintf(out, "%c%08llX: %08X %s\n", prefix, inst->address, inst->code, text);
+    else OutBufPrintf(out, "%c%08llX: %04X     %s\n", prefix, inst->address, inst->code, text);
+}
+
+static int DiffFiles(DARGS* dargs, FILE* out) {
+    /* /diff:<file>: instructions removed from the input file and added in file, in hunks with a few unchanged ones around */
+    if (!dargs->tool_value) return 0;
+    if (dargs->fname_modes && dargs->modemap.ranges == NULL) return 0; //the mode map couldn't be read
+    MAPPEDFILE old_file;
+    MAPPEDFILE new_file;
+    u64 start = 0;
+    u64 end = 0;
+    if (!MapFile(&old_file, dargs->fname_in)) return 0;
+    if (!ResolveFileRange(dargs, old_file.size, &start, &end) || !MapFile(&new_file, dargs->tool_value))
+    {
+        printf("ERROR: The file \"%s\" doesn't exist or doesn't hold the range.\n", dargs->tool_value);
+        UnmapFile(&old_file);
+        return 0;
+    }
+    u64 new_end = dargs->frange.end ? dargs->frange.end : new_file.size; //same range in both files, as far as the new one goes
+    if (new_end > new_file.size) new_end = new_file.size;
+    if (start > new_end) new_end = start;
+
+    DIFF d;
+    memset(&d, 0, sizeof(DIFF));
+    u32 na = 0;
+    u32 nb = 0;
+    DIFFINST* a = DecodeDiffStream(dargs, old_file.data, old_file.size, start, end, &na);
+    DIFFINST* b = DecodeDiffStream(dargs, new_file.data, new_file.size, start, new_end, &nb);
+    d.a = a;
+    d.b = b;
+    u32 capacity = 1;
+    while (capacity < na * 2) capacity *= 2;
+    d.slots = calloc(capacity, sizeof(DIFFSLOT));
+    d.mask = capacity - 1;
+    d.matches = CheckedRealloc(NULL, ((size_t)(na < nb ? na : nb) + 1) * sizeof(DIFFMATCH));
+    if (d.slots == NULL) exit(1);
+    PatienceDiff(&d, 0, na, 0, nb);
+
+    /* Changes: what lies between two matches, on either side */
+    DIFFMATCH* changes = CheckedRealloc(NULL, ((size_t)d.match_count + 1) * 2 * sizeof(DIFFMATCH)); //start and end of each
+    u32 change_count = 0;
+    u32 moved = 0; //unchanged, but their pc-relative target moved
+    for (u32 i = 0, ia = 0, ib = 0; i <= d.match_count; i++)
+    {
+        u32 next_a = (i < d.match_count) ? d.matches[i].a : na;
+        u32 next_b = (i < d.match_count) ? d.matches[i].b : nb;
+        if (next_a > ia || next_b > ib)
+        {
+            changes[change_count * 2].a = ia;
+            changes[change_count * 2].b = ib;
+            changes[change_count * 2 + 1].a = next_a;
+            changes[change_count * 2 + 1].b = next_b;
+            change_count++;
+        }
+        if (i < d.match_count && a[next_a].code != b[next_b].code) moved++;
+        ia = next_a + 1;
+        ib = next_b + 1;
+    }
+
+    /* Hunks: changes separated by up to 2 * DIFF_CONTEXT unchanged instructions are merged, with DIFF_CONTEXT of them around */
+    DECODERS dec[2];
+    SelectDecoders(&dec[0], ARMv4T);
+    SelectDecoders(&dec[1], ARMv5TE);
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    OutBufPrintf(&ob, "Difference of \"%s\" (%u instructions) with \"%s\" (%u instructions):\n", dargs->fname_in, na, dargs->tool_value, nb);
+    u32 hunks = 0;
+    for (u32 i = 0; i < change_count; )
+    {
+        u32 j = i; //last change of the hunk
+        while (j + 1 < change_count && changes[(j + 1) * 2].a - changes[j * 2 + 1].a <= 2 * DIFF_CONTEXT) j++;
+        const DIFFMATCH* first = &changes[i * 2];
+        const DIFFMATCH* last = &changes[j * 2 + 1];
+        u32 before = (first->a < DIFF_CONTEXT) ? first->a : DIFF_CONTEXT;
+        u32 after = (na - last->a < DIFF_CONTEXT) ? na - last->a : DIFF_CONTEXT;
+        u32 sa = first->a - before;
+        u32 sb = first->b - before;
+        OutBufPrintf(&ob, "\n@@ -%08llX,%u +%08llX,%u @@\n", (sa < na) ? a[sa].address : end, last->a + after - sa, (sb < nb) ? b[sb].address : new_end, last->b + after - sb);
+        for (u32 k = sa; k < first->a; k++) PrintDiffLine(&ob, ' ', &a[k], dec);
+        for (u32 c = i; c <= j; c++)
+        {
+            for (u32 k = changes[c * 2].a; k < changes[c * 2 + 1].a; k++) PrintDiffLine(&ob, '-', &a[k], dec);
+            for (u32 k = changes[c * 2].b; k < changes[c * 2 + 1].b; k++) PrintDiffLine(&ob, '+', &b[k], dec);
+            u32 until = (c < j) ? changes[(c + 1) * 2].a : changes[c * 2 + 1].a + after; //unchanged instructions up to the next change
+            for (u32 k = changes[c * 2 + 1].a; k < until; k++) PrintDiffLine(&ob, ' ', &a[k], dec);
+        }
+        hunks++;
+        i = j + 1;
+    }
+    OutBufPrintf(&ob, "\n%u hunks, %u instructions removed, %u added, %u unchanged but with a moved branch or literal.", hunks, na - d.match_count, nb - d.match_count, moved);
+    OutBufFree(&ob);
+    free(changes);
+    free(d.slots);
+    free(d.matches);
+    free(a);
+    free(b);
+    UnmapFile(&old_file);
+    UnmapFile(&new_file);
+    return 1; //success
+}
+
+static u64 ProfileKey(u32 pc, u32 mode, u32 cpu) {
+    /* Key of a sampled address, bit 34 so that no key is 0 */
+    return pc | ((u64)(mode & 1) << 32) | ((u64)(cpu & 1) << 33) | (1ULL << 34);
+}
+
+static u64* ProfileMapSlot(PROFILEMAP* pm, u64 key, int insert) {
+    /* Hits of a key, open addressing, NULL if missing and not inserted */
+    u32 slot = (u32)((key * 0x9E3779B97F4A7C15ULL) >> pm->shift);
+    while (pm->keys[slot])
+    {
+        if (pm->keys[slot] == key) return &pm->hits[slot];
+        slot = (slot + 1) & (pm->capacity - 1);
+    }
+    if (!insert) return NULL;
+    pm->keys[slot] = key;
+    pm->hits[slot] = 0;
+    pm->count++;
+    return &pm->hits[slot];
+}
+
+static void ProfileMapInit(PROFILEMAP* pm, u32 bits) {
+    /* Empty map of 2^bits slots */
+    pm->capacity = 1u << bits;
+    pm->shift = 64 - bits;
+    pm->count = 0;
+    pm->keys = calloc(pm->capacity, sizeof(u64));
+    pm->hits = CheckedRealloc(NULL, pm->capacity * sizeof(u64));
+    if (pm->keys == NULL)
+    {
+        printf("ERROR: Out of memory. Aborting.\n");
+        exit(1);
+    }
+}
+
+static void ProfileMapAdd(PROFILEMAP* pm, u64 key, u64 hits) {
+    /* Add hits to a key, doubles the capacity past half full */
+    if ((pm->count + 1) * 2 > pm->capacity)
+    {
+        PROFILEMAP old = *pm;
+        ProfileMapInit(pm, 64 - old.shift + 1);
+        for (u32 i = 0; i < old.capacity; i++)
+        {
+            if (old.keys[i]) *ProfileMapSlot(pm, old.keys[i], 1) = old.hits[i];
+        }
+        free(old.keys);
+        free(old.hits);
+    }
+    *ProfileMapSlot(pm, key, 1) += hits;
+}
+
+static u64 ProfileMapGet(PROFILEMAP* pm, u32 pc, u32 mode, u32 cpu) {
+    /* Hits of an address, 0 if never sampled */
+    u64* hits = ProfileMapSlot(pm, ProfileKey(pc, mode, cpu), 0);
+    return hits ? *hits : 0;
+}
+
+static int CompareProfileKeys(const void* a, const void* b) {
+    /* By cpu, then address, then mode */
+    u64 x = *(const u64*)a;
+    u64 y = *(const u64*)b;
+    x = ((x >> 33) & 1) << 40 | (x & 0xffffffff) << 1 | ((x >> 32) & 1);
+    y = ((y >> 33) & 1) << 40 | (y & 0xffffffff) << 1 | ((y >> 32) & 1);
+    return (x > y) - (x < y);
+}
+
+static int CompareProfileGroups(const void* a, const void* b) {
+    /* Most hits first, then by address */
+    const PROFILEGROUP* x = a;
+    const PROFILEGROUP* y = b;
+    if (x->hits != y->hits) return (x->hits < y->hits) - (x->hits > y->hits);
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+static void AddProfileGroup(PROFILEGROUP** groups, u64* count, u64* capacity, const PROFILEGROUP* g) {
+    /* Append to a growing array */
+    if (*count == *capacity)
+    {
+        *capacity = *capacity ? *capacity * 2 : 256;
+        *groups = CheckedRealloc(*groups, (size_t)*capacity * sizeof(PROFILEGROUP));
+    }
+    (*groups)[(*count)++] = *g;
+}
+
+static void ListProfileGroup(OUTBUF* ob, PROFILEMAP* pm, const PROFILEGROUP* g, const u8* data, u64 size, u64 base, u64 total) {
+    /* Annotated listing of a function or range: hits and percentage of all the hits in front of each line */
+    DECODERS dec;
+    SelectDecoders(&dec, (g->cpu == TRACE_ARM7) ? ARMv4T : ARMv5TE);
+    u32 align = (g->mode == TRACE_THUMB) ? 2 : 4;
+    u64 i = g->start;
+    OutBufPrintf(ob, "\n%s_%08llX %s %s: %llu hits (%.2f%%)\n", g->function ? "sub" : "range", base + g->start, TraceCpuNames[g->cpu & 1], (g->mode == TRACE_THUMB) ? "thumb" : "arm", g->hits, 100.0 * g->hits / total);
+    while (i + align <= g->end && i + align <= size)
+    {
+        u8 str[STRING_LENGTH] = { 0 };
+        u32 code = ReadCode(data, size, i);
+        u32 isize = 4;
+        u32 pc = (u32)(base + i);
+        u64 hits = ProfileMapGet(pm, pc, g->mode, g->cpu);
+        if (g->mode == TRACE_THUMB)
+        {
+            if (i + 4 > g->end) code &= 0xffff; //a pair doesn't reach past the end
+            isize = (dec.disassemble_thumb(code, str) == SIZE_32) ? 4 : 2;
+            if (isize == 4) hits += ProfileMapGet(pm, pc + 2, g->mode, g->cpu); //the second half of a pair runs too
+        }
+        else dec.disassemble_arm(code, str);
+        if (hits) OutBufPrintf(ob, "%10llu %6.2f%% ", hits, 100.0 * hits / total);
+        else OutBufWrite(ob, "                   ", 19); //same width as the hits
+        WriteListingLine(ob, base + i, code, isize, str);
+        i += isize;
+    }
+}
+
+static int ProfileFile(DARGS* dargs, FILE* out) {
+    /* /profile:<samples>{,<percent>}: the functions (from /funcs) or ranges of the input file that got at least percent of the hits */
+    /* of the sampling profile, most hits first, each line with its hits */
+    if (!dargs->tool_value) return 0;
+    u8 fname[PATH_LENGTH] = { 0 };
+    double threshold = PROFILE_THRESHOLD;
+    strncpy(fname, dargs->tool_value, PATH_LENGTH - 1);
+    u8* comma = strrchr(fname, ',');
+    if (comma)
+    {
+        *comma = 0;
+        u8* next = NULL;
+        threshold = strtod(&comma[1], (char**)&next);
+        if (next == &comma[1] || *next || !(threshold >= 0.0 && threshold <= 100.0)) //NaN too
+        {
+            printf("ERROR: The threshold \"%s\" isn't a percentage.\n", &comma[1]);
+            return 0;
+        }
+    }
+    FUNCTIONTABLE ft = { 0 };
+    if (dargs->fname_functions)
+    {
+        if (!LoadFunctionTable(dargs->fname_functions, &ft)) return 0;
+        qsort(ft.functions, ft.count, sizeof(FUNCTION), CompareFunctions);
+    }
+    MAPPEDFILE image;
+    MAPPEDFILE samples;
+    if (!MapFile(&image, dargs->fname_in))
+    {
+        FreeFunctionTable(&ft);
+        return 0;
+    }
+    if (!MapFile(&samples, fname))
+    {
+        printf("ERROR: The sample file \"%s\" doesn't exist.\n", fname);
+        UnmapFile(&image);
+        FreeFunctionTable(&ft);
+        return 0;
+    }
+
+    /* Aggregate the records by address, one pass */
+    PROFILEMAP pm;
+    ProfileMapInit(&pm, 12);
+    u64 records = samples.size / sizeof(PROFILERECORD);
+    u64 total = 0;
+    u64 outside = 0;
+    for (u64 r = 0; r < records; r++)
+    {
+        PROFILERECORD rec;
+        memcpy(&rec, &samples.data[r * sizeof(PROFILERECORD)], sizeof(PROFILERECORD));
+        total += rec.hits;
+        if (rec.pc < dargs->base || rec.pc - dargs->base >= image.size) outside += rec.hits;
+        else ProfileMapAdd(&pm, ProfileKey(rec.pc, rec.mode, rec.cpu), rec.hits);
+    }
+    UnmapFile(&samples);
+
+    /* Sampled addresses in order, each one goes to its function, or to a range of nearby addresses of the same cpu and mode */
+    u64* keys = CheckedRealloc(NULL, ((size_t)pm.count + 1) * sizeof(u64));
+    u64 key_count = 0;
+    for (u32 i = 0; i < pm.capacity; i++)
+    {
+        if (pm.keys[i]) keys[key_count++] = pm.keys[i];
+    }
+    qsort(keys, (size_t)key_count, sizeof(u64), CompareProfileKeys);
+    PROFILEGROUP* groups = NULL;
+    u64 group_count = 0;
+    u64 group_capacity = 0;
+    PROFILEGROUP range = { 0 };
+    u64 f = 0; //first function that may hold the address
+    u64 fg = 0; //group of the last function sampled, if group_count
+    for (u64 k = 0; k < key_count; k++)
+    {
+        u32 pc = (u32)keys[k];
+        u8 mode = (keys[k] >> 32) & 1;
+        u8 cpu = (keys[k] >> 33) & 1;
+        u64 offset = pc - dargs->base;
+        u64 hits = ProfileMapGet(&pm, pc, mode, cpu);
+        if (k && cpu != ((keys[k - 1] >> 33) & 1)) f = 0; //addresses start over with the next cpu
+        while (f < ft.count && ft.functions[f].end <= offset) f++;
+        u8 fmode = (f < ft.count && ft.functions[f].mode == DTHUMB) ? TRACE_THUMB : TRACE_ARM;
+        if (f < ft.count && ft.functions[f].start <= offset && fmode == mode) //samples in another mode go to ranges, listed in their own mode
+        {
+            if (range.hits) //no range spans a function
+            {
+                AddProfileGroup(&groups, &group_count, &group_capacity, &range);
+                range.hits = 0;
+            }
+            if (group_count && groups[fg].function && groups[fg].start == ft.functions[f].start && groups[fg].cpu == cpu) groups[fg].hits += hits; //ranges may come in between
+            else
+            {
+                PROFILEGROUP g = { ft.functions[f].start, ft.functions[f].end, hits, fmode, cpu, 1 };
+                AddProfileGroup(&groups, &group_count, &group_capacity, &g);
+                fg = group_count - 1;
+            }
+            continue;
+        }
+        if (range.hits && range.cpu == cpu && range.mode == mode && offset <= range.end + PROFILE_GAP) //extends the current range
+        {
+            range.end = offset + 4;
+            range.hits += hits;
+            continue;
+        }
+        if (range.hits) AddProfileGroup(&groups, &group_count, &group_capacity, &range);
+        PROFILEGROUP g = { offset, offset + 4, hits, mode, cpu, 0 }; //4 bytes for a THUMB pair too
+        range = g;
+    }
+    if (range.hits) AddProfileGroup(&groups, &group_count, &group_capacity, &range);
+    qsort(groups, (size_t)group_count, sizeof(PROFILEGROUP), CompareProfileGroups);
+
+    OUTBUF ob;
+    OutBufInit(&ob, out, OUTBUF_SIZE);
+    OutBufPrintf(&ob, "Profile of %llu records, %llu hits at %u addresses:\n", records, total, pm.count);
+    u64 listed = 0;
+    for (u64 g = 0; g < group_count; g++)
+    {
+        if (total == 0 || groups[g].hits * 100.0 < threshold * total) break; //sorted, none of the next ones either
+        ListProfileGroup(&ob, &pm, &groups[g], image.data, image.size, dargs->base, total);
+        listed++;
+    }
+    OutBufPrintf(&ob, "\n%llu of %llu %s listed, at least %.2f%% of the hits each.", listed, group_count, ft.count ? "functions and ranges" : "ranges", threshold);
+    OutBufPrintf(&ob, "\n%llu hits outside of the input file.", outside);
+    OutBufFree(&ob);
+    free(groups);
+    free(keys);
+    free(pm.keys);
+    free(pm.hits);
+    UnmapFile(&image);
+    FreeFunctionTable(&ft);
+    return 1; //success
+}
+
+#ifndef _WIN32
+static int ReadSocket(int fd, void* dst, size_t n) {
+    /* Read exactly n bytes, 0 if the client went away */
+    u8* p = dst;
+    while (n)
+    {
+        ssize_t got = read(fd, p, n);
+        if (got <= 0) return 0;
+        p += got;
+        n -= (size_t)got;
+    }
+    return 1;
+}
+
+static int WriteSocket(int fd, const void* src, size_t n) {
+    /* Write exactly n bytes, 0 if the client went away */
+    const u8* p = src;
+    while (n)
+    {
+        ssize_t put = write(fd, p, n);
+        if (put <= 0) return 0;
+        p += put;
+        n -= (size_t)put;
+    }
+    return 1;
+}
+
+static const MAPPEDFILE* GetServedFile(SERVER* sv, const u8* name, u32 len) {
+    /* The input file without a name, else the file mapped on its first request, NULL if it can't be or wasn't named on the command line */
+    if (len == 0) return &sv->files[0];
+    if (len >= PATH_LENGTH) return NULL;
+    u8 path[PATH_LENGTH] = { 0 };
+    memcpy(path, name, len);
+    const MAPPEDFILE* found = NULL;
+    u32 allowed = 0;
+    for (u32 i = 0; i < sv->dargs->served_count && !allowed; i++) allowed = !strcmp(sv->dargs->fname_served[i], path);
+    if (!allowed) return NULL; //a client can't read just any file
+    u32 spins = 0;
+    while (!AtomicCompareExchange(&sv->lock, 0, 1)) Backoff(&spins);
+    for (u32 i = 1; i < sv->file_count && !found; i++)
+    {
+        if (!strcmp(sv->names[i], path)) found = &sv->files[i];
+    }
+    if (!found && sv->file_count < SERVE_FILES && MapFile(&sv->files[sv->file_count], path))
+    {
+        memcpy(sv->names[sv->file_count], path, PATH_LENGTH);
+        found = &sv->files[sv->file_count];
+        AtomicStore(&sv->file_count, sv->file_count + 1);
+    }
+    AtomicStore(&sv->lock, 0);
+    return found;
+}
+
+static int AnswerServeRequest(SERVER* sv, const u8* req, u32 len, OUTBUF* ob) {
+    /* Text of the answer to a request frame into ob, return 0 for an invalid request (ob then says why) */
+    DECODERS dec;
+    u8 text[STRING_LENGTH] = { 0 };
+    switch (len ? req[0] : 0)
+    {
+    case SERVE_CODE:
+    {
+        if (len != 7) break;
+        u32 code = 0;
+        memcpy(&code, &req[3], 4);
+        SelectDecoders(&dec, (req[2] == 4) ? ARMv4T : ARMv5TE);
+        if (!req[1]) dec.disassemble_arm(code, text);
+        else if (dec.disassemble_thumb(code, text) != SIZE_32) code &= 0xffff;
+        if (req[1] && code <= 0xffff) OutBufPrintf(ob, "%04X     %s\n", code, text);
+        else OutBufPrintf(ob, "%08X %s\n", code, text);
+        return 1;
+    }
+    case SERVE_RANGE:
+    {
+        if (len < 15) break;
+        u64 start = 0;
+        u32 size = 0;
+        memcpy(&start, &req[3], 8);
+        memcpy(&size, &req[11], 4);
+        const MAPPEDFILE* mf = GetServedFile(sv, &req[15], len - 15);
+        if (mf == NULL)
+        {
+            OutBufPrintf(ob, "ERROR: The file can't be read or isn't served.\n");
+            return 0;
+        }
+        if (start > mf->size || size > SERVE_RANGE_MAX)
+        {
+            OutBufPrintf(ob, "ERROR: The range is out of the file or longer than 0x%X bytes.\n", SERVE_RANGE_MAX);
+            return 0;
+        }
+        u64 end = (mf->size - start < size) ? mf->size : start + size;
+        u32 align = req[1] ? 2 : 4;
+        u32 f = (u32)(mf - sv->files);
+        u8 mode = (req[1] ? 1 : 0) | ((req[2] == 4) ? 2 : 0);
+        SelectDecoders(&dec, (req[2] == 4) ? ARMv4T : ARMv5TE);
+        u32 spins = 0;
+        while (!AtomicCompareExchange(&sv->line_locks[f], 0, 1)) Backoff(&spins);
+        if (sv->lines[f] == NULL) sv->lines[f] = calloc(SERVE_LINES, sizeof(SERVELINE));
+        if (sv->lines[f] == NULL)
+        {
+            printf("ERROR: Out of memory. Aborting.\n");
+            exit(1);
+        }
+        for (u64 a = start; a + align <= end; )
+        {
+            u32 code = ReadCode(mf->data, mf->size, a);
+            if (req[1] && (code & 0xf800) != 0xf000) code &= 0xffff; //only a BL/BLX prefix depends on the next halfword
+            SERVELINE* line = &sv->lines[f][(a / align) & (SERVE_LINES - 1)];
+            if (!line->size || line->offset != a || line->code != code || line->mode != mode) //decoded by a previous request otherwise
+            {
+                line->offset = a;
+                line->code = code;
+                line->mode = mode;
+                line->size = 4;
+                memset(line->text, 0, STRING_LENGTH); //the decoders only write "n/a" over an empty string
+                if (!req[1]) dec.disassemble_arm(code, line->text);
+                else if (dec.disassemble_thumb(code, line->text) != SIZE_32) line->size = 2;
+            }
+            WriteListingLine(ob, a, code, line->size, line->text);
+            a += line->size;
+        }
+        AtomicStore(&sv->line_locks[f], 0);
+        return 1;
+    }
+    case SERVE_XREF:
+    {
+        if (len != 5) break;
+        u32 address = 0;
+        memcpy(&address, &req[1], 4);
+        PrintXrefs(ob, &sv->xrefs, address);
+        OutBufWrite(ob, "\n", 1);
+        return 1;
+    }
+    case SERVE_STOP:
+    {
+        if (len != 1) break;
+        AtomicStore(&sv->stopping, 1);
+        shutdown(sv->socket, SHUT_RDWR); //wakes up accept
+        OutBufPrintf(ob, "Stopping.\n");
+        return 1;
+    }
+    }
+    OutBufPrintf(ob, "ERROR: Invalid request.\n");
+    return 0;
+}
+
+static void* ServeClient(void* arg) {
+    /* Answer the requests of a client until it disconnects: frames of a u32 size then the request, */
+    /* answered with a u32 size, then a u8 status (1 for success) and the text */
+    SERVECLIENT* c = arg;
+    SERVER* sv = c->server;
+    OUTBUF ob;
+    OutBufInit(&ob, NULL, 1 << 16);
+    u8 req[SERVE_REQUEST_MAX];
+    u32 len = 0;
+    while (ReadSocket(c->fd, &len, 4) && len <= SERVE_REQUEST_MAX && ReadSocket(c->fd, req, len))
+    {
+        AtomicAdd(&sv->busy, 1);
+        if (AtomicLoad(&sv->stopping))
+        {
+            AtomicAdd(&sv->busy, (u32)-1);
+            break;
+        }
+        ob.size = 5; //size and status, once known
+        u8 status = (u8)AnswerServeRequest(sv, req, len, &ob);
+        u32 size = (u32)ob.size - 4;
+        memcpy(ob.data, &size, 4);
+        ob.data[4] = status;
+        int sent = WriteSocket(c->fd, ob.data, ob.size);
+        AtomicAdd(&sv->busy, (u32)-1);
+        if (!sent) break;
+    }
+    u32 spins = 0;
+    while (!AtomicCompareExchange(&sv->client_lock, 0, 1)) Backoff(&spins);
+    sv->client_fds[c->slot] = -1; //before close, so that the server never shuts down a reused descriptor
+    AtomicStore(&sv->client_lock, 0);
+    close(c->fd);
+    OutBufFree(&ob);
+    free(c);
+    AtomicAdd(&sv->clients, (u32)-1); //the last time this thread reads the server
+    return NULL;
+}
+#endif
+
+static int Serve(DARGS* dargs) {
+    /* /serve:<socket>: keep the input file mapped with its cross-references and answer requests on a local socket, */
+    /* one thread per client, until a SERVE_STOP request */
+#ifdef _WIN32
+    printf("ERROR: /serve needs Unix domain sockets, it isn't available on Windows.\n");
+    return 0;
+#else
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (!dargs->tool_value || strlen(dargs->tool_value) >= sizeof(addr.sun_path)) return 0;
+    SERVER* sv = calloc(1, sizeof(SERVER));
+    if (sv == NULL) exit(1);
+    sv->dargs = dargs;
+    if (!MapFile(&sv->files[0], dargs->fname_in) || !BuildXrefTable(dargs, sv->files[0].data, sv->files[0].size, &sv->xrefs))
+    {
+        free(sv);
+        return 0;
+    }
+    sv->file_count = 1;
+    for (u32 i = 0; i < SERVE_CLIENTS_MAX; i++) sv->client_fds[i] = -1;
+    signal(SIGPIPE, SIG_IGN); //a client going away is seen by write instead
+
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, dargs->tool_value);
+    struct stat st;
+    if (!lstat(addr.sun_path, &st) && S_ISSOCK(st.st_mode)) unlink(addr.sun_path); //left by a previous server, any other file makes bind fail
+    sv->socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    mode_t mask = umask(0177); //created 0600: only this user can connect
+    int bound = sv->socket >= 0 && !bind(sv->socket, (struct sockaddr*)&addr, sizeof(addr));
+    umask(mask);
+    if (!bound || chmod(addr.sun_path, 0600) || listen(sv->socket, 64))
+    {
+        printf("ERROR: Can't listen on \"%s\".\n", addr.sun_path);
+        if (sv->socket >= 0) close(sv->socket);
+        FreeXrefTable(&sv->xrefs);
+        UnmapFile(&sv->files[0]);
+        free(sv);
+        return 0;
+    }
+    printf("Serving \"%s\" on \"%s\".\n", dargs->fname_in, addr.sun_path);
+    fflush(stdout);
+
+    int ok = 1;
+    while (!AtomicLoad(&sv->stopping))
+    {
+        int fd = accept(sv->socket, NULL, NULL);
+        if (fd < 0 && (errno == EINTR || AtomicLoad(&sv->stopping))) continue;
+        if (fd < 0) //would fail again right away, eg. out of file descriptors
+        {
+            printf("ERROR: Can't accept clients on \"%s\".\n", addr.sun_path);
+            AtomicStore(&sv->stopping, 1);
+            ok = 0;
+            break;
+        }
+        SERVECLIENT* c = CheckedRealloc(NULL, sizeof(SERVECLIENT));
+        c->server = sv;
+        c->fd = fd;
+        c->slot = SERVE_CLIENTS_MAX;
+        u32 spins = 0;
+        while (!AtomicCompareExchange(&sv->client_lock, 0, 1)) Backoff(&spins);
+        for (u32 i = 0; i < SERVE_CLIENTS_MAX && c->slot == SERVE_CLIENTS_MAX; i++)
+        {
+            if (sv->client_fds[i] >= 0) continue;
+            sv->client_fds[i] = fd;
+            c->slot = i;
+        }
+        AtomicStore(&sv->client_lock, 0);
+        if (c->slot == SERVE_CLIENTS_MAX) //too many clients
+        {
+            close(fd);
+            free(c);
+            continue;
+        }
+        AtomicAdd(&sv->clients, 1);
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, ServeClient, c)) ServeClient(c); //could not create a thread, serve it here
+        else pthread_detach(thread);
+    }
+    u32 spins = 0;
+    while (AtomicLoad(&sv->busy)) Backoff(&spins); //answers being written are finished, the next requests find the server stopping
+    close(sv->socket);
+    unlink(addr.sun_path);
+    while (!AtomicCompareExchange(&sv->client_lock, 0, 1)) Backoff(&spins);
+    for (u32 i = 0; i < SERVE_CLIENTS_MAX; i++)
+    {
+        if (sv->client_fds[i] >= 0) shutdown(sv->client_fds[i], SHUT_RDWR); //wakes up their threads waiting for a request
+    }
+    AtomicStore(&sv->client_lock, 0);
+    spins = 0;
+    while (AtomicLoad(&sv->clients)) Backoff(&spins); //done with the server once they leave
+    FreeXrefTable(&sv->xrefs);
+    for (u32 i = 0; i < sv->file_count; i++)
+    {
+        UnmapFile(&sv->files[i]);
+        free(sv->lines[i]);
+    }
+    free(sv);
+    return ok; //1 on success
+#endif
+}
+
+static int IsValidPath(u8* path) {
+    /* Check if length of path/filename is */
+    u32 hasDotAndEom = 0;
+    if (!path || !path[0]) return 0; //needs to be at least one char
+    for (u32 i = 1; i < PATH_LENGTH; i++)
+    {
+        if (path[i] == '.') hasDotAndEom = 1;
+        if (!path[i])
+        {
+            hasDotAndEom++;
+            break; //found EOM
+        }
+    }
+    if (hasDotAndEom == 2) return 1;
+    return 0;
+}
+
+static int IfValidCodeSet(u32* code, u8* str) {
+    /* Convert string to 32-bit hex value */
+    if (strlen(str) > 8) return 0;
+    *code = (u32)strtoll(str, NULL, 16);
+    return 1;
+}
+
+static int IfValidRangeSet(FILERANGE* range, u8* r) {
+    /* Check to see if the range string yields a valid FILERANGE */
+    //Acceptable formats:
+    //"X-X" //start to end
+    //"--X" //unspecified start (default to beginning of file, 0) to end
+    //"X--" //start to unspecified end (default to end of file)
+
+    //todo: new acceptable format: <start>:<size>
+
+    u64 start = 0; //64-bit, for dumps past 4 GiB
+    u64 end = 0;
+    u32 valid = 0;
+
+    if (!r || !r[0] || r[0] == '/') return 0; //needs to be at least one char, +smart abort for detecting "/a"
+
+    /* Init buffer (memcpy with two limit conditions) */
+    u8 str[RANGE_LENGTH] = { 0 };
+    u32 i = 0; //count chars
+    while (r[i] && (i < RANGE_LENGTH - 1)) //must be null terminated
+    {
+        str[i] = r[i];
+        i++;
+    }
+
+    switch (*(u16*)str)
+    {
+    case 0x2d2d: //-- detect double dash
+    case 0x3a2d: //-: detect size
+    {
+        end = strtoull(&str[2], NULL, 16);
+        valid = 1;
+        break;
+    }
+    default: //go through the string
+    {
+        for (u32 j = 0; j < i; j++)
+        {
+            if (str[j] == '-') //first dash
+            {
+                start = strtoull(str, NULL, 16);
+                end = strtoull(&str[j + 1], NULL, 16);
+                valid = 1;
+                break;
+            }
+            else if (str[j] == ':') //start + size
+            {
+                start = strtoull(str, NULL, 16);
+                end = start + strtoull(&str[j + 1], NULL, 16);
+                valid = 1;
+                break;
+            }
+        }
+    }
+    }
+
+    if (!valid) return 0;
+
+    if (end && (start > end))
+    {
+        printf("WARNING: If END is specified and non-zero, it cannot be greater than START. The whole file will be disassembled.\n");
+        return 0; //start can't be greater than end if end is non-zero
+    }
+
+    /* Success, set */
+    range->start = start;
+    range->end = end;
+    return 1;
+}
+
+static int IfValidModeSet(DARGS* dargs, u8* m) {
+    /* Only check first two chars to change from default DTHUMB to DARM mode */
+    //valid inputs: (/a, /a4, /a5), (/t, /t4, /t5, /4, /5) -> (/a, /a4), (/4)
+
+    if (!m || !m[0] || m[0] != '/') return 0; //needs to be at least one char, beggining with "/"
+    if (strlen(m) > 3) return 0; //can't have more than 3 printable characters
+
+    switch (*(u16*)(&m[1])) //treat as a 16-bit value to decode faster
+    {
+    case 0x0061: //a
+    case 0x3561: //a5
+    {
+        dargs->dmode = DARM;
+        dargs->arch = ARMv5TE; //redundant
+        return 1;
+    }
+    case 0x3461: //a4
+    {
+        dargs->dmode = DARM;
+        dargs->arch = ARMv4T;
+        return 1;
+    }
+    case 0x3474: //t4
+    case 0x0034: //4
+    {
+        dargs->dmode = DTHUMB; //redundant
+        dargs->arch = ARMv4T;
+        return 1;
+    }
+    case 0x0074: //t
+    case 0x0035: //5
+    case 0x3574: //t5
+    {
+        dargs->dmode = DTHUMB; //redundant
+        dargs->arch = ARMv5TE; //redundant
+        return 1;
+    }
+    default:
+    {
+        return 0; //invalid input
+    }
+    }
+}
+
+static int CompareModeRanges(const void* a, const void* b) {
+    /* qsort callback, by start address */
+    const MODERANGE* x = a;
+    const MODERANGE* y = b;
+    return (x->start > y->start) - (x->start < y->start);
+}
+
+static int LoadModeMap(const u8* fname, MODEMAP* map) {
+    /* Read a mode map: one "<range> <mode>" per line, with the range and mode syntax of the command line */
+    //example: "2000-2400 a4" or "2400:80 /t", '#' starts a comment
+    memset(map, 0, sizeof(MODEMAP));
+    FILE* fp = fopen(fname, "r");
+    if (fp == NULL)
+    {
+        printf("ERROR: The mode map \"%s\" doesn't exist.\n", fname);
+        return 0;
+    }
+    u32 capacity = 0;
+    u32 number = 0;
+    u8 line[PATH_LENGTH];
+    while (fgets(line, sizeof(line), fp))
+    {
+        number++;
+        u8* comment = strchr(line, '#');
+        if (comment) *comment = 0;
+        u8 range[PATH_LENGTH] = { 0 };
+        u8 mode[PATH_LENGTH] = "/";
+        int fields = sscanf(line, "%255s %254s", range, &mode[1]);
+        if (fields <= 0) continue; //empty line
+        DARGS d = { 0 };
+        FILERANGE fr = { 0 };
+        if (fields != 2 || !IfValidRangeSet(&fr, range) || fr.end == 0 || fr.start >= fr.end || !IfValidModeSet(&d, (mode[1] == '/') ? &mode[1] : mode))
+        {
+            printf("ERROR: Line %u of the mode map \"%s\" isn't \"<start>-<end> <mode>\".\n", number, fname);
+            fclose(fp);
+            free(map->ranges);
+            map->ranges = NULL;
+            return 0;
+        }
+        if (map->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            map->ranges = CheckedRealloc(map->ranges, capacity * sizeof(MODERANGE));
+        }
+        MODERANGE* r = &map->ranges[map->count++];
+        memset(r, 0, sizeof(MODERANGE));
+        r->start = (u64)fr.start;
+        r->end = (u64)fr.end;
+        r->dmode = d.dmode;
+        r->arch = d.arch;
+    }
+    fclose(fp);
+    if (map->ranges == NULL) map->ranges = CheckedRealloc(NULL, sizeof(MODERANGE)); //empty map, everything in the default mode
+    qsort(map->ranges, map->count, sizeof(MODERANGE), CompareModeRanges);
+    for (u32 i = 1; i < map->count; i++)
+    {
+        if (map->ranges[i].start >= map->ranges[i - 1].end) continue;
+        printf("ERROR: Ranges of the mode map \"%s\" overlap at %08X.\n", fname, (u32)map->ranges[i].start);
+        free(map->ranges);
+        map->ranges = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+static int IfValidToolSet(DARGS* dargs, u8* t) {
+    /* Switches that select something else than a plain disassembly of the file: /<tool> or /<tool>:<value> */
+    static const struct {
+        const u8* name;
+        DTOOL tool;
+    } tools[] = {
+        { "trace", DTOOL_TRACE },
+        { "mix", DTOOL_MIX },
+        { "scan", DTOOL_SCAN },
+        { "functions", DTOOL_FUNCTIONS },
+        { "xref", DTOOL_XREF },
+        { "diff", DTOOL_DIFF },
+        { "serve", DTOOL_SERVE },
+        { "profile", DTOOL_PROFILE },
+        { "detect", DTOOL_DETECT },
+        { "mmio", DTOOL_MMIO }
+    };
+
+    if (!t || t[0] != '/') return 0; //needs to begin with "/"
+    u8* value = strchr(t, ':');
+    size_t len = value ? (size_t)(value - &t[1]) : strlen(&t[1]);
+    for (u32 i = 0; i < sizeof(tools) / sizeof(tools[0]); i++)
+    {
+        if (strlen(tools[i].name) != len || strncmp(&t[1], tools[i].name, len)) continue;
+        dargs->tool = tools[i].tool;
+        dargs->tool_value = value ? value + 1 : NULL;
+        return 1;
+    }
+    return 0; //invalid input
+}
+
+static int IfValidOptionSet(DARGS* dargs, u8* o) {
+    /* Switches that change how a tool works: /<option>:<value> */
+    if (!o || o[0] != '/') return 0; //needs to begin with "/"
+    if (!strncmp(&o[1], "funcs:", 6) && o[7])
+    {
+        dargs->fname_functions = &o[7];
+        return 1;
+    }
+    if (!strcmp(&o[1], "modes:auto"))
+    {
+        dargs->fname_modes = &o[7];
+        dargs->detect_modes = 1;
+        return 1;
+    }
+    if (!strncmp(&o[1], "modes:", 6) && o[7])
+    {
+        dargs->fname_modes = &o[7];
+        LoadModeMap(dargs->fname_modes, &dargs->modemap); //on failure the listing fails, like with a missing function table
+        return 1;
+    }
+    if (!strncmp(&o[1], "tables:", 7) && o[8])
+    {
+        dargs->fname_tables = &o[8];
+        return 1;
+    }
+    if (!strncmp(&o[1], "base:", 5) && o[6])
+    {
+        dargs->base = strtoull(&o[6], NULL, 16);
+        return 1;
+    }
+    if (!strcmp(&o[1], "cycles"))
+    {
+        dargs->cycles = 1;
+        return 1;
+    }
+    if (!strcmp(&o[1], "stats"))
+    {
+        dargs->stats = 1;
+        return 1;
+    }
+    if (!strncmp(&o[1], "data", 4) && (!o[5] || o[5] == ':'))
+    {
+        CLASSIFYTHRESHOLDS th = { 10, 75, 50, 60 }; //defaults, in percent
+        const u8* p = o[5] ? &o[6] : &o[5];
+        while (*p) //comma-separated <signal>=<percentage>
+        {
+            u32* field = NULL;
+            if (!strncmp(p, "na=", 3)) field = &th.na;
+            else if (!strncmp(p, "ascii=", 6)) field = &th.ascii;
+            else if (!strncmp(p, "repeat=", 7)) field = &th.repeat;
+            else if (!strncmp(p, "cond=", 5)) field = &th.cond;
+            if (field == NULL) return 0;
+            p = strchr(p, '=') + 1;
+            *field = (u32)strtoul(p, (char**)&p, 10);
+            if (*p == ',') p++;
+            else if (*p) return 0;
+        }
+        dargs->classify = 1;
+        dargs->thresholds = th;
+        return 1;
+    }
+    return 0; //invalid input
+}
+
+static int ParseCommandLineArguments(DARGS* dargs, int argc, char* argv[]) {
+    /* You can pass arguments in any order, but they need to be valid */
+    /* fname_in has to be valid, else return 0 (failed) */
+    /* The other arguments can be invalid, default behavior is handled */
+
+    if (argc < 2) return DARGS_INVALID;
+
+    if (IsValidPath(argv[1])) //filein
+    {
+        dargs->fname_in = argv[1];
+        for (int i = 2; i < argc; i++)
+        {
+            if (IfValidModeSet(dargs, argv[i])) continue;
+            if (IfValidToolSet(dargs, argv[i])) continue;
+            if (IfValidOptionSet(dargs, argv[i])) continue;
+            if (IsValidPath(argv[i])) //fileout, or a file for /serve
+            {
+                if (!dargs->fname_out) dargs->fname_out = argv[i];
+                if (dargs->served_count < SERVE_FILES - 1) dargs->fname_served[dargs->served_count++] = argv[i];
+                continue;
+            }
+            IfValidRangeSet(&dargs->frange, argv[i]);
+        }
+        if (dargs->tool == DTOOL_SERVE) dargs->fname_out = NULL; //served, not overwritten
+        return dargs->fname_out ? DARGS_FILEOUT : DARGS_STDOUT;
+    }
+    else if (IfValidCodeSet(&dargs->code, argv[1])) //single code
+    {
+        IfValidModeSet(dargs, argv[2]);
+        return DARGS_SINGLE;
+    }
+    return DARGS_INVALID;
+}
+
+static int RunTool(DARGS* dargs, FILE* in, FILE* out) {
+    /* Do what the switches asked for, return 0 on failure */
+    if (dargs->detect_modes && !DetectModeMap(dargs)) return 0;
+    switch (dargs->tool)
+    {
+    case DTOOL_TRACE: return DisassembleTrace(dargs, out);
+    case DTOOL_MIX: return InstructionMix(dargs, out);
+    case DTOOL_SCAN: return ScanSignatures(dargs, out);
+    case DTOOL_FUNCTIONS: return ExportFunctions(dargs, out);
+    case DTOOL_XREF: return CrossReference(in, out, dargs);
+    case DTOOL_DIFF: return DiffFiles(dargs, out);
+    case DTOOL_SERVE: return Serve(dargs);
+    case DTOOL_PROFILE: return ProfileFile(dargs, out);
+    case DTOOL_DETECT: return DetectModes(dargs, out);
+    case DTOOL_MMIO: return MmioIndex(dargs, out);
+    default: return DisassembleFile(in, out, dargs);
+    }
+}
+
+//#define DEBUG //comment out to disable debug ifdefs
+
+#ifdef DEBUG
+static int CheckViewAnchors(void) {
+    /* DisassembleView with the anchor on each halfword of a BL pair: both show the pair as the anchor line */
+    static const u8 memory[] = { 0xC0, 0x46, 0x00, 0xF0, 0x00, 0xF8, 0x70, 0x47 }; //nop, bl #0x4, bx lr
+    static VIEW v;
+    InitView(&v, memory, 0x02000000, sizeof(memory), 1, ARMv5TE);
+    for (u32 anchor = 0x02000002; anchor <= 0x02000004; anchor += 2)
+    {
+        VIEWLINE lines[3];
+        u32 anchor_line = 0;
+        u32 n = DisassembleView(&v, anchor, 1, 1, lines, &anchor_line);
+        if (n != 3 || anchor_line != 1 || lines[1].address != 0x02000002 || lines[1].size != 4 || strncmp(lines[1].text, "bl ", 3)) return 0;
+        if (lines[0].address != 0x02000000 || lines[2].address != 0x02000006) return 0;
+    }
+    return 1;
+}
+#endif
+
+int main(int argc, char* argv[]) {
+
+    double start = GetTime();
+
+#ifdef DEBUG
+    printf("View test %s.\n", CheckViewAnchors() ? "passed" : "FAILED");
+
+    /* Performance test */
+    FILE* fdebug = fopen("fdebug.txt", "w+");
+    printf("Performance test started.\n");
+    u32 i = 0;
+    do
+    {
+        u8 s[STRING_LENGTH] = { 0 };
+        Disassemble_arm(i, s, ARMv5TE);
+        //Disassemble_thumb(i, s, ARMv5TE);
+        //fprintf(fdebug, "%08X %s\n", i, s);
+
+        if (!(i & 0xfffffff)) printf("%08X\n", i);
+
+    } while (++i);
+    fclose(fdebug);
+#else
+
+    DARGS dargs;
+    memset(&dargs, 0, sizeof(DARGS)); //options not given stay 0/NULL
+    dargs.dmode = DTHUMB;
+    dargs.arch = ARMv5TE;
+    dargs.tool = DTOOL_DISASSEMBLE;
+    DARGS_STATUS ds = ParseCommandLineArguments(&dargs, argc, argv);
+    MAPPEDFILE tables = { 0 };
+    if (ds != DARGS_INVALID && dargs.fname_tables) OpenDecodeTables(&tables, dargs.fname_tables); //before any SelectDecoders
+
+    switch (ds)
+    {
+    case DARGS_INVALID:
+    {
+        printf("Nothing was done\n");
+        return 0; //terminate
+    }
+    case DARGS_SINGLE:
+    {
+        DisassembleSingle(&dargs);
+        break;
+    }
+    case DARGS_STDOUT:
+    {
+        FILE* file_in = fopen(dargs.fname_in, "rb"); //ignore warning, IsValidPath makes sure it isn't NULL
+        if (file_in == NULL)
+        {
+            printf("ERROR: The file \"%s\" doesn't exist. Aborting.\n", dargs.fname_in);
+            return 0; //terminate
+        }
+        printf("Starting disassembly of \"%s\".\n", dargs.fname_in);
+        if (RunTool(&dargs, file_in, stdout))
+        {
+            printf("\nSuccessfully disassembled \"%s\".\n", dargs.fname_in);
+        }
+        else
+        {
+            printf("ERROR: %s failed.\n", ToolNames[dargs.tool]);
+        }
+        fclose(file_in);
+        break;
+    }
+    case DARGS_FILEOUT:
+    {
+        FILE* file_in = fopen(dargs.fname_in, "rb"); //ignore warning, IsValidPath makes sure it isn't NULL
+        if (file_in == NULL)
+        {
+            printf("ERROR: The file \"%s\" doesn't exist. Aborting.\n", dargs.fname_in);
+            return 0; //terminate
+        }
+        FILE* file_out = fopen(dargs.fname_out, "w+"); //ignore warning, IsValidPath makes sure it isn't NULL
+        if (file_out == NULL)
+        {
+            printf("ERROR: The file \"%s\" could not be created. Aborting.\n", dargs.fname_out);
+            return 0; //terminate
+        }
+
+        printf("Starting disassembly of \"%s\".\n", dargs.fname_in);
+        if (RunTool(&dargs, file_in, file_out))
+        {
+            printf("Successfully disassembled \"%s\" to \"%s\".\n", dargs.fname_in, dargs.fname_out);
+        }
+        else
+        {
+            printf("ERROR: %s failed.\n", ToolNames[dargs.tool]);
+        }
+        fclose(file_in);
+        fclose(file_out);
+        break;
+    }
+    }
+    free(dargs.modemap.ranges); //NULL without a mode map
+    if (tables.data)
+    {
+        DetachDecodeTables();
+        UnmapFile(&tables);
+    }
+
+#endif // DEBUG
+
+#ifdef DTHUMB_INSTRUMENT
+    INSTRUMENTATION* instrumentation = calloc(1, sizeof(INSTRUMENTATION));
+    if (instrumentation)
+    {
+        MergeInstrumentation(instrumentation); //workers were merged into this thread
+        DumpInstrumentation(stdout, instrumentation);
+        free(instrumentation);
+    }
+#endif
+
+    printf("Completion time: %.0f ms\n", (GetTime() - start) * 1000.0);
+    return 0;
+}